@@ -45,7 +45,9 @@ public class EyeTrackingUtilityEditor : ModuleRules
 				"UnrealEd",
 				"UMG",
 				"Blutility",
-				"Niagara"
+				"Niagara",
+				"MeshDescription",
+				"StaticMeshDescription"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
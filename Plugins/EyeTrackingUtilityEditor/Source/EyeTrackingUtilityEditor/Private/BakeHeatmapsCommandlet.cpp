@@ -0,0 +1,440 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "BakeHeatmapsCommandlet.h"
+
+#include "EngineUtils.h"
+#include "ImageUtils.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include "HeatmapGrid.h"
+#include "HeatmapReadyActor.h"
+#include "HeatmapVisibility.h"
+#include "GazeRayStream.h"
+#include "GazeReprojection.h"
+#include "JsonParser.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBakeHeatmaps, Log, All);
+
+UBakeHeatmapsCommandlet::UBakeHeatmapsCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UBakeHeatmapsCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamsMap;
+	ParseCommandLine(*Params, Tokens, Switches, ParamsMap);
+
+	const FString* MapPath = ParamsMap.Find("Map");
+	const FString* SessionsParam = ParamsMap.Find("Sessions");
+
+	if (!MapPath || !SessionsParam)
+	{
+		UE_LOG(LogBakeHeatmaps, Error, TEXT("Usage: -run=BakeHeatmaps -Map=<map> -Sessions=<dir or files> "
+			"[-Output=<dir>] [-Resolution=512] [-BrushRadius=0.025] [-Threshold=0] "
+			"[-Composite [-NoParticipantNormalization]] [-Hotspots=5] [-Reproject]"));
+		return 1;
+	}
+
+	const FString OutputDirectory = ParamsMap.Contains("Output") ?
+		ParamsMap["Output"] : FPaths::ProjectSavedDir() + "BakedHeatmaps/";
+
+	const int32 Resolution = ParamsMap.Contains("Resolution") ?
+		FCString::Atoi(*ParamsMap["Resolution"]) : FHeatmapAccumulator::DefaultResolution;
+
+	const float BrushRadius = ParamsMap.Contains("BrushRadius") ?
+		FCString::Atof(*ParamsMap["BrushRadius"]) : FHeatmapAccumulator::DefaultBrushRadius;
+
+	const float MetricsThreshold = ParamsMap.Contains("Threshold") ? FCString::Atof(*ParamsMap["Threshold"]) : 0.f;
+
+	const bool bComposite = Switches.Contains("Composite");
+	const bool bNormalizePerParticipant = !Switches.Contains("NoParticipantNormalization");
+	const bool bReproject = Switches.Contains("Reproject");
+
+	FHeatmapHotspotSettings HotspotSettings;
+
+	if (ParamsMap.Contains("Hotspots"))
+		HotspotSettings.MaxHotspots = FCString::Atoi(*ParamsMap["Hotspots"]);
+
+	const TArray<FString> SessionFiles = FindSessionFiles(*SessionsParam);
+
+	if (SessionFiles.IsEmpty())
+	{
+		UE_LOG(LogBakeHeatmaps, Error, TEXT("No session files found for %s"), **SessionsParam);
+		return 1;
+	}
+
+	UWorld* World = LoadWorld(*MapPath, bReproject);
+
+	if (!World)
+	{
+		UE_LOG(LogBakeHeatmaps, Error, TEXT("Failed to load map %s"), **MapPath);
+		return 1;
+	}
+
+	IFileManager::Get().MakeDirectory(*OutputDirectory, true);
+
+	FHeatmapAccumulator Accumulator(Resolution, BrushRadius);
+
+	for (TActorIterator<AHeatmapReadyActor> It(World); It; ++It)
+		Accumulator.SetScaleDivisors(*It);
+
+	TMap<FString, TMap<FString, FAttentionMetricsEntry>> MetricsBySession;
+	TMap<FString, TArray<FHeatmapSegmentMetrics>> SegmentMetricsBySession;
+	TMap<FString, TArray<FHeatmapHotspot>> HotspotsBySession;
+	TArray<TArray<FAttentionTrackingDataPoint>> CompositeSessions;
+	int32 FailedSessionsNum = 0;
+
+	for (const FString& SessionFile : SessionFiles)
+	{
+		const FString SessionName = FPaths::GetBaseFilename(SessionFile);
+
+		UE_LOG(LogBakeHeatmaps, Display, TEXT("Baking %s"), *SessionName);
+
+		Accumulator.Reset();
+
+		TArray<FAttentionTrackingDataPoint> AttentionTrackingData;
+
+		if (!BakeSession(World, SessionFile, OutputDirectory / SessionName, bReproject, MetricsThreshold, Accumulator,
+			AttentionTrackingData, HotspotSettings, MetricsBySession.Add(SessionName),
+			SegmentMetricsBySession.Add(SessionName), HotspotsBySession.Add(SessionName)))
+		{
+			MetricsBySession.Remove(SessionName);
+			SegmentMetricsBySession.Remove(SessionName);
+			HotspotsBySession.Remove(SessionName);
+			++FailedSessionsNum;
+		}
+
+		else if (bComposite)
+			CompositeSessions.Add(MoveTemp(AttentionTrackingData));
+	}
+
+	if (bComposite && !CompositeSessions.IsEmpty())
+	{
+		UE_LOG(LogBakeHeatmaps, Display, TEXT("Baking composite of %d sessions"), CompositeSessions.Num());
+
+		TArray<const TArray<FAttentionTrackingDataPoint>*> SessionData;
+
+		for (const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData : CompositeSessions)
+			SessionData.Add(&AttentionTrackingData);
+
+		Accumulator.Reset();
+		Accumulator.AccumulateComposite(SessionData, bNormalizePerParticipant);
+
+		IFileManager::Get().MakeDirectory(*(OutputDirectory / "Composite"), true);
+		WriteHeatmapImages(World, Accumulator, OutputDirectory / "Composite");
+	}
+
+	WriteMetricsTable(MetricsBySession, OutputDirectory / "AttentionMetrics.csv");
+	WriteSegmentMetricsTable(SegmentMetricsBySession, OutputDirectory / "SegmentMetrics.csv");
+	WriteHotspotsTable(HotspotsBySession, OutputDirectory / "Hotspots.csv");
+
+	UnloadWorld(World);
+
+	UE_LOG(LogBakeHeatmaps, Display, TEXT("Baked %d of %d sessions to %s"),
+		SessionFiles.Num() - FailedSessionsNum, SessionFiles.Num(), *OutputDirectory);
+
+	return FailedSessionsNum == 0 ? 0 : 1;
+}
+
+UWorld* UBakeHeatmapsCommandlet::LoadWorld(const FString& MapPath, const bool bTraceCollision)
+{
+	UPackage* Package = LoadPackage(nullptr, *MapPath, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+
+	if (!World) return nullptr;
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Editor;
+
+	if (!World->bIsWorldInitialized)
+	{
+		// Only the actors' data is needed, no navigation or rendering, and no physics unless rays are re-traced
+		World->InitWorld(UWorld::InitializationValues()
+			.RequiresHitProxies(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(bTraceCollision)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(bTraceCollision));
+	}
+
+	World->UpdateWorldComponents(true, false);
+
+	return World;
+}
+
+void UBakeHeatmapsCommandlet::UnloadWorld(UWorld* World)
+{
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+TArray<FString> UBakeHeatmapsCommandlet::FindSessionFiles(const FString& SessionsParam)
+{
+	TArray<FString> SessionFiles;
+
+	TArray<FString> Entries;
+	SessionsParam.ParseIntoArray(Entries, TEXT(","));
+
+	for (FString Entry : Entries)
+	{
+		// Bare file names refer to the usual data folder
+		if (FPaths::IsRelative(Entry) && !FPaths::FileExists(Entry) && !FPaths::DirectoryExists(Entry))
+			Entry = UJsonParser::AttentionTrackingDataFolderPath() + Entry;
+
+		if (FPaths::DirectoryExists(Entry))
+		{
+			TArray<FString> DirectoryFiles;
+			IFileManager::Get().FindFiles(DirectoryFiles, *(Entry / "*.json"), true, false);
+
+			for (const FString& DirectoryFile : DirectoryFiles)
+				SessionFiles.Add(Entry / DirectoryFile);
+		}
+
+		else if (FPaths::FileExists(Entry))
+			SessionFiles.Add(Entry);
+
+		else
+			UE_LOG(LogBakeHeatmaps, Warning, TEXT("Session %s not found"), *Entry);
+	}
+
+	SessionFiles.Sort();
+
+	return SessionFiles;
+}
+
+bool UBakeHeatmapsCommandlet::BakeSession(UWorld* World, const FString& SessionFilePath,
+	const FString& OutputDirectory, const bool bReproject, const float MetricsThreshold,
+	FHeatmapAccumulator& Accumulator, TArray<FAttentionTrackingDataPoint>& OutAttentionTrackingData,
+	const FHeatmapHotspotSettings& HotspotSettings, TMap<FString, FAttentionMetricsEntry>& OutMetrics,
+	TArray<FHeatmapSegmentMetrics>& OutSegmentMetrics, TArray<FHeatmapHotspot>& OutHotspots)
+{
+	bool bOutSuccess;
+
+	FGazeRayStream GazeRays;
+	FGazePointCloud GazePoints;
+	bool bHasGazePoints = false;
+
+	if (bReproject && GazeRays.LoadFromFile(FGazeRayStream::GetSidecarFilePath(SessionFilePath)))
+	{
+		if (!FGazeReprojector::Reproject(World, GazeRays, OutAttentionTrackingData, &GazePoints))
+		{
+			UE_LOG(LogBakeHeatmaps, Error, TEXT("Failed to re-project %s"), *SessionFilePath);
+			return false;
+		}
+
+		UE_LOG(LogBakeHeatmaps, Display, TEXT("Re-projected %d gaze rays"), GazeRays.Num());
+
+		bHasGazePoints = true;
+	}
+
+	else
+	{
+		if (bReproject)
+			UE_LOG(LogBakeHeatmaps, Warning, TEXT("No gaze rays recorded for %s, using its UVs"), *SessionFilePath);
+
+		TMap<int32, FVector2D> LegacyScaleDivisors;
+
+		UJsonParser::ReadAttentionTrackingDataFromJsonFile(SessionFilePath, OutAttentionTrackingData,
+			LegacyScaleDivisors, bOutSuccess);
+
+		if (!bOutSuccess)
+		{
+			UE_LOG(LogBakeHeatmaps, Error, TEXT("Failed to read %s"), *SessionFilePath);
+			return false;
+		}
+
+		UHeatmapRT::ResolveLegacyActorGuids(OutAttentionTrackingData, World);
+
+		if (!LegacyScaleDivisors.IsEmpty())
+			UHeatmapRT::ResolveLegacyScaleDivisors(OutAttentionTrackingData, LegacyScaleDivisors, World);
+
+		bHasGazePoints = GazePoints.LoadFromFile(FGazePointCloud::GetSidecarFilePath(SessionFilePath));
+	}
+
+	UHeatmapRT::CompressAttentionTrackingData(OutAttentionTrackingData);
+
+	bool bSegmentMarkersRead;
+	const TArray<FHeatmapSegmentMarker> SegmentMarkers = UJsonParser::ReadSegmentMarkersFromJsonFile(
+		UJsonParser::SegmentMarkersFilePath(SessionFilePath), bSegmentMarkersRead);
+
+	TMap<FString, FString> MetricsNames;
+	UHeatmapRT::GetMetricsNames(World, MetricsNames);
+	UHeatmapRT::ComputeAttentionMetrics(OutAttentionTrackingData, MetricsNames, MetricsThreshold, SegmentMarkers,
+		OutMetrics, OutSegmentMetrics);
+
+	// Density metrics use their own resolution, not the bake's, so they match the editor's
+	UHeatmapRT::ComputeDensityMetrics(OutAttentionTrackingData, MetricsNames, World, OutMetrics);
+	Accumulator.Accumulate(OutAttentionTrackingData);
+
+	bool bVisibleTimesRead;
+	UHeatmapRT::ApplyVisibleTimes(UJsonParser::ReadFloatMapFromJsonFile(
+		FHeatmapVisibilityTracker::GetSidecarFilePath(SessionFilePath), bVisibleTimesRead), OutMetrics);
+
+	IFileManager::Get().MakeDirectory(*OutputDirectory, true);
+
+	if (!GazeRays.GetRays().IsEmpty())
+		UJsonParser::WriteAttentionTrackingDataToJsonFile(OutAttentionTrackingData, OutputDirectory / "Session.json",
+			bOutSuccess);
+
+	UJsonParser::WriteAttentionMetricsToJsonFile(OutMetrics, OutputDirectory / "AttentionMetrics.json", bOutSuccess);
+
+	FHeatmapHotspotFinder::FindUvHotspots(OutAttentionTrackingData, MetricsNames, HotspotSettings, OutHotspots);
+
+	if (bHasGazePoints)
+	{
+		TArray<FHeatmapHotspot> WorldHotspots;
+		FHeatmapHotspotFinder::FindWorldHotspots(GazePoints, HotspotSettings, WorldHotspots);
+
+		OutHotspots.Append(WorldHotspots);
+	}
+
+	UJsonParser::WriteHotspotsToJsonFile(OutHotspots, OutputDirectory / "Hotspots.json", bOutSuccess);
+
+	WriteHeatmapImages(World, Accumulator, OutputDirectory);
+
+	return true;
+}
+
+void UBakeHeatmapsCommandlet::WriteHeatmapImages(UWorld* World, const FHeatmapAccumulator& Accumulator,
+	const FString& OutputDirectory)
+{
+	TMap<FGuid, FString> ImageNames;
+
+	for (TActorIterator<AHeatmapReadyActor> It(World); It; ++It)
+	{
+		ImageNames.Add(It->HeatmapActorGuid,
+			FPaths::MakeValidFileName(It->GetActorLabel()) + "_" + It->HeatmapActorGuid.ToString());
+	}
+
+	TArray<const FHeatmapGrid*> Grids;
+	TArray<FString> ImagePaths;
+
+	for (const TPair<FGuid, FHeatmapGrid>& Entry : Accumulator.GetGrids())
+	{
+		const FString* ImageName = ImageNames.Find(Entry.Key);
+
+		Grids.Add(&Entry.Value);
+		ImagePaths.Add(OutputDirectory / (ImageName ? *ImageName : Entry.Key.ToString()) + ".png");
+	}
+
+	ParallelFor(Grids.Num(), [&Grids, &ImagePaths](const int32 i)
+	{
+		const FHeatmapGrid& Grid = *Grids[i];
+
+		TArray<FColor> Colors;
+		Grid.ToColors(Colors, Grid.GetMax());
+
+		TArray64<uint8> Png;
+		FImageUtils::PNGCompressImageArray(Grid.Resolution, Grid.Resolution, Colors, Png);
+
+		if (!FFileHelper::SaveArrayToFile(Png, *ImagePaths[i]))
+			UE_LOG(LogBakeHeatmaps, Error, TEXT("Failed to write %s"), *ImagePaths[i]);
+	});
+}
+
+void UBakeHeatmapsCommandlet::WriteMetricsTable(
+	const TMap<FString, TMap<FString, FAttentionMetricsEntry>>& MetricsBySession, const FString& FilePath)
+{
+	FString Table = "Session,Name,TotalAttentionTime,AverageAttentionTime,FirstAttentionAfter,TimesFocussed,VisibleTime,"
+		"AttendedToVisibleRatio,Coverage,Entropy,PeakDensity,DensityCentroidU,DensityCentroidV,DensityVarianceU,"
+		"DensityVarianceV,DensityCovariance\n";
+
+	for (const TPair<FString, TMap<FString, FAttentionMetricsEntry>>& Session : MetricsBySession)
+	{
+		for (const TPair<FString, FAttentionMetricsEntry>& Entry : Session.Value)
+		{
+			Table += FString::Printf(TEXT("%s,%s,%f,%f,%f,%d,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n"), *CsvField(Session.Key),
+				*CsvField(Entry.Key), Entry.Value.TotalAttentionTime, Entry.Value.AverageAttentionTime,
+				Entry.Value.FirstAttentionAfter, Entry.Value.TimesFocussed, Entry.Value.VisibleTime,
+				Entry.Value.AttendedToVisibleRatio, Entry.Value.Coverage, Entry.Value.Entropy, Entry.Value.PeakDensity,
+				Entry.Value.DensityCentroid.X, Entry.Value.DensityCentroid.Y, Entry.Value.DensityVariance.X,
+				Entry.Value.DensityVariance.Y, Entry.Value.DensityCovariance);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Table, *FilePath))
+		UE_LOG(LogBakeHeatmaps, Error, TEXT("Failed to write %s"), *FilePath);
+}
+
+void UBakeHeatmapsCommandlet::WriteSegmentMetricsTable(
+	const TMap<FString, TArray<FHeatmapSegmentMetrics>>& SegmentMetricsBySession, const FString& FilePath)
+{
+	FString Table = "Session,Segment,FromWaypoint,ToWaypoint,StartTime,EndTime,Name,TotalAttentionTime,"
+		"AverageAttentionTime,FirstAttentionAfter,TimesFocussed\n";
+
+	for (const TPair<FString, TArray<FHeatmapSegmentMetrics>>& Session : SegmentMetricsBySession)
+	{
+		for (int32 i = 0; i < Session.Value.Num(); ++i)
+		{
+			const FHeatmapSegmentMetrics& Segment = Session.Value[i];
+
+			// Start and end of the route have no waypoint
+			const FString FromWaypoint = Segment.FromWaypointIndex != INDEX_NONE ?
+				FString::FromInt(Segment.FromWaypointIndex) : TEXT("Start");
+			const FString ToWaypoint = Segment.ToWaypointIndex != INDEX_NONE ?
+				FString::FromInt(Segment.ToWaypointIndex) : TEXT("End");
+
+			for (const TPair<FString, FAttentionMetricsEntry>& Entry : Segment.Metrics)
+			{
+				Table += FString::Printf(TEXT("%s,%d,%s,%s,%f,%f,%s,%f,%f,%f,%d\n"), *CsvField(Session.Key), i,
+					*FromWaypoint, *ToWaypoint, Segment.StartTime, Segment.EndTime, *CsvField(Entry.Key),
+					Entry.Value.TotalAttentionTime, Entry.Value.AverageAttentionTime, Entry.Value.FirstAttentionAfter,
+					Entry.Value.TimesFocussed);
+			}
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Table, *FilePath))
+		UE_LOG(LogBakeHeatmaps, Error, TEXT("Failed to write %s"), *FilePath);
+}
+
+void UBakeHeatmapsCommandlet::WriteHotspotsTable(const TMap<FString, TArray<FHeatmapHotspot>>& HotspotsBySession,
+	const FString& FilePath)
+{
+	FString Table = "Session,Space,Rank,Name,CentroidX,CentroidY,CentroidZ,ExtentX,ExtentY,ExtentZ,DwellTime,"
+		"SampleCount,Timestamps\n";
+
+	for (const TPair<FString, TArray<FHeatmapHotspot>>& Session : HotspotsBySession)
+	{
+		for (const FHeatmapHotspot& Hotspot : Session.Value)
+		{
+			// Semicolons keep the timestamp list in one column
+			FString Timestamps;
+
+			for (const float Timestamp : Hotspot.Timestamps)
+				Timestamps += (Timestamps.IsEmpty() ? TEXT("") : TEXT(";")) + FString::SanitizeFloat(Timestamp);
+
+			Table += FString::Printf(TEXT("%s,%s,%d,%s,%f,%f,%f,%f,%f,%f,%f,%d,%s\n"), *CsvField(Session.Key),
+				Hotspot.Space == EHeatmapHotspotSpace::EHHS_World ? TEXT("World") : TEXT("UV"), Hotspot.Rank,
+				*CsvField(Hotspot.Name), Hotspot.Centroid.X, Hotspot.Centroid.Y, Hotspot.Centroid.Z, Hotspot.Extent.X,
+				Hotspot.Extent.Y, Hotspot.Extent.Z, Hotspot.DwellTime, Hotspot.SampleCount, *Timestamps);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Table, *FilePath))
+		UE_LOG(LogBakeHeatmaps, Error, TEXT("Failed to write %s"), *FilePath);
+}
+
+FString UBakeHeatmapsCommandlet::CsvField(const FString& Field)
+{
+	// Metrics and session names are user-chosen and may contain commas
+	if (!Field.Contains(TEXT(",")) && !Field.Contains(TEXT("\"")) && !Field.Contains(TEXT("\n")) &&
+		!Field.Contains(TEXT("\r")))
+		return Field;
+
+	return TEXT("\"") + Field.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"");
+}
@@ -0,0 +1,147 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "CollisionCookingSubsystem.h"
+
+#include "Editor.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Misc/SecureHash.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "StaticMeshResources.h"
+
+#include "JsonParser.h"
+#include "DebugHeader.h"
+
+void UCollisionCookingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	bool bOutSuccess;
+	CookedMeshHashes = UJsonParser::ReadStringMapFromJsonFile(CacheFilePath(), bOutSuccess);
+}
+
+UCollisionCookingSubsystem* UCollisionCookingSubsystem::Get()
+{
+	return GEditor ? GEditor->GetEditorSubsystem<UCollisionCookingSubsystem>() : nullptr;
+}
+
+void UCollisionCookingSubsystem::PrepareComplexCollision(const TArray<UStaticMesh*>& StaticMeshes)
+{
+	TSet<UStaticMesh*> UniqueStaticMeshes(StaticMeshes);
+
+	TArray<UBodySetup*> BodySetupsToCook;
+	TArray<FString> MeshPaths;
+	TArray<FString> MeshHashes;
+
+	for (UStaticMesh* StaticMesh : UniqueStaticMeshes)
+	{
+		if (!StaticMesh) continue;
+
+		UBodySetup* BodySetup = StaticMesh->GetBodySetup();
+
+		if (!BodySetup) continue;
+
+		const FString MeshPath = StaticMesh->GetPathName();
+		const FString* CachedHash = CookedMeshHashes.Find(MeshPath);
+
+		// The hash covers the trace flag, so a mesh switched back to simple collision is cooked again
+		if (CachedHash && *CachedHash == ComputeMeshHash(StaticMesh)) continue;
+
+		BodySetup->Modify();
+		BodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
+		BodySetup->InvalidatePhysicsData();
+
+		BodySetupsToCook.Add(BodySetup);
+		MeshPaths.Add(MeshPath);
+		MeshHashes.Add(ComputeMeshHash(StaticMesh));
+	}
+
+	const int32 CooksNum = BodySetupsToCook.Num();
+
+	if (CooksNum == 0) return;
+
+	FScopedSlowTask SlowTask(CooksNum,
+		FText::FromString("Cooking complex collision for " + FString::FromInt(CooksNum) + " meshes"));
+	SlowTask.MakeDialog();
+
+	// Cooking runs on the task graph, completion is reported back on the game thread. The callbacks share
+	// ownership of the results, so one that fires late never writes into a finished call's stack
+	struct FCookResults
+	{
+		int32 PendingCooksNum = 0;
+		TArray<bool> CookSucceeded;
+	};
+
+	const TSharedRef<FCookResults, ESPMode::ThreadSafe> CookResults = MakeShared<FCookResults, ESPMode::ThreadSafe>();
+	CookResults->PendingCooksNum = CooksNum;
+	CookResults->CookSucceeded.SetNumZeroed(CooksNum);
+
+	for (int32 i = 0; i < CooksNum; ++i)
+	{
+		BodySetupsToCook[i]->CreatePhysicsMeshesAsync(FOnAsyncPhysicsCookFinished::CreateLambda(
+			[CookResults, i](const bool bSuccess)
+			{
+				CookResults->CookSucceeded[i] = bSuccess;
+				--CookResults->PendingCooksNum;
+			}));
+	}
+
+	int32 ReportedCooksNum = 0;
+
+	while (CookResults->PendingCooksNum > 0)
+	{
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+
+		const int32 FinishedCooksNum = CooksNum - CookResults->PendingCooksNum;
+		SlowTask.EnterProgressFrame(FinishedCooksNum - ReportedCooksNum);
+		ReportedCooksNum = FinishedCooksNum;
+
+		if (CookResults->PendingCooksNum > 0)
+			FPlatformProcess::Sleep(0.005f);
+	}
+
+	int32 FailedCooksNum = 0;
+
+	for (int32 i = 0; i < CooksNum; ++i)
+	{
+		if (CookResults->CookSucceeded[i])
+			CookedMeshHashes.Add(MeshPaths[i], MeshHashes[i]);
+		else
+			++FailedCooksNum;
+	}
+
+	DebugHeader::ShowNotifyInfoIf(FailedCooksNum > 0,
+		"Complex collision cooking failed for " + FString::FromInt(FailedCooksNum) + " meshes");
+
+	SaveCache();
+}
+
+void UCollisionCookingSubsystem::ClearCache()
+{
+	CookedMeshHashes.Empty();
+	SaveCache();
+}
+
+FString UCollisionCookingSubsystem::ComputeMeshHash(const UStaticMesh* StaticMesh)
+{
+	// The derived data key changes with the source geometry and its build settings
+	const FStaticMeshRenderData* RenderData = StaticMesh->GetRenderData();
+	const UBodySetup* BodySetup = StaticMesh->GetBodySetup();
+
+	FString HashSource = RenderData ? RenderData->DerivedDataKey : StaticMesh->GetPathName();
+
+	if (BodySetup)
+		HashSource += BodySetup->BodySetupGuid.ToString() + FString::FromInt(BodySetup->CollisionTraceFlag.GetValue());
+
+	return FMD5::HashAnsiString(*HashSource);
+}
+
+FString UCollisionCookingSubsystem::CacheFilePath()
+{
+	return UJsonParser::CacheFolderPath() + "CollisionCookCache.json";
+}
+
+void UCollisionCookingSubsystem::SaveCache()
+{
+	bool bOutSuccess;
+	UJsonParser::WriteStringMapToJsonFile(CookedMeshHashes, CacheFilePath(), bOutSuccess);
+}
@@ -0,0 +1,173 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "EditorActorCacheSubsystem.h"
+
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "Engine/StaticMeshActor.h"
+
+#include "HeatmapReadyActor.h"
+#include "Waypoint.h"
+
+void UEditorActorCacheSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (GEngine)
+	{
+		LevelActorAddedHandle =
+			GEngine->OnLevelActorAdded().AddUObject(this, &UEditorActorCacheSubsystem::OnLevelActorAdded);
+		LevelActorDeletedHandle =
+			GEngine->OnLevelActorDeleted().AddUObject(this, &UEditorActorCacheSubsystem::OnLevelActorDeleted);
+	}
+
+	// Neither loading a map, streaming a sublevel nor undo/redo report their actors individually
+	MapChangeHandle = FEditorDelegates::MapChange.AddUObject(this, &UEditorActorCacheSubsystem::OnMapChange);
+	PostUndoRedoHandle = FEditorDelegates::PostUndoRedo.AddUObject(this, &UEditorActorCacheSubsystem::MarkDirty);
+	LevelAddedHandle =
+		FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UEditorActorCacheSubsystem::OnLevelsChanged);
+	LevelRemovedHandle =
+		FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UEditorActorCacheSubsystem::OnLevelsChanged);
+}
+
+void UEditorActorCacheSubsystem::Deinitialize()
+{
+	if (GEngine)
+	{
+		GEngine->OnLevelActorAdded().Remove(LevelActorAddedHandle);
+		GEngine->OnLevelActorDeleted().Remove(LevelActorDeletedHandle);
+	}
+
+	FEditorDelegates::MapChange.Remove(MapChangeHandle);
+	FEditorDelegates::PostUndoRedo.Remove(PostUndoRedoHandle);
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	StaticMeshActors.Empty();
+	HeatmapReadyActors.Empty();
+	Waypoints.Empty();
+
+	Super::Deinitialize();
+}
+
+UEditorActorCacheSubsystem* UEditorActorCacheSubsystem::Get()
+{
+	return GEditor ? GEditor->GetEditorSubsystem<UEditorActorCacheSubsystem>() : nullptr;
+}
+
+TArray<AStaticMeshActor*> UEditorActorCacheSubsystem::GetStaticMeshActors()
+{
+	RebuildIfDirty();
+	return ToArray(StaticMeshActors);
+}
+
+TArray<AHeatmapReadyActor*> UEditorActorCacheSubsystem::GetHeatmapReadyActors()
+{
+	RebuildIfDirty();
+	return ToArray(HeatmapReadyActors);
+}
+
+TArray<AWaypoint*> UEditorActorCacheSubsystem::GetWaypoints()
+{
+	RebuildIfDirty();
+	return ToArray(Waypoints);
+}
+
+void UEditorActorCacheSubsystem::OnLevelActorAdded(AActor* Actor)
+{
+	if (!bDirty && IsEditorWorldActor(Actor))
+		AddActor(Actor);
+}
+
+void UEditorActorCacheSubsystem::OnLevelActorDeleted(AActor* Actor)
+{
+	if (!bDirty)
+		RemoveActor(Actor);
+}
+
+void UEditorActorCacheSubsystem::OnMapChange(uint32 MapChangeFlags)
+{
+	bDirty = true;
+}
+
+void UEditorActorCacheSubsystem::OnLevelsChanged(ULevel* Level, UWorld* World)
+{
+	if (World && World->WorldType == EWorldType::Editor)
+		bDirty = true;
+}
+
+bool UEditorActorCacheSubsystem::IsEditorWorldActor(const AActor* Actor)
+{
+	if (!Actor) return false;
+
+	const UWorld* World = Actor->GetWorld();
+
+	return World && World->WorldType == EWorldType::Editor;
+}
+
+void UEditorActorCacheSubsystem::AddActor(AActor* Actor)
+{
+	if (AHeatmapReadyActor* HeatmapReadyActor = Cast<AHeatmapReadyActor>(Actor))
+		HeatmapReadyActors.Add(HeatmapReadyActor);
+
+	else if (AStaticMeshActor* StaticMeshActor = Cast<AStaticMeshActor>(Actor))
+		StaticMeshActors.Add(StaticMeshActor);
+
+	else if (AWaypoint* Waypoint = Cast<AWaypoint>(Actor))
+		Waypoints.Add(Waypoint);
+}
+
+void UEditorActorCacheSubsystem::RemoveActor(AActor* Actor)
+{
+	if (AHeatmapReadyActor* HeatmapReadyActor = Cast<AHeatmapReadyActor>(Actor))
+		HeatmapReadyActors.Remove(HeatmapReadyActor);
+
+	else if (AStaticMeshActor* StaticMeshActor = Cast<AStaticMeshActor>(Actor))
+		StaticMeshActors.Remove(StaticMeshActor);
+
+	else if (AWaypoint* Waypoint = Cast<AWaypoint>(Actor))
+		Waypoints.Remove(Waypoint);
+}
+
+void UEditorActorCacheSubsystem::Rebuild()
+{
+	StaticMeshActors.Reset();
+	HeatmapReadyActors.Reset();
+	Waypoints.Reset();
+
+	bDirty = false;
+
+	UWorld* World = GEditor ? GEditor->GetEditorWorldContext().World() : nullptr;
+
+	if (!World) return;
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+		AddActor(*It);
+}
+
+void UEditorActorCacheSubsystem::RebuildIfDirty()
+{
+	if (bDirty) Rebuild();
+}
+
+template<typename ActorType>
+TArray<ActorType*> UEditorActorCacheSubsystem::ToArray(TSet<TWeakObjectPtr<ActorType>>& Actors)
+{
+	TArray<ActorType*> Result;
+	Result.Reserve(Actors.Num());
+
+	for (auto It = Actors.CreateIterator(); It; ++It)
+	{
+		ActorType* Actor = It->Get();
+
+		if (!IsValid(Actor))
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		Result.Add(Actor);
+	}
+
+	return Result;
+}
@@ -10,7 +10,12 @@
 #include "EyeTrackingUtilityEditor.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/ComboBoxString.h"
+#include "ScopedTransaction.h"
+#include "Misc/ScopedSlowTask.h"
 
+#include "CollisionCookingSubsystem.h"
+#include "EditorActorCacheSubsystem.h"
+#include "HeatmapUvSubsystem.h"
 #include "HeatmapRT.h"
 #include "HeatmapReadyActor.h"
 #include "DebugHeader.h"
@@ -19,76 +24,158 @@ UEditorActorSubsystem* UEyeTrackingEditorWidget::EditorActorSubsystem = nullptr;
 
 TArray<AStaticMeshActor*> UEyeTrackingEditorWidget::GetAllStaticMeshActorsInLevel()
 {
-	TArray<AStaticMeshActor*> AllStaticMeshActorsInLevel;
+	UEditorActorCacheSubsystem* ActorCache = UEditorActorCacheSubsystem::Get();
 
-	if (!GetEditorActorSubsystem())
-		return AllStaticMeshActorsInLevel;
+	return ActorCache ? ActorCache->GetStaticMeshActors() : TArray<AStaticMeshActor*>();
+}
+
+TArray<AHeatmapReadyActor*> UEyeTrackingEditorWidget::GetAllHeatmapReadyActorsInLevel()
+{
+	UEditorActorCacheSubsystem* ActorCache = UEditorActorCacheSubsystem::Get();
 
-	TArray<AActor*> AllLevelActors = EditorActorSubsystem->GetAllLevelActors();
+	return ActorCache ? ActorCache->GetHeatmapReadyActors() : TArray<AHeatmapReadyActor*>();
+}
 
-	for (AActor* LevelActor : AllLevelActors)
+void UEyeTrackingEditorWidget::ConvertStaticMeshActors(const TArray<AStaticMeshActor*>& StaticMeshActors,
+	const TSubclassOf<AHeatmapReadyActor> HeatmapReadyActorClass)
+{
+	if (!HeatmapReadyActorClass || StaticMeshActors.IsEmpty()) return;
+
+	TArray<FHeatmapReadyActorConversion> Conversions;
+	Conversions.Reserve(StaticMeshActors.Num());
+
+	for (AStaticMeshActor* StaticMeshActor : StaticMeshActors)
 	{
-		if (AStaticMeshActor* StaticMeshActor = Cast<AStaticMeshActor>(LevelActor))
-			AllStaticMeshActorsInLevel.Add(StaticMeshActor);
+		FHeatmapReadyActorConversion Conversion;
+
+		if (GatherConversion(StaticMeshActor, Conversion))
+			Conversions.Add(MoveTemp(Conversion));
 	}
 
-	return AllStaticMeshActorsInLevel;
-}
+	const int32 ConversionsNum = Conversions.Num();
 
-TArray<AHeatmapReadyActor*> UEyeTrackingEditorWidget::GetAllHeatmapReadyActorsInLevel()
-{
-	TArray<AHeatmapReadyActor*> AllHeatmapReadyActorsInLevel;
+	if (ConversionsNum == 0) return;
 
-	if (!GetEditorActorSubsystem())
-		return AllHeatmapReadyActorsInLevel;
+	FScopedSlowTask SlowTask(ConversionsNum + 1,
+		FText::FromString("Converting " + FString::FromInt(ConversionsNum) + " StaticMeshActors"));
+	SlowTask.MakeDialog(true);
 
-	TArray<AActor*> AllLevelActors = EditorActorSubsystem->GetAllLevelActors();
-	
-	for (AActor* LevelActor : AllLevelActors)
+	const FScopedTransaction Transaction(FText::FromString("Convert StaticMeshActors to HeatmapReadyActors"));
+
+	SlowTask.EnterProgressFrame(1, FText::FromString("Preparing static meshes"));
+	PrepareStaticMeshes(Conversions);
+
+	TArray<AHeatmapReadyActor*> ConvertedActors;
+	int32 AttemptedNum = 0;
+
+	for (const FHeatmapReadyActorConversion& Conversion : Conversions)
 	{
-		AHeatmapReadyActor* StaticMeshActor = Cast<AHeatmapReadyActor>(LevelActor);
+		if (SlowTask.ShouldCancel()) break;
+
+		++AttemptedNum;
 
-		if (StaticMeshActor) AllHeatmapReadyActorsInLevel.Add(StaticMeshActor);
+		SlowTask.EnterProgressFrame(1);
+
+		if (AHeatmapReadyActor* HeatmapReadyActor = ReplaceStaticMeshActorWithHeatmapReadyActor(Conversion, HeatmapReadyActorClass))
+			ConvertedActors.Add(HeatmapReadyActor);
 	}
 
-	return AllHeatmapReadyActorsInLevel;
+	const int32 ConvertedNum = ConvertedActors.Num();
+
+	if (UHeatmapUvSubsystem* HeatmapUv = UHeatmapUvSubsystem::Get())
+		HeatmapUv->AssignHeatmapUvChannels(ConvertedActors);
+
+	DebugHeader::ShowNotifyInfoIf(AttemptedNum < ConversionsNum, "Conversion cancelled after " +
+		FString::FromInt(AttemptedNum) + " of " + FString::FromInt(ConversionsNum) + " actors");
+
+	DebugHeader::ShowNotifyInfoIf(ConvertedNum < AttemptedNum, "Conversion failed for " +
+		FString::FromInt(AttemptedNum - ConvertedNum) + " actors");
 }
 
-void UEyeTrackingEditorWidget::ReplaceStaticMeshActorWithHeatmapReadyActor(AStaticMeshActor* StaticMeshActor,
-	const TSubclassOf<AHeatmapReadyActor> HeatmapReadyActorClass)
+bool UEyeTrackingEditorWidget::GatherConversion(AStaticMeshActor* StaticMeshActor,
+	FHeatmapReadyActorConversion& OutConversion)
 {
-	if (!StaticMeshActor) return;
+	if (!StaticMeshActor) return false;
 
 	const UStaticMeshComponent* StaticMeshComponent = StaticMeshActor->GetStaticMeshComponent();
 
-	if (!StaticMeshComponent) return;
+	if (!StaticMeshComponent || !StaticMeshComponent->GetStaticMesh()) return false;
 
-	UStaticMesh* StaticMesh = StaticMeshComponent->GetStaticMesh();
+	OutConversion.StaticMeshActor = StaticMeshActor;
+	OutConversion.StaticMesh = StaticMeshComponent->GetStaticMesh();
+	OutConversion.Materials = StaticMeshComponent->GetMaterials();
+	OutConversion.Transform = FTransform(StaticMeshActor->GetActorRotation(), StaticMeshActor->GetActorLocation(),
+		StaticMeshComponent->GetComponentScale());
+
+	return true;
+}
+
+void UEyeTrackingEditorWidget::PrepareStaticMeshes(TArray<FHeatmapReadyActorConversion>& Conversions)
+{
+	TSet<UStaticMesh*> UniqueStaticMeshes;
+
+	for (const FHeatmapReadyActorConversion& Conversion : Conversions)
+		UniqueStaticMeshes.Add(Conversion.StaticMesh);
+
+	TArray<UStaticMesh*> ComplexCollisionMeshes;
+	TSet<UStaticMesh*> ComplexCollisionMeshSet;
+
+	for (UStaticMesh* StaticMesh : UniqueStaticMeshes)
+	{
+		const UBodySetup* BodySetup = StaticMesh->GetBodySetup();
 
-	TArray<UMaterialInterface*> Materials = StaticMeshComponent->GetMaterials();
+		if (!BodySetup || BodySetup->AggGeom.GetElementCount() > 0) continue;
+
+		ComplexCollisionMeshes.Add(StaticMesh);
+		ComplexCollisionMeshSet.Add(StaticMesh);
+	}
+
+	if (UCollisionCookingSubsystem* CollisionCooking = UCollisionCookingSubsystem::Get())
+		CollisionCooking->PrepareComplexCollision(ComplexCollisionMeshes);
+
+	for (FHeatmapReadyActorConversion& Conversion : Conversions)
+		Conversion.bNeedsComplexCollision = ComplexCollisionMeshSet.Contains(Conversion.StaticMesh);
+}
+
+AHeatmapReadyActor* UEyeTrackingEditorWidget::ReplaceStaticMeshActorWithHeatmapReadyActor(
+	const FHeatmapReadyActorConversion& Conversion, const TSubclassOf<AHeatmapReadyActor> HeatmapReadyActorClass)
+{
+	AStaticMeshActor* StaticMeshActor = Conversion.StaticMeshActor.Get();
 	
 	UWorld* World = GEditor->GetEditorWorldContext().World();
 	
-	if (!StaticMesh || !World) return;
+	if (!StaticMeshActor || !Conversion.StaticMesh || !World) return nullptr;
+
+	AHeatmapReadyActor* HeatmapReadyActor =
+		World->SpawnActor<AHeatmapReadyActor>(HeatmapReadyActorClass, Conversion.Transform.GetLocation(),
+			Conversion.Transform.Rotator());
 
-	const AHeatmapReadyActor* HeatmapReadyActor =
-		World->SpawnActor<AHeatmapReadyActor>(HeatmapReadyActorClass, StaticMeshActor->GetActorLocation(),
-			StaticMeshActor->GetActorRotation());
+	if (!HeatmapReadyActor) return nullptr;
 
 	UStaticMeshComponent* HeatmapReadyActorMeshComponent =
 		Cast<UStaticMeshComponent>(HeatmapReadyActor->GetComponentByClass(UStaticMeshComponent::StaticClass()));
 
-	if (!HeatmapReadyActorMeshComponent) return;
+	if (!HeatmapReadyActorMeshComponent) return nullptr;
 	
-	HeatmapReadyActorMeshComponent->SetStaticMesh(StaticMesh);
-	HeatmapReadyActorMeshComponent->SetWorldScale3D(StaticMeshActor->GetStaticMeshComponent()->GetComponentScale());
+	HeatmapReadyActorMeshComponent->SetStaticMesh(Conversion.StaticMesh);
+	HeatmapReadyActorMeshComponent->SetWorldScale3D(Conversion.Transform.GetScale3D());
 
-	const int32 MaterialsNum = Materials.Num();
+	const int32 MaterialsNum = Conversion.Materials.Num();
 	
-	for (size_t i = 0; i < MaterialsNum; ++i)
-		HeatmapReadyActorMeshComponent->SetMaterial(i, Materials[i]);
+	for (int32 i = 0; i < MaterialsNum; ++i)
+		HeatmapReadyActorMeshComponent->SetMaterial(i, Conversion.Materials[i]);
+
+	if (Conversion.bNeedsComplexCollision)
+	{
+		HeatmapReadyActorMeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		HeatmapReadyActorMeshComponent->SetCollisionResponseToAllChannels(ECR_Block);
+	}
+
+	HeatmapReadyActor->UpdateScaleDivisors();
+
+	World->EditorDestroyActor(StaticMeshActor, true);
 
-	StaticMeshActor->Destroy();
+	return HeatmapReadyActor;
 }
 
 void UEyeTrackingEditorWidget::ReplaceHeatmapReadyActorWithStaticMeshActor(AHeatmapReadyActor* HeatmapReadyActor)
@@ -158,12 +245,7 @@ void UEyeTrackingEditorWidget::NativeConstruct()
 
 void UEyeTrackingEditorWidget::PrepareAllStaticMeshActorsInLevel(const TSubclassOf<AHeatmapReadyActor> HeatmapReadyActorClass)
 {
-	TArray<AStaticMeshActor*> StaticMeshActors = GetAllStaticMeshActorsInLevel();
-
-	for (AStaticMeshActor* StaticMeshActor : StaticMeshActors)
-	{
-		ReplaceStaticMeshActorWithHeatmapReadyActor(StaticMeshActor, HeatmapReadyActorClass);
-	}
+	ConvertStaticMeshActors(GetAllStaticMeshActorsInLevel(), HeatmapReadyActorClass);
 }
 
 void UEyeTrackingEditorWidget::PrepareSelectedStaticMeshActors(const TSubclassOf<AHeatmapReadyActor> HeatmapReadyActorClass)
@@ -172,12 +254,15 @@ void UEyeTrackingEditorWidget::PrepareSelectedStaticMeshActors(const TSubclassOf
 		return;
 	
 	TArray<AActor*> SelectedLevelActors = EditorActorSubsystem->GetSelectedLevelActors();
+	TArray<AStaticMeshActor*> SelectedStaticMeshActors;
 
 	for (AActor* SelectedLevelActor : SelectedLevelActors)
 	{
-		AStaticMeshActor* StaticMeshActor = Cast<AStaticMeshActor>(SelectedLevelActor);
-		ReplaceStaticMeshActorWithHeatmapReadyActor(StaticMeshActor, HeatmapReadyActorClass);
+		if (AStaticMeshActor* StaticMeshActor = Cast<AStaticMeshActor>(SelectedLevelActor))
+			SelectedStaticMeshActors.Add(StaticMeshActor);
 	}
+
+	ConvertStaticMeshActors(SelectedStaticMeshActors, HeatmapReadyActorClass);
 }
 
 void UEyeTrackingEditorWidget::RevertSelectedHeatmapReadyActors()
@@ -244,6 +329,12 @@ void UEyeTrackingEditorWidget::RemoveBrokenUvChannelFromAllHeatmapReadyActors()
 	}
 }
 
+void UEyeTrackingEditorWidget::AssignHeatmapUvChannelsForAllHeatmapReadyActors()
+{
+	if (UHeatmapUvSubsystem* HeatmapUv = UHeatmapUvSubsystem::Get())
+		HeatmapUv->AssignHeatmapUvChannels(GetAllHeatmapReadyActorsInLevel());
+}
+
 void UEyeTrackingEditorWidget::LoadHeatmapRT(const FString& FileName, const float MetricsThreshold)
 {
 	if (!GEditor) return;
@@ -338,14 +429,13 @@ void UEyeTrackingEditorWidget::SetMaterialForStaticMeshActors(const UObject* Wor
 
 void UEyeTrackingEditorWidget::DisableCpuAccessForAllMeshes()
 {
-	if (!GetEditorActorSubsystem())
-		return;
-	
-	TArray<AActor*> AllLevelActors = EditorActorSubsystem->GetAllLevelActors();
+	TArray<AActor*> MeshActors;
+	MeshActors.Append(GetAllStaticMeshActorsInLevel());
+	MeshActors.Append(GetAllHeatmapReadyActorsInLevel());
 
-	for (const AActor* LevelActor : AllLevelActors)
+	for (const AActor* MeshActor : MeshActors)
 	{
-		const UStaticMeshComponent* StaticMeshComponent = LevelActor->GetComponentByClass<UStaticMeshComponent>();
+		const UStaticMeshComponent* StaticMeshComponent = MeshActor->GetComponentByClass<UStaticMeshComponent>();
 
 		if (!StaticMeshComponent) continue;
 
@@ -359,19 +449,10 @@ void UEyeTrackingEditorWidget::DisableCpuAccessForAllMeshes()
 
 void UEyeTrackingEditorWidget::RestoreMaterialsForHeatmapReadyActors()
 {
-	if (!GetEditorActorSubsystem())
-		return;
-	
-	TArray<AActor*> AllLevelActors = EditorActorSubsystem->GetAllLevelActors();
+	TArray<AHeatmapReadyActor*> HeatmapReadyActors = GetAllHeatmapReadyActorsInLevel();
 
-	for (AActor* LevelActor : AllLevelActors)
+	for (AHeatmapReadyActor* HeatmapReadyActor : HeatmapReadyActors)
 	{
-		if (!LevelActor) continue;
-
-		AHeatmapReadyActor* HeatmapReadyActor = Cast<AHeatmapReadyActor>(LevelActor);
-
-		if (!HeatmapReadyActor) continue;
-
 		UStaticMeshComponent* StaticMeshComponent =
 			Cast<UStaticMeshComponent>(HeatmapReadyActor->GetComponentByClass(UStaticMeshComponent::StaticClass()));
 
@@ -397,6 +478,7 @@ void UEyeTrackingEditorWidget::EnableComplexCollisionForSelectedStaticMeshActors
 		return;
 	
 	TArray<AActor*> SelectedLevelActors = EditorActorSubsystem->GetSelectedLevelActors();
+	TArray<UStaticMeshComponent*> StaticMeshComponents;
 
 	for (const AActor* SelectedLevelActor : SelectedLevelActors)
 	{
@@ -405,8 +487,10 @@ void UEyeTrackingEditorWidget::EnableComplexCollisionForSelectedStaticMeshActors
 
 		if (!SelectedActorMeshComponent) continue;
 
-		EnableComplexCollision(SelectedActorMeshComponent);
+		StaticMeshComponents.Add(SelectedActorMeshComponent);
 	}
+
+	EnableComplexCollision(StaticMeshComponents);
 }
 
 // TODO: Remove!
@@ -417,6 +501,7 @@ void UEyeTrackingEditorWidget::EnableComplexCollisionForAllStaticMeshActors()
 		return;
 
 	TArray<AStaticMeshActor*> StaticMeshActors = GetAllStaticMeshActorsInLevel();
+	TArray<UStaticMeshComponent*> StaticMeshComponents;
 
 	for (const AStaticMeshActor* StaticMeshActor : StaticMeshActors)
 	{
@@ -425,8 +510,10 @@ void UEyeTrackingEditorWidget::EnableComplexCollisionForAllStaticMeshActors()
 
 		if (!SelectedActorMeshComponent) continue;
 
-		EnableComplexCollision(SelectedActorMeshComponent);
+		StaticMeshComponents.Add(SelectedActorMeshComponent);
 	}
+
+	EnableComplexCollision(StaticMeshComponents);
 }
 
 void UEyeTrackingEditorWidget::UpdateScrollBoxHighlight_Implementation()
@@ -464,20 +551,35 @@ void UEyeTrackingEditorWidget::PrepareStaticMeshComponent(UStaticMeshComponent*
 	
 	if (!StaticMesh) return;
 
-	StaticMesh->bAllowCPUAccess = true;
-
 	const UBodySetup* BodySetup = StaticMesh->GetBodySetup();
 
 	if (!BodySetup) return;
 
 	const bool bHasSimpleCollision = BodySetup->AggGeom.GetElementCount() != 0;
 
-	if (!bHasSimpleCollision) EnableComplexCollision(StaticMeshComponent);
+	if (!bHasSimpleCollision) EnableComplexCollision({ StaticMeshComponent });
 }
 
-void UEyeTrackingEditorWidget::EnableComplexCollision(UStaticMeshComponent* StaticMeshComponent)
+void UEyeTrackingEditorWidget::EnableComplexCollision(const TArray<UStaticMeshComponent*>& StaticMeshComponents)
 {
-	StaticMeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-	StaticMeshComponent->SetCollisionResponseToAllChannels(ECR_Block);
-	StaticMeshComponent->GetBodySetup()->CollisionTraceFlag = CTF_UseComplexAsSimple;
+	TArray<UStaticMesh*> StaticMeshes;
+
+	for (const UStaticMeshComponent* StaticMeshComponent : StaticMeshComponents)
+	{
+		if (StaticMeshComponent && StaticMeshComponent->GetStaticMesh())
+			StaticMeshes.Add(StaticMeshComponent->GetStaticMesh());
+	}
+
+	// Cooks every unique mesh once instead of once per instance
+	if (UCollisionCookingSubsystem* CollisionCooking = UCollisionCookingSubsystem::Get())
+		CollisionCooking->PrepareComplexCollision(StaticMeshes);
+
+	for (UStaticMeshComponent* StaticMeshComponent : StaticMeshComponents)
+	{
+		if (!StaticMeshComponent) continue;
+
+		StaticMeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		StaticMeshComponent->SetCollisionResponseToAllChannels(ECR_Block);
+		StaticMeshComponent->RecreatePhysicsState();
+	}
 }
@@ -3,9 +3,9 @@
 #include "EyeTrackingUtilityEditor.h"
 
 #include "FileHelpers.h"
-#include "Subsystems/EditorActorSubsystem.h"
 #include "Engine/StaticMeshActor.h"
 
+#include "EditorActorCacheSubsystem.h"
 #include "EyeTrackingCharacter.h"
 #include "EyeTrackingEditorWidget.h"
 #include "HeatmapReadyActor.h"
@@ -16,7 +16,6 @@
 FOnStaticMeshAddedToScene FEyeTrackingUtilityEditorModule::OnStaticMeshAddedToScene;
 FOnWaypointAddedToScene FEyeTrackingUtilityEditorModule::OnWaypointAddedToScene;
 FOnExitVrPreview FEyeTrackingUtilityEditorModule::OnExitVrPreview;
-UEditorActorSubsystem* FEyeTrackingUtilityEditorModule::EditorActorSubsystem = nullptr;
 
 void FEyeTrackingUtilityEditorModule::StartupModule()
 {
@@ -32,14 +31,6 @@ void FEyeTrackingUtilityEditorModule::ShutdownModule()
 	FEditorDelegates::EndPIE.RemoveAll(this);
 }
 
-bool FEyeTrackingUtilityEditorModule::GetEditorActorSubsystem()
-{
-	if (!EditorActorSubsystem)
-		EditorActorSubsystem = GEditor->GetEditorSubsystem<UEditorActorSubsystem>();
-
-	return EditorActorSubsystem != nullptr;
-}
-
 // ReSharper disable once CppMemberFunctionMayBeStatic (used as callback)
 void FEyeTrackingUtilityEditorModule::OnNewActorsDropped(const TArray<UObject*>& DroppedObjects, 
                                                          const TArray<AActor*>& CreatedActors)
@@ -56,20 +47,12 @@ void FEyeTrackingUtilityEditorModule::OnNewActorsDropped(const TArray<UObject*>&
 
 		else if (AWaypoint* Waypoint = Cast<AWaypoint>(Actor))
 		{
-			if (!GetEditorActorSubsystem())
-				return;
-
-			TArray<AActor*> LevelActors = EditorActorSubsystem->GetAllLevelActors();
-			TArray<AWaypoint*> ExistingWaypoints;
-			
-			for (AActor* LevelActor : LevelActors)
-			{
-				AWaypoint* ExistingWaypoint = Cast<AWaypoint>(LevelActor);
+			UEditorActorCacheSubsystem* ActorCache = UEditorActorCacheSubsystem::Get();
 
-				if (!ExistingWaypoint) continue;
+			if (!ActorCache)
+				return;
 
-				ExistingWaypoints.Emplace(ExistingWaypoint);
-			}
+			TArray<AWaypoint*> ExistingWaypoints = ActorCache->GetWaypoints();
 
 			ExistingWaypoints.Sort([](const AWaypoint& A, const AWaypoint& B)
 			{
@@ -97,38 +80,8 @@ void FEyeTrackingUtilityEditorModule::LoadLastHeatmapAndResetList(bool bIsSimula
 // ReSharper disable once CppMemberFunctionMayBeStatic (used as callback)
 void FEyeTrackingUtilityEditorModule::RestoreMaterialsForHeatmapReadyActors()
 {
+	// The widget restores from the cached set of heatmap-ready actors and saves the level
 	UEyeTrackingEditorWidget::RestoreMaterialsForHeatmapReadyActors();
-	
-	if (!GetEditorActorSubsystem())
-		return;
-
-	TArray<AActor*> AllLevelActors = EditorActorSubsystem->GetAllLevelActors();
-
-	for (AActor* LevelActor : AllLevelActors)
-	{
-		if (!LevelActor) continue;
-
-		AHeatmapReadyActor* HeatmapReadyActor = Cast<AHeatmapReadyActor>(LevelActor);
-
-		if (!HeatmapReadyActor) continue;
-
-		UStaticMeshComponent* StaticMeshComponent =
-			Cast<UStaticMeshComponent>(HeatmapReadyActor->GetComponentByClass(UStaticMeshComponent::StaticClass()));
-
-		if (!StaticMeshComponent) continue;
-
-		const int32 NumMaterials = StaticMeshComponent->GetNumMaterials();
-		const TArray<UMaterialInterface*> Materials = HeatmapReadyActor->GetMaterials();
-
-		for (uint8 i = 0; i < NumMaterials; ++i)
-		{
-			if (Materials.Num() < i + 1 || !Materials[i]) continue;
-
-			StaticMeshComponent->SetMaterial(i, Materials[i]);
-		}
-	}
-
-	FEditorFileUtils::SaveCurrentLevel();
 }
 
 // ReSharper disable once CppMemberFunctionMayBeStatic (used as callback)
@@ -0,0 +1,458 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "HeatmapUvSubsystem.h"
+
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpressionMaterialFunctionCall.h"
+#include "Materials/MaterialExpressionTextureCoordinate.h"
+#include "Materials/MaterialExpressionTextureSampleParameter2D.h"
+#include "Materials/MaterialFunctionInterface.h"
+#include "StaticMeshResources.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopedSlowTask.h"
+#include "MeshDescription.h"
+#include "OverlappingCorners.h"
+#include "StaticMeshAttributes.h"
+#include "StaticMeshOperations.h"
+#include <atomic>
+
+#include "CollisionCookingSubsystem.h"
+#include "HeatmapReadyActor.h"
+#include "HeatmapUvLookupCache.h"
+#include "JsonParser.h"
+#include "DebugHeader.h"
+
+namespace
+{
+	constexpr int32 BandHeight = 16;
+
+	// Edge function of P against the edge A -> B, positive on its left
+	float EdgeFunction(const FVector2f& A, const FVector2f& B, const FVector2f& P)
+	{
+		return (B.X - A.X) * (P.Y - A.Y) - (B.Y - A.Y) * (P.X - A.X);
+	}
+
+	// Texel centers exactly on a shared edge belong to only one of the two triangles
+	bool IsTopLeftEdge(const FVector2f& A, const FVector2f& B)
+	{
+		return (A.Y == B.Y && B.X < A.X) || B.Y < A.Y;
+	}
+
+	bool IsCovered(const float W, const bool bTopLeft)
+	{
+		return W > 0.f || (W == 0.f && bTopLeft);
+	}
+}
+
+void UHeatmapUvSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	bool bOutSuccess;
+	HeatmapUvChannels = UJsonParser::ReadStringMapFromJsonFile(CacheFilePath(), bOutSuccess);
+}
+
+UHeatmapUvSubsystem* UHeatmapUvSubsystem::Get()
+{
+	return GEditor ? GEditor->GetEditorSubsystem<UHeatmapUvSubsystem>() : nullptr;
+}
+
+void UHeatmapUvSubsystem::AssignHeatmapUvChannels(const TArray<AHeatmapReadyActor*>& HeatmapReadyActors)
+{
+	TMap<UStaticMesh*, TArray<AHeatmapReadyActor*>> ActorsByMesh;
+
+	for (AHeatmapReadyActor* HeatmapReadyActor : HeatmapReadyActors)
+	{
+		if (!HeatmapReadyActor) continue;
+
+		const UStaticMeshComponent* StaticMeshComponent = HeatmapReadyActor->GetComponentByClass<UStaticMeshComponent>();
+
+		if (!StaticMeshComponent || !StaticMeshComponent->GetStaticMesh()) continue;
+
+		ActorsByMesh.FindOrAdd(StaticMeshComponent->GetStaticMesh()).Add(HeatmapReadyActor);
+	}
+
+	if (ActorsByMesh.IsEmpty()) return;
+
+	FScopedSlowTask SlowTask(ActorsByMesh.Num(),
+		FText::FromString("Analysing UVs of " + FString::FromInt(ActorsByMesh.Num()) + " meshes"));
+	SlowTask.MakeDialog();
+
+	AHeatmapUvLookupCache* UvLookupCache = FindOrSpawnUvLookupCache(GEditor->GetEditorWorldContext().World());
+
+	int32 UnresolvedMeshesNum = 0;
+
+	for (TPair<UStaticMesh*, TArray<AHeatmapReadyActor*>>& MeshActors : ActorsByMesh)
+	{
+		SlowTask.EnterProgressFrame(1, FText::FromString(MeshActors.Key->GetName()));
+
+		// Painting into a channel the display material doesn't sample shows up in the wrong place
+		int32 DisplayedUvChannel = INDEX_NONE;
+		bool bDisplayedUvChannelsMatch = true;
+
+		for (AHeatmapReadyActor* HeatmapReadyActor : MeshActors.Value)
+		{
+			const int32 ActorUvChannel = FindDisplayedUvChannel(HeatmapReadyActor);
+
+			if (ActorUvChannel == INDEX_NONE) continue;
+
+			bDisplayedUvChannelsMatch &= DisplayedUvChannel == INDEX_NONE || DisplayedUvChannel == ActorUvChannel;
+			DisplayedUvChannel = ActorUvChannel;
+		}
+
+		const int32 UvChannel = bDisplayedUvChannelsMatch ?
+			ResolveHeatmapUvChannel(MeshActors.Key, DisplayedUvChannel) : INDEX_NONE;
+
+		if (UvChannel == INDEX_NONE)
+			++UnresolvedMeshesNum;
+
+		else if (UvLookupCache)
+		{
+			const FString MeshHash = UCollisionCookingSubsystem::ComputeMeshHash(MeshActors.Key);
+			const FHeatmapUvTriangleTable* ExistingTable = UvLookupCache->FindTable(MeshActors.Key);
+
+			FHeatmapUvTriangleTable Table;
+
+			if ((!ExistingTable || ExistingTable->UvChannel != UvChannel || ExistingTable->SourceHash != MeshHash) &&
+				BuildUvTriangleTable(MeshActors.Key, UvChannel, Table))
+			{
+				Table.SourceHash = MeshHash;
+				UvLookupCache->SetTable(MeshActors.Key, MoveTemp(Table));
+			}
+		}
+
+		for (AHeatmapReadyActor* HeatmapReadyActor : MeshActors.Value)
+		{
+			// The lookup table may have been rebuilt, box AOIs are resolved through it
+			HeatmapReadyActor->InvalidateAoiIndex();
+
+			if (HeatmapReadyActor->HeatmapUvChannel == UvChannel) continue;
+
+			HeatmapReadyActor->Modify();
+			HeatmapReadyActor->HeatmapUvChannel = UvChannel;
+		}
+	}
+
+	SaveCache();
+
+	DebugHeader::ShowNotifyInfoIf(UnresolvedMeshesNum > 0, "No usable heatmap UV channel for " +
+		FString::FromInt(UnresolvedMeshesNum) + " meshes");
+}
+
+int32 UHeatmapUvSubsystem::ResolveHeatmapUvChannel(UStaticMesh* StaticMesh, const int32 DisplayedUvChannel)
+{
+	if (!StaticMesh) return INDEX_NONE;
+
+	const FString MeshPath = StaticMesh->GetPathName();
+
+	if (const FString* CachedEntry = HeatmapUvChannels.Find(MeshPath))
+	{
+		FString CachedHash, CachedChannel;
+
+		if (CachedEntry->Split(":", &CachedHash, &CachedChannel) &&
+			CachedHash == UCollisionCookingSubsystem::ComputeMeshHash(StaticMesh) &&
+			(DisplayedUvChannel == INDEX_NONE || FCString::Atoi(*CachedChannel) == DisplayedUvChannel))
+			return FCString::Atoi(*CachedChannel);
+	}
+
+	// A generated channel would never be displayed, so the fixed one either works or the mesh stays unresolved
+	if (DisplayedUvChannel != INDEX_NONE)
+	{
+		const FMeshDescription* MeshDescription = StaticMesh->GetMeshDescription(0);
+
+		if (!MeshDescription || !IsUsableHeatmapUvChannel(*MeshDescription, DisplayedUvChannel)) return INDEX_NONE;
+
+		HeatmapUvChannels.Add(MeshPath,
+			UCollisionCookingSubsystem::ComputeMeshHash(StaticMesh) + ":" + FString::FromInt(DisplayedUvChannel));
+
+		return DisplayedUvChannel;
+	}
+
+	int32 UvChannel = INDEX_NONE;
+
+	if (const FMeshDescription* MeshDescription = StaticMesh->GetMeshDescription(0))
+	{
+		const int32 UvChannelsNum = StaticMesh->GetNumUVChannels(0);
+
+		for (int32 i = 0; i < UvChannelsNum; ++i)
+		{
+			if (!IsUsableHeatmapUvChannel(*MeshDescription, i)) continue;
+
+			UvChannel = i;
+			break;
+		}
+	}
+
+	if (UvChannel == INDEX_NONE)
+		UvChannel = GenerateHeatmapUvChannel(StaticMesh);
+
+	// Generating a channel rebuilds the mesh, so the hash is taken afterwards
+	HeatmapUvChannels.Add(MeshPath,
+		UCollisionCookingSubsystem::ComputeMeshHash(StaticMesh) + ":" + FString::FromInt(UvChannel));
+
+	return UvChannel;
+}
+
+void UHeatmapUvSubsystem::ClearCache()
+{
+	HeatmapUvChannels.Empty();
+	SaveCache();
+}
+
+int32 UHeatmapUvSubsystem::FindDisplayedUvChannel(AHeatmapReadyActor* HeatmapReadyActor)
+{
+	for (UMaterialInterface* MaterialInterface : HeatmapReadyActor->GetMaterials())
+	{
+		const UMaterial* Material = MaterialInterface ? MaterialInterface->GetMaterial() : nullptr;
+
+		if (!Material) continue;
+
+		// The shipped overlay samples HeatmapAlpha inside a material function
+		TArray<UMaterialExpressionTextureSampleParameter2D*> TextureSamples;
+		Material->GetAllExpressionsInMaterialAndFunctionsOfType(TextureSamples);
+
+		for (const UMaterialExpressionTextureSampleParameter2D* HeatmapSample : TextureSamples)
+		{
+			if (!HeatmapSample || HeatmapSample->ParameterName != FName("HeatmapAlpha")) continue;
+
+			if (!HeatmapSample->Coordinates.Expression)
+				return HeatmapSample->ConstCoordinate;
+
+			if (const UMaterialExpressionTextureCoordinate* TexCoord =
+				Cast<UMaterialExpressionTextureCoordinate>(HeatmapSample->Coordinates.Expression))
+				return TexCoord->CoordinateIndex;
+
+			// Anything else, e.g. a switch on HeatmapUvChannel, follows the channel it is given
+			return INDEX_NONE;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+bool UHeatmapUvSubsystem::IsUsableHeatmapUvChannel(const FMeshDescription& MeshDescription, const int32 UvChannel)
+{
+	const FStaticMeshConstAttributes Attributes(MeshDescription);
+	const TVertexInstanceAttributesConstRef<FVector2f> VertexInstanceUvs = Attributes.GetVertexInstanceUVs();
+
+	if (UvChannel >= VertexInstanceUvs.GetNumChannels()) return false;
+
+	TArray<FVector2f> TriangleUvs;
+	TriangleUvs.Reserve(MeshDescription.Triangles().Num() * 3);
+
+	for (const FTriangleID TriangleID : MeshDescription.Triangles().GetElementIDs())
+	{
+		for (const FVertexInstanceID VertexInstanceID : MeshDescription.GetTriangleVertexInstances(TriangleID))
+		{
+			const FVector2f Uv = VertexInstanceUvs.Get(VertexInstanceID, UvChannel);
+
+			// Tiling UVs wrap around the render target
+			if (Uv.X < -KINDA_SMALL_NUMBER || Uv.X > 1.f + KINDA_SMALL_NUMBER ||
+				Uv.Y < -KINDA_SMALL_NUMBER || Uv.Y > 1.f + KINDA_SMALL_NUMBER)
+				return false;
+
+			TriangleUvs.Add(Uv);
+		}
+	}
+
+	return !TriangleUvs.IsEmpty() && !HasUvOverlaps(TriangleUvs);
+}
+
+bool UHeatmapUvSubsystem::HasUvOverlaps(const TArray<FVector2f>& TriangleUvs)
+{
+	constexpr int32 Resolution = OverlapTestResolution;
+	constexpr int32 BandsNum = Resolution / BandHeight;
+
+	const int32 TrianglesNum = TriangleUvs.Num() / 3;
+
+	// Bin triangles into horizontal bands, so every band can be rasterized on its own worker
+	TArray<TArray<int32>> BandTriangles;
+	BandTriangles.SetNum(BandsNum);
+
+	for (int32 t = 0; t < TrianglesNum; ++t)
+	{
+		const float MinY = FMath::Min3(TriangleUvs[t * 3].Y, TriangleUvs[t * 3 + 1].Y, TriangleUvs[t * 3 + 2].Y);
+		const float MaxY = FMath::Max3(TriangleUvs[t * 3].Y, TriangleUvs[t * 3 + 1].Y, TriangleUvs[t * 3 + 2].Y);
+
+		const int32 FirstBand = FMath::Clamp(FMath::FloorToInt32(MinY * Resolution) / BandHeight, 0, BandsNum - 1);
+		const int32 LastBand = FMath::Clamp(FMath::FloorToInt32(MaxY * Resolution) / BandHeight, 0, BandsNum - 1);
+
+		for (int32 Band = FirstBand; Band <= LastBand; ++Band)
+			BandTriangles[Band].Add(t);
+	}
+
+	std::atomic<int32> CoveredTexelsNum = 0;
+	std::atomic<int32> OverlappingTexelsNum = 0;
+
+	ParallelFor(BandsNum, [&](const int32 Band)
+	{
+		TArray<uint8> Coverage;
+		Coverage.SetNumZeroed(BandHeight * Resolution);
+
+		const int32 BandMinY = Band * BandHeight;
+		const int32 BandMaxY = BandMinY + BandHeight - 1;
+
+		int32 BandCoveredTexelsNum = 0;
+		int32 BandOverlappingTexelsNum = 0;
+
+		for (const int32 t : BandTriangles[Band])
+		{
+			FVector2f A = TriangleUvs[t * 3] * Resolution;
+			FVector2f B = TriangleUvs[t * 3 + 1] * Resolution;
+			const FVector2f C = TriangleUvs[t * 3 + 2] * Resolution;
+
+			const float Area = EdgeFunction(A, B, C);
+
+			if (FMath::IsNearlyZero(Area)) continue;
+
+			// Mirrored UV islands are fine, only their winding differs
+			if (Area < 0.f) Swap(A, B);
+
+			const bool bTopLeftBC = IsTopLeftEdge(B, C);
+			const bool bTopLeftCA = IsTopLeftEdge(C, A);
+			const bool bTopLeftAB = IsTopLeftEdge(A, B);
+
+			const int32 MinX = FMath::Max(FMath::FloorToInt32(FMath::Min3(A.X, B.X, C.X)), 0);
+			const int32 MaxX = FMath::Min(FMath::CeilToInt32(FMath::Max3(A.X, B.X, C.X)), Resolution - 1);
+			const int32 MinY = FMath::Max(FMath::FloorToInt32(FMath::Min3(A.Y, B.Y, C.Y)), BandMinY);
+			const int32 MaxY = FMath::Min(FMath::CeilToInt32(FMath::Max3(A.Y, B.Y, C.Y)), BandMaxY);
+
+			for (int32 y = MinY; y <= MaxY; ++y)
+			{
+				for (int32 x = MinX; x <= MaxX; ++x)
+				{
+					const FVector2f TexelCenter(x + 0.5f, y + 0.5f);
+
+					if (!IsCovered(EdgeFunction(B, C, TexelCenter), bTopLeftBC) ||
+						!IsCovered(EdgeFunction(C, A, TexelCenter), bTopLeftCA) ||
+						!IsCovered(EdgeFunction(A, B, TexelCenter), bTopLeftAB))
+						continue;
+
+					uint8& TexelCoverage = Coverage[(y - BandMinY) * Resolution + x];
+
+					if (TexelCoverage == 0) ++BandCoveredTexelsNum;
+					else if (TexelCoverage == 1) ++BandOverlappingTexelsNum;
+
+					TexelCoverage = static_cast<uint8>(FMath::Min(TexelCoverage + 1, 2));
+				}
+			}
+		}
+
+		CoveredTexelsNum += BandCoveredTexelsNum;
+		OverlappingTexelsNum += BandOverlappingTexelsNum;
+	});
+
+	return OverlappingTexelsNum > CoveredTexelsNum * OverlapTolerance;
+}
+
+int32 UHeatmapUvSubsystem::GenerateHeatmapUvChannel(UStaticMesh* StaticMesh)
+{
+	const int32 NewUvChannel = StaticMesh->GetNumUVChannels(0);
+
+	if (NewUvChannel >= MAX_MESH_TEXTURE_COORDS_MD) return INDEX_NONE;
+
+	FMeshDescription* MeshDescription = StaticMesh->GetMeshDescription(0);
+
+	// UStaticMesh::AddUVChannel would commit and rebuild the still empty channel, the layout is
+	// written into the description first and the mesh rebuilt once below
+	if (!MeshDescription || !FStaticMeshOperations::AddUVChannel(*MeshDescription)) return INDEX_NONE;
+
+	FOverlappingCorners OverlappingCorners;
+	FStaticMeshOperations::FindOverlappingCorners(OverlappingCorners, *MeshDescription, THRESH_POINTS_ARE_SAME);
+
+	// The lightmap layout packs the source charts without overlaps and scales them by their surface area,
+	// which gives the uniform texel density the paint brush assumes
+	if (!FStaticMeshOperations::CreateLightMapUVLayout(*MeshDescription, 0, NewUvChannel, GeneratedUvResolution,
+		ELightmapUVVersion::Latest, OverlappingCorners))
+	{
+		FStaticMeshOperations::RemoveUVChannel(*MeshDescription, NewUvChannel);
+		return INDEX_NONE;
+	}
+
+	StaticMesh->Modify();
+	StaticMesh->CommitMeshDescription(0);
+	StaticMesh->PostEditChange();
+
+	return NewUvChannel;
+}
+
+bool UHeatmapUvSubsystem::BuildUvTriangleTable(UStaticMesh* StaticMesh, const int32 UvChannel,
+	FHeatmapUvTriangleTable& OutTable)
+{
+	// Hits report faces of the complex collision mesh, which may be a different asset
+	const UStaticMesh* CollisionMesh = StaticMesh->ComplexCollisionMesh ? StaticMesh->ComplexCollisionMesh.Get() : StaticMesh;
+	const FStaticMeshRenderData* RenderData = CollisionMesh->GetRenderData();
+
+	if (!RenderData || RenderData->LODResources.IsEmpty()) return false;
+
+	const int32 CollisionLod = FMath::Clamp(CollisionMesh->LODForCollision, 0, RenderData->LODResources.Num() - 1);
+	const FStaticMeshLODResources& LodResources = RenderData->LODResources[CollisionLod];
+
+	const FPositionVertexBuffer& PositionBuffer = LodResources.VertexBuffers.PositionVertexBuffer;
+	const FStaticMeshVertexBuffer& VertexBuffer = LodResources.VertexBuffers.StaticMeshVertexBuffer;
+	const FIndexArrayView RenderIndices = LodResources.IndexBuffer.GetArrayView();
+
+	if (UvChannel >= static_cast<int32>(VertexBuffer.GetNumTexCoords())) return false;
+
+	OutTable.UvChannel = UvChannel;
+	OutTable.Positions.Reset();
+	OutTable.Uvs.Reset();
+	OutTable.Indices.Reset(RenderIndices.Num());
+
+	// Same traversal the collision cook does: sections in order, collision-disabled ones skipped and vertices
+	// deduplicated in order of first use, so face indices and vertex indices line up with the cooked mesh
+	TMap<uint32, uint32> RenderToTableVertex;
+
+	for (const FStaticMeshSection& Section : LodResources.Sections)
+	{
+		if (!Section.bEnableCollision) continue;
+
+		const uint32 LastIndex = Section.FirstIndex + Section.NumTriangles * 3;
+
+		for (uint32 i = Section.FirstIndex; i < LastIndex; ++i)
+		{
+			const uint32 RenderVertex = RenderIndices[i];
+
+			if (const uint32* TableVertex = RenderToTableVertex.Find(RenderVertex))
+			{
+				OutTable.Indices.Add(*TableVertex);
+				continue;
+			}
+
+			const uint32 TableVertex = OutTable.Positions.Add(PositionBuffer.VertexPosition(RenderVertex));
+			OutTable.Uvs.Add(VertexBuffer.GetVertexUV(RenderVertex, UvChannel));
+
+			RenderToTableVertex.Add(RenderVertex, TableVertex);
+			OutTable.Indices.Add(TableVertex);
+		}
+	}
+
+	return !OutTable.Indices.IsEmpty();
+}
+
+AHeatmapUvLookupCache* UHeatmapUvSubsystem::FindOrSpawnUvLookupCache(UWorld* World)
+{
+	if (!World) return nullptr;
+
+	for (TActorIterator<AHeatmapUvLookupCache> It(World); It; ++It)
+		return *It;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Name = "HeatmapUvLookupCache";
+	SpawnParameters.NameMode = FActorSpawnParameters::ESpawnActorNameMode::Requested;
+
+	return World->SpawnActor<AHeatmapUvLookupCache>(SpawnParameters);
+}
+
+FString UHeatmapUvSubsystem::CacheFilePath()
+{
+	return UJsonParser::CacheFolderPath() + "HeatmapUvCache.json";
+}
+
+void UHeatmapUvSubsystem::SaveCache()
+{
+	bool bOutSuccess;
+	UJsonParser::WriteStringMapToJsonFile(HeatmapUvChannels, CacheFilePath(), bOutSuccess);
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "HeatmapRT.h"
+
+#include "BakeHeatmapsCommandlet.generated.h"
+
+class FHeatmapAccumulator;
+
+/*
+* Bakes metrics and heatmap images for recorded sessions without a display, e.g.
+*
+* UnrealEditor-Cmd <Project>.uproject -run=BakeHeatmaps -Map=/Game/Maps/Gallery -Sessions=<dir or a.json,b.json>
+*     [-Output=<dir>] [-Resolution=512] [-BrushRadius=0.025] [-Threshold=0] [-Composite [-NoParticipantNormalization]]
+*     [-Hotspots=5] [-Reproject] -nullrhi -unattended
+*
+* Heatmaps are accumulated on the CPU, one worker per actor. -Composite also bakes all sessions into one heatmap
+* per actor (Output/Composite), each participant weighted equally unless -NoParticipantNormalization is given.
+* The top hotspots of each session, in UV and, with recorded gaze points, in world space, go to Hotspots.json
+* and are collected in Output/Hotspots.csv. -Reproject traces each session's recorded gaze rays against the map as
+* it is now instead of using the recorded UVs, and writes the regenerated session to Output/<Session>/Session.json.
+* Sessions recorded along a waypoint route also get their metrics per leg, collected in Output/SegmentMetrics.csv.
+*/
+UCLASS()
+class EYETRACKINGUTILITYEDITOR_API UBakeHeatmapsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UBakeHeatmapsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	static UWorld* LoadWorld(const FString& MapPath, const bool bTraceCollision);
+	static void UnloadWorld(UWorld* World);
+
+	static TArray<FString> FindSessionFiles(const FString& SessionsParam);
+
+	static bool BakeSession(UWorld* World, const FString& SessionFilePath, const FString& OutputDirectory,
+		const bool bReproject, const float MetricsThreshold, FHeatmapAccumulator& Accumulator, TArray<FAttentionTrackingDataPoint>& OutAttentionTrackingData,
+		const FHeatmapHotspotSettings& HotspotSettings, TMap<FString, FAttentionMetricsEntry>& OutMetrics,
+		TArray<FHeatmapSegmentMetrics>& OutSegmentMetrics, TArray<FHeatmapHotspot>& OutHotspots);
+
+	static void WriteHeatmapImages(UWorld* World, const FHeatmapAccumulator& Accumulator, const FString& OutputDirectory);
+
+	static void WriteMetricsTable(const TMap<FString, TMap<FString, FAttentionMetricsEntry>>& MetricsBySession,
+		const FString& FilePath);
+
+	static void WriteSegmentMetricsTable(const TMap<FString, TArray<FHeatmapSegmentMetrics>>& SegmentMetricsBySession,
+		const FString& FilePath);
+
+	static void WriteHotspotsTable(const TMap<FString, TArray<FHeatmapHotspot>>& HotspotsBySession,
+		const FString& FilePath);
+
+	// Quoted if it contains a separator, a quote or a line break, with quotes doubled
+	static FString CsvField(const FString& Field);
+};
@@ -0,0 +1,39 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorSubsystem.h"
+#include "CollisionCookingSubsystem.generated.h"
+
+/*
+* Switches meshes to complex-as-simple collision and cooks each unique mesh once, on the worker threads.
+* Meshes already cooked this way are remembered by a hash of their geometry, so re-preparing a level is nearly free.
+*/
+UCLASS()
+class EYETRACKINGUTILITYEDITOR_API UCollisionCookingSubsystem : public UEditorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	static UCollisionCookingSubsystem* Get();
+
+	// Blocks until every mesh has been cooked; instances sharing a mesh may be passed in repeatedly
+	void PrepareComplexCollision(const TArray<UStaticMesh*>& StaticMeshes);
+
+	UFUNCTION(BlueprintCallable, Category = "Collision Setup")
+	void ClearCache();
+
+	// Changes whenever the mesh's geometry, build settings or collision trace flag do
+	static FString ComputeMeshHash(const UStaticMesh* StaticMesh);
+
+private:
+	static FString CacheFilePath();
+
+	void SaveCache();
+
+	// Mesh path -> hash of the geometry it was cooked with
+	TMap<FString, FString> CookedMeshHashes;
+};
@@ -0,0 +1,69 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorSubsystem.h"
+#include "EditorActorCacheSubsystem.generated.h"
+
+class AStaticMeshActor;
+class AHeatmapReadyActor;
+class AWaypoint;
+
+/*
+* Typed sets of the editor level's actors, kept up to date from the level actor added/deleted delegates,
+* so the widget's bulk operations don't have to scan and cast every actor in the level.
+*/
+UCLASS()
+class EYETRACKINGUTILITYEDITOR_API UEditorActorCacheSubsystem : public UEditorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UEditorActorCacheSubsystem* Get();
+
+	UFUNCTION(BlueprintCallable, Category = "Editor Actor Cache")
+	TArray<AStaticMeshActor*> GetStaticMeshActors();
+
+	UFUNCTION(BlueprintCallable, Category = "Editor Actor Cache")
+	TArray<AHeatmapReadyActor*> GetHeatmapReadyActors();
+
+	UFUNCTION(BlueprintCallable, Category = "Editor Actor Cache")
+	TArray<AWaypoint*> GetWaypoints();
+
+	UFUNCTION(BlueprintCallable, Category = "Editor Actor Cache")
+	void MarkDirty() { bDirty = true; }
+
+private:
+	void OnLevelActorAdded(AActor* Actor);
+	void OnLevelActorDeleted(AActor* Actor);
+	void OnMapChange(uint32 MapChangeFlags);
+	void OnLevelsChanged(ULevel* Level, UWorld* World);
+
+	static bool IsEditorWorldActor(const AActor* Actor);
+
+	void AddActor(AActor* Actor);
+	void RemoveActor(AActor* Actor);
+
+	void Rebuild();
+	void RebuildIfDirty();
+
+	template<typename ActorType>
+	static TArray<ActorType*> ToArray(TSet<TWeakObjectPtr<ActorType>>& Actors);
+
+	TSet<TWeakObjectPtr<AStaticMeshActor>> StaticMeshActors;
+	TSet<TWeakObjectPtr<AHeatmapReadyActor>> HeatmapReadyActors;
+	TSet<TWeakObjectPtr<AWaypoint>> Waypoints;
+
+	bool bDirty = true;
+
+	FDelegateHandle LevelActorAddedHandle;
+	FDelegateHandle LevelActorDeletedHandle;
+	FDelegateHandle MapChangeHandle;
+	FDelegateHandle PostUndoRedoHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
@@ -10,6 +10,16 @@
 
 class AHeatmapReadyActor;
 
+// Everything needed to replace one StaticMeshActor, gathered before anything is spawned
+struct FHeatmapReadyActorConversion
+{
+	TWeakObjectPtr<AStaticMeshActor> StaticMeshActor;
+	UStaticMesh* StaticMesh = nullptr;
+	TArray<UMaterialInterface*> Materials;
+	FTransform Transform;
+	bool bNeedsComplexCollision = false;
+};
+
 UCLASS()
 class EYETRACKINGUTILITYEDITOR_API UEyeTrackingEditorWidget : public UEditorUtilityWidget
 {
@@ -43,6 +53,10 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Render Targets Painting Interface")
 	static void RemoveBrokenUvChannelFromAllHeatmapReadyActors();
 
+	// Picks a non-overlapping UV channel per mesh, generating one where none exists
+	UFUNCTION(BlueprintCallable, Category = "Render Targets Painting Interface")
+	static void AssignHeatmapUvChannelsForAllHeatmapReadyActors();
+
 	UFUNCTION(BlueprintCallable, Category = "Render Targets Painting Interface")
 	static void LoadHeatmapRT(const FString& FileName, const float MetricsThreshold = 0.f);
 	
@@ -114,11 +128,17 @@ private:
 	static TArray<AStaticMeshActor*> GetAllStaticMeshActorsInLevel();
 	static TArray<AHeatmapReadyActor*> GetAllHeatmapReadyActorsInLevel();
 
-	static void ReplaceStaticMeshActorWithHeatmapReadyActor(AStaticMeshActor* StaticMeshActor, 
+	static void ConvertStaticMeshActors(const TArray<AStaticMeshActor*>& StaticMeshActors,
+		TSubclassOf<AHeatmapReadyActor> HeatmapReadyActorClass);
+
+	static bool GatherConversion(AStaticMeshActor* StaticMeshActor, FHeatmapReadyActorConversion& OutConversion);
+	static void PrepareStaticMeshes(TArray<FHeatmapReadyActorConversion>& Conversions);
+
+	static AHeatmapReadyActor* ReplaceStaticMeshActorWithHeatmapReadyActor(const FHeatmapReadyActorConversion& Conversion, 
 		TSubclassOf<AHeatmapReadyActor> HeatmapReadyActorClass);
 
 	static void ReplaceHeatmapReadyActorWithStaticMeshActor(AHeatmapReadyActor* HeatmapReadyActor);
 
 	static void PrepareStaticMeshComponent(UStaticMeshComponent* StaticMeshComponent);
-	static void EnableComplexCollision(UStaticMeshComponent* StaticMeshComponent);
+	static void EnableComplexCollision(const TArray<UStaticMeshComponent*>& StaticMeshComponents);
 };
@@ -22,10 +22,6 @@ public:
 	static FOnExitVrPreview OnExitVrPreview;
 
 private:
-	static class UEditorActorSubsystem* EditorActorSubsystem;
-
-	static bool GetEditorActorSubsystem();
-	
 	void OnNewActorsDropped(const TArray<UObject*>& DroppedObjects, const TArray<AActor*>& CreatedActors);
 	void LoadLastHeatmapAndResetList(bool bIsSimulating);
 	void RestoreMaterialsForHeatmapReadyActors();
@@ -0,0 +1,67 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorSubsystem.h"
+#include "HeatmapUvSubsystem.generated.h"
+
+class AHeatmapReadyActor;
+class AHeatmapUvLookupCache;
+struct FMeshDescription;
+struct FHeatmapUvTriangleTable;
+
+/*
+* Heatmaps are only correct on UV channels without overlaps inside the 0-1 range.
+* Finds such a channel per mesh, or generates a dedicated one, and remembers the result per mesh asset.
+* Display materials that sample HeatmapAlpha with a fixed TexCoord restrict the choice to that channel.
+*/
+UCLASS()
+class EYETRACKINGUTILITYEDITOR_API UHeatmapUvSubsystem : public UEditorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	static UHeatmapUvSubsystem* Get();
+
+	// Analyses every unique mesh once, stores the resulting channel on the actors
+	// and the mesh's UV lookup table in the level
+	void AssignHeatmapUvChannels(const TArray<AHeatmapReadyActor*>& HeatmapReadyActors);
+
+	// With a DisplayedUvChannel only that channel is accepted, nothing is generated
+	int32 ResolveHeatmapUvChannel(UStaticMesh* StaticMesh, const int32 DisplayedUvChannel = INDEX_NONE);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap UV")
+	void ClearCache();
+
+	// Resolution of the grid UV triangles are rasterized into for the overlap test
+	static constexpr int32 OverlapTestResolution = 512;
+
+	// Share of covered texels that may be covered twice before a channel counts as overlapping
+	static constexpr float OverlapTolerance = 0.001f;
+
+	// Resolution the generated charts are laid out for, matches the heatmap render targets
+	static constexpr int32 GeneratedUvResolution = 1024;
+
+private:
+	// Coordinate index the display materials sample HeatmapAlpha with, INDEX_NONE if they select it
+	// through the HeatmapUvChannel parameter or in a way that can't be told from the graph.
+	// Only materials of the latter kind can display a generated channel
+	static int32 FindDisplayedUvChannel(AHeatmapReadyActor* HeatmapReadyActor);
+
+	static bool IsUsableHeatmapUvChannel(const FMeshDescription& MeshDescription, const int32 UvChannel);
+	static bool HasUvOverlaps(const TArray<FVector2f>& TriangleUvs);
+	static int32 GenerateHeatmapUvChannel(UStaticMesh* StaticMesh);
+
+	static bool BuildUvTriangleTable(UStaticMesh* StaticMesh, const int32 UvChannel, FHeatmapUvTriangleTable& OutTable);
+	static AHeatmapUvLookupCache* FindOrSpawnUvLookupCache(UWorld* World);
+
+	static FString CacheFilePath();
+
+	void SaveCache();
+
+	// Mesh path -> "<mesh hash>:<channel>"
+	TMap<FString, FString> HeatmapUvChannels;
+};
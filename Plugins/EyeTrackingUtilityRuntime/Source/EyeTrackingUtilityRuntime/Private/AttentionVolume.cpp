@@ -0,0 +1,235 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "AttentionVolume.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+FAttentionVolume::FAttentionVolume(const float InVoxelSize)
+	: VoxelSize(FMath::Max(InVoxelSize, 1.f))
+{
+}
+
+void FAttentionVolume::AddHit(const FVector& Location, const float DwellTime, const FGuid& ActorGuid)
+{
+	const FIntVector Voxel = GetVoxelCoordinates(Location);
+
+	FAttentionVoxel& VoxelData = Voxels.FindOrAdd(Voxel);
+	VoxelData.DwellTime += DwellTime;
+	++VoxelData.SampleCount;
+
+	if (ActorGuid.IsValid())
+		VoxelsByActor.FindOrAdd(ActorGuid).Add(Voxel);
+}
+
+void FAttentionVolume::Reset(const float InVoxelSize)
+{
+	VoxelSize = FMath::Max(InVoxelSize, 1.f);
+
+	Voxels.Empty();
+	VoxelsByActor.Empty();
+}
+
+FAttentionVolumeQueryResult FAttentionVolume::QueryBox(const FBox& Box, TArray<FIntVector>* OutVoxels) const
+{
+	FAttentionVolumeQueryResult Result;
+	FVector WeightedCenterSum = FVector::ZeroVector;
+
+	if (!Box.IsValid) return Result;
+
+	const FIntVector Min = GetVoxelCoordinates(Box.Min);
+	const FIntVector Max = GetVoxelCoordinates(Box.Max);
+
+	const int64 BoxVoxelsNum = static_cast<int64>(Max.X - Min.X + 1) * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1);
+
+	// Small boxes look up their cells, large ones scan the occupied voxels instead
+	if (BoxVoxelsNum <= Voxels.Num())
+	{
+		for (int32 z = Min.Z; z <= Max.Z; ++z)
+		{
+			for (int32 y = Min.Y; y <= Max.Y; ++y)
+			{
+				for (int32 x = Min.X; x <= Max.X; ++x)
+				{
+					const FIntVector Voxel(x, y, z);
+
+					if (const FAttentionVoxel* VoxelData = Voxels.Find(Voxel))
+					{
+						AddToResult(Voxel, *VoxelData, Result, WeightedCenterSum);
+
+						if (OutVoxels) OutVoxels->Add(Voxel);
+					}
+				}
+			}
+		}
+	}
+
+	else
+	{
+		for (const TPair<FIntVector, FAttentionVoxel>& Entry : Voxels)
+		{
+			const FIntVector& Voxel = Entry.Key;
+
+			if (Voxel.X < Min.X || Voxel.Y < Min.Y || Voxel.Z < Min.Z ||
+				Voxel.X > Max.X || Voxel.Y > Max.Y || Voxel.Z > Max.Z)
+				continue;
+
+			AddToResult(Voxel, Entry.Value, Result, WeightedCenterSum);
+
+			if (OutVoxels) OutVoxels->Add(Voxel);
+		}
+	}
+
+	if (Result.TotalDwellTime > 0.f)
+		Result.Centroid = WeightedCenterSum / Result.TotalDwellTime;
+
+	return Result;
+}
+
+FAttentionVolumeQueryResult FAttentionVolume::QueryActor(const FGuid& ActorGuid, TArray<FIntVector>* OutVoxels) const
+{
+	FAttentionVolumeQueryResult Result;
+	FVector WeightedCenterSum = FVector::ZeroVector;
+
+	const TSet<FIntVector>* ActorVoxels = VoxelsByActor.Find(ActorGuid);
+
+	if (!ActorVoxels) return Result;
+
+	for (const FIntVector& Voxel : *ActorVoxels)
+	{
+		// Voxels on the boundary of two actors count for both
+		AddToResult(Voxel, Voxels.FindChecked(Voxel), Result, WeightedCenterSum);
+
+		if (OutVoxels) OutVoxels->Add(Voxel);
+	}
+
+	if (Result.TotalDwellTime > 0.f)
+		Result.Centroid = WeightedCenterSum / Result.TotalDwellTime;
+
+	return Result;
+}
+
+FIntVector FAttentionVolume::GetVoxelCoordinates(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / VoxelSize),
+		FMath::FloorToInt32(Location.Y / VoxelSize),
+		FMath::FloorToInt32(Location.Z / VoxelSize));
+}
+
+FVector FAttentionVolume::GetVoxelCenter(const FIntVector& Voxel) const
+{
+	return (FVector(Voxel) + FVector(0.5)) * VoxelSize;
+}
+
+void FAttentionVolume::AddToResult(const FIntVector& Voxel, const FAttentionVoxel& VoxelData,
+	FAttentionVolumeQueryResult& Result, FVector& WeightedCenterSum) const
+{
+	Result.TotalDwellTime += VoxelData.DwellTime;
+	Result.SampleCount += VoxelData.SampleCount;
+	++Result.VoxelCount;
+
+	WeightedCenterSum += GetVoxelCenter(Voxel) * VoxelData.DwellTime;
+}
+
+bool FAttentionVolume::SaveToFile(const FString& FilePath) const
+{
+	TArray<uint8> FileData;
+	FMemoryWriter Writer(FileData);
+
+	uint32 Magic = FileMagic, Version = FileVersion;
+	float StoredVoxelSize = VoxelSize;
+	int32 VoxelsNum = Voxels.Num();
+
+	Writer << Magic << Version << StoredVoxelSize << VoxelsNum;
+
+	for (const TPair<FIntVector, FAttentionVoxel>& Entry : Voxels)
+	{
+		FIntVector Voxel = Entry.Key;
+		FAttentionVoxel VoxelData = Entry.Value;
+
+		Writer << Voxel << VoxelData.DwellTime << VoxelData.SampleCount;
+	}
+
+	int32 ActorsNum = VoxelsByActor.Num();
+	Writer << ActorsNum;
+
+	for (const TPair<FGuid, TSet<FIntVector>>& Entry : VoxelsByActor)
+	{
+		FGuid ActorGuid = Entry.Key;
+		TArray<FIntVector> ActorVoxels = Entry.Value.Array();
+
+		Writer << ActorGuid << ActorVoxels;
+	}
+
+	return FFileHelper::SaveArrayToFile(FileData, *FilePath);
+}
+
+bool FAttentionVolume::LoadFromFile(const FString& FilePath)
+{
+	TArray<uint8> FileData;
+
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath, FILEREAD_Silent)) return false;
+
+	FMemoryReader Reader(FileData);
+
+	uint32 Magic = 0, Version = 0;
+	float StoredVoxelSize = 0.f;
+	int32 VoxelsNum = 0;
+
+	Reader << Magic << Version;
+
+	if (Magic != FileMagic || Version != FileVersion) return false;
+
+	Reader << StoredVoxelSize << VoxelsNum;
+
+	if (Reader.IsError() || StoredVoxelSize <= 0.f || VoxelsNum < 0) return false;
+
+	Reset(StoredVoxelSize);
+	Voxels.Reserve(VoxelsNum);
+
+	for (int32 i = 0; i < VoxelsNum && !Reader.IsError(); ++i)
+	{
+		FIntVector Voxel;
+		FAttentionVoxel VoxelData;
+
+		Reader << Voxel << VoxelData.DwellTime << VoxelData.SampleCount;
+
+		Voxels.Add(Voxel, VoxelData);
+	}
+
+	int32 ActorsNum = 0;
+	Reader << ActorsNum;
+
+	for (int32 i = 0; i < ActorsNum && !Reader.IsError(); ++i)
+	{
+		FGuid ActorGuid;
+		TArray<FIntVector> ActorVoxels;
+
+		Reader << ActorGuid << ActorVoxels;
+
+		TSet<FIntVector>& ActorVoxelSet = VoxelsByActor.FindOrAdd(ActorGuid);
+
+		// Only keep references the voxel map can resolve
+		for (const FIntVector& Voxel : ActorVoxels)
+		{
+			if (Voxels.Contains(Voxel))
+				ActorVoxelSet.Add(Voxel);
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		Reset(StoredVoxelSize);
+		return false;
+	}
+
+	return true;
+}
+
+FString FAttentionVolume::GetSidecarFilePath(const FString& SessionFilePath)
+{
+	return FPaths::ChangeExtension(SessionFilePath, "voxels");
+}
@@ -5,19 +5,37 @@
 #include "Kismet/GameplayStatics.h"
 #include "Recorder/TakeRecorderBlueprintLibrary.h"
 #include "Camera/CameraComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SceneManagement.h"
 
 #include "HeatmapRT.h"
 #include "HeatmapReadyActor.h"
+#include "HeatmapUvLookupCache.h"
+#include "Waypoint.h"
 #include "DebugHeader.h"
-#include "AdditionalUtility.h"
 
 AEyeTrackingCharacter::AEyeTrackingCharacter()
 	:	TakeRecorderPanelReference(nullptr),
 		bIsTracking(false),
 		CurrentTimeStep(0.f),
+		RunLengthUvEpsilon(UHeatmapRT::DefaultRunLengthUvEpsilon),
+		AttentionVoxelSize(FAttentionVolume::DefaultVoxelSize),
+		bTrackVisibility(true),
+		bVisibilityOcclusion(true),
+		bFovealSampling(false),
+		FovealConeHalfAngle(2.f),
+		FovealSigma(1.f),
+		FovealRayCount(32),
+		FovealRayBudget(8),
 		LastActorFocussed(nullptr),
 		bVR(false),
-		TrackingStartTime(0.f)
+		bIsReplayingPose(false),
+		PoseReplayTime(0.f),
+		TrackingStartTime(0.f),
+		PreReplayMovementMode(MOVE_Walking),
+		PreReplayCustomMovementMode(0),
+		NextRouteWaypoint(0),
+		FovealPatternOffset(0)
 {
 	PrimaryActorTick.bCanEverTick = true;
 }
@@ -39,6 +57,15 @@ void AEyeTrackingCharacter::BeginPlay()
 		bUseControllerRotationPitch = true;
 		bUseControllerRotationYaw = true;
 	}
+
+	HeatmapSavedHandle = UHeatmapRT::OnHeatmapSaved.AddUObject(this, &AEyeTrackingCharacter::SaveSessionSidecars);
+}
+
+void AEyeTrackingCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UHeatmapRT::OnHeatmapSaved.Remove(HeatmapSavedHandle);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AEyeTrackingCharacter::GazeScreenToWorld(FVector& LineTraceStart, FVector& LineTraceEnd) const
@@ -113,6 +140,21 @@ void AEyeTrackingCharacter::PaintHeatmap(uint8 UvChannel, const UCameraComponent
 		LineTraceEnd = LineTraceStart + Camera->GetForwardVector() * 10000.f;
 	}
 
+	const float Time = UGameplayStatics::GetTimeSeconds(this) - TrackingStartTime;
+
+	PoseTrack.AddSample(Camera->GetComponentLocation(), Camera->GetComponentQuat(), Time);
+
+	// The center of the gaze, also with foveal sampling
+	GazeRays.SetUvChannel(UvChannel);
+	GazeRays.AddRay(LineTraceStart, LineTraceEnd, Time);
+
+	if (bFovealSampling)
+	{
+		ResolveFovealTraces(UvChannel);
+		QueueFovealTraces(LineTraceStart, LineTraceEnd);
+		return;
+	}
+
 	TArray<TEnumAsByte<EObjectTypeQuery>> ObjectTypes;
 	ObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_WorldStatic));
 
@@ -127,17 +169,33 @@ void AEyeTrackingCharacter::PaintHeatmap(uint8 UvChannel, const UCameraComponent
 	
 	AHeatmapReadyActor* ActorToPaint = Cast<AHeatmapReadyActor>(HitResult.HitObjectHandle.FetchActor());
 
+	// Every hit counts in world space, converted actor or not
+	AttentionVolume.AddHit(HitResult.ImpactPoint, UGameplayStatics::GetWorldDeltaSeconds(this),
+		ActorToPaint ? ActorToPaint->HeatmapActorGuid : FGuid());
+
+	GazePoints.AddPoint(HitResult.ImpactPoint, Time);
+
 	if (!ActorToPaint)
 	{
 		// DebugHeader::Print("HeatmapReadyActor invalid", FColor::Red, 0.f);
 		return;
 	}
-	
-	CurrentTimeStep = UGameplayStatics::GetTimeSeconds(this) - TrackingStartTime;
+
+	RecordHeatmapHit(HitResult, ActorToPaint, UvChannel, Time, 1.f);
+}
+
+void AEyeTrackingCharacter::RecordHeatmapHit(const FHitResult& HitResult, AHeatmapReadyActor* ActorToPaint,
+	const uint8 UvChannel, const float Time, const float Weight)
+{
+	CurrentTimeStep = Time;
 
 	FVector2D UvCoordinates;
 	
-	if (!UGameplayStatics::FindCollisionUV(HitResult, UvChannel, UvCoordinates))
+	const int32 HeatmapUvChannel = ActorToPaint->GetHeatmapUvChannel(UvChannel);
+
+	// The lookup tables don't need CPU-accessible render data, FindCollisionUV covers meshes without one
+	if (!AHeatmapUvLookupCache::FindCollisionUv(HitResult, HeatmapUvChannel, UvCoordinates) &&
+		!UGameplayStatics::FindCollisionUV(HitResult, HeatmapUvChannel, UvCoordinates))
 	{
 		DebugHeader::Print("FindCollisionUV() returned false", FColor::Red, 5.f);
 		return;
@@ -145,74 +203,389 @@ void AEyeTrackingCharacter::PaintHeatmap(uint8 UvChannel, const UCameraComponent
 
 	// DebugHeader::Print(UvCoordinates.ToString(), FColor::Red, 0.f);
 	
-	FVector2D PaintBrushScaleDivisor = CalculateScaleDivisor(ActorToPaint, HitResult.ImpactNormal);
+	const EHeatmapFaceAxis FaceAxis = ActorToPaint->GetFaceAxis(HitResult.ImpactNormal);
 	
-	ActorToPaint->ScalePaintBrush(PaintBrushScaleDivisor);
-	ActorToPaint->PaintHeatmap(UvCoordinates);
+	ActorToPaint->ScalePaintBrushForFaceAxis(FaceAxis);
+	ActorToPaint->PaintHeatmap(UvCoordinates, Weight);
 
 	FAttentionTrackingDataPoint NewHeatmapDataPoint
 	{
 		FMath::Clamp<float>(CurrentTimeStep, 0.f, 1024.f),
 		UKismetSystemLibrary::GetObjectName(ActorToPaint),
+		ActorToPaint->HeatmapActorGuid,
 		UvCoordinates,
-		PaintBrushScaleDivisor
+		FaceAxis
 	};
+
+	NewHeatmapDataPoint.Weight = Weight;
+
+	if (!HeatmapData.IsEmpty() && UHeatmapRT::TryMergeIntoRun(HeatmapData.Last(), NewHeatmapDataPoint, RunLengthUvEpsilon))
+		return;
 	
 	HeatmapData.Add(NewHeatmapDataPoint);
 }
 
-/*
-* TODO: Scaling should be calculated when loading, not when writing the heatmap data!
-*/
-FVector2D AEyeTrackingCharacter::CalculateScaleDivisor(AActor* HitActor, const FVector ImpactNormal)
+void AEyeTrackingCharacter::QueueFovealTraces(const FVector& LineTraceStart, const FVector& LineTraceEnd)
 {
-	const UStaticMeshComponent* StaticMeshComponent =
-		Cast<UStaticMeshComponent>(HitActor->FindComponentByClass(UStaticMeshComponent::StaticClass()));
+	UWorld* World = GetWorld();
 
-	if (!StaticMeshComponent) return FVector2D(1.f, 1.f);
+	if (!World) return;
 
-	FVector2D ScaleDivisor;
+	const int32 RayCount = FMath::Max(FovealRayCount, 1);
+	const int32 RaysThisFrame = FMath::Clamp(FovealRayBudget, 1, RayCount);
 
-	FVector Min, Max;
-	StaticMeshComponent->GetLocalBounds(Min, Max);
+	const FVector Forward = (LineTraceEnd - LineTraceStart).GetSafeNormal();
+	const double TraceLength = FVector::Distance(LineTraceStart, LineTraceEnd);
 
-	// ::Print("Min: " + Min.ToString() + " Max: " + Max.ToString(), FColor::Yellow, 0.f);
+	FVector Right, Up;
+	Forward.FindBestAxisVectors(Right, Up);
 
-	TArray<double> SortedBoundsAxes;
-	UAdditionalUtility::GetAxesByLength(Max, SortedBoundsAxes);
-	const float LongestAxis = SortedBoundsAxes[0] / 100.f;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(FovealGazeTrace), true, this);
+	QueryParams.bReturnFaceIndex = true;
 
-	const FVector MeshScale = StaticMeshComponent->GetComponentScale() * LongestAxis;
-	// const FVector MeshScale = Max * LongestAxis;
-	
-	const float ForwardDot = FMath::Abs(FVector::DotProduct(ImpactNormal, HitActor->GetActorForwardVector()));
-	const float RightDot = FMath::Abs(FVector::DotProduct(ImpactNormal, HitActor->GetActorRightVector()));
-	const float UpDot = FMath::Abs(FVector::DotProduct(ImpactNormal, HitActor->GetActorUpVector()));
+	const FCollisionObjectQueryParams ObjectQueryParams(ECC_WorldStatic);
 
-	if (ForwardDot >= RightDot && ForwardDot >= UpDot)
-		ScaleDivisor = FVector2D(MeshScale.Y, MeshScale.Z);
-	
-	else if (RightDot >= ForwardDot && RightDot >= UpDot)
-		ScaleDivisor = FVector2D(MeshScale.X, MeshScale.Y);
-	
-	else if (UpDot >= ForwardDot && UpDot >= RightDot)
-		ScaleDivisor = FVector2D(MeshScale.X, MeshScale.Y);
-	
-	// This should never happen...
-	else ScaleDivisor = FVector2D(1.f, 1.f);
-	
-	return ScaleDivisor;
+	const float HalfAngle = FMath::DegreesToRadians(FovealConeHalfAngle);
+	const float Sigma = FMath::DegreesToRadians(FMath::Max(FovealSigma, 0.01f));
+
+	FFovealBatch& Batch = PendingFovealBatches.AddDefaulted_GetRef();
+	Batch.Time = UGameplayStatics::GetTimeSeconds(this) - TrackingStartTime;
+	Batch.DeltaSeconds = UGameplayStatics::GetWorldDeltaSeconds(this);
+
+	// Vogel spiral, which covers the cone evenly for any ray count
+	constexpr float GoldenAngle = 2.39996323f;
+
+	for (int32 i = 0; i < RaysThisFrame; ++i)
+	{
+		const int32 RayIndex = (FovealPatternOffset + i) % RayCount;
+
+		const float Angle = HalfAngle * FMath::Sqrt((RayIndex + 0.5f) / RayCount);
+		const float Phi = RayIndex * GoldenAngle;
+
+		const FVector Direction = (Forward + FMath::Tan(Angle) *
+			(FMath::Cos(Phi) * Right + FMath::Sin(Phi) * Up)).GetSafeNormal();
+
+		const FTraceHandle TraceHandle = World->AsyncLineTraceByObjectType(EAsyncTraceType::Single, LineTraceStart,
+			LineTraceStart + Direction * TraceLength, ObjectQueryParams, QueryParams);
+
+		Batch.Rays.Add({ TraceHandle, FMath::Exp(-Angle * Angle / (2.f * Sigma * Sigma)) });
+	}
+
+	FovealPatternOffset = (FovealPatternOffset + RaysThisFrame) % RayCount;
+}
+
+void AEyeTrackingCharacter::ResolveFovealTraces(const uint8 UvChannel)
+{
+	UWorld* World = GetWorld();
+
+	if (!World) return;
+
+	TArray<FTraceDatum> Results;
+
+	while (!PendingFovealBatches.IsEmpty())
+	{
+		const FFovealBatch& Batch = PendingFovealBatches[0];
+
+		Results.Reset();
+		Results.SetNum(Batch.Rays.Num());
+
+		bool bComplete = true;
+		bool bExpired = false;
+
+		for (int32 i = 0; i < Batch.Rays.Num() && bComplete; ++i)
+		{
+			if (World->QueryTraceData(Batch.Rays[i].TraceHandle, Results[i])) continue;
+
+			bComplete = false;
+			bExpired = !World->IsTraceHandleValid(Batch.Rays[i].TraceHandle, false);
+		}
+
+		// Results are only kept for a frame, a batch that missed them can't be completed anymore
+		if (!bComplete && !bExpired) return;
+
+		if (bComplete)
+			ResolveFovealBatch(Batch, Results, UvChannel);
+
+		PendingFovealBatches.RemoveAt(0);
+	}
+}
+
+void AEyeTrackingCharacter::ResolveFovealBatch(const FFovealBatch& Batch, const TArray<FTraceDatum>& Results,
+	const uint8 UvChannel)
+{
+	struct FActorHits
+	{
+		float Weight = 0.f;
+		FVector WeightedLocation = FVector::ZeroVector;
+		TArray<const FHitResult*, TInlineAllocator<16>> Hits;
+	};
+
+	float TotalWeight = 0.f;
+
+	for (const FFovealRay& Ray : Batch.Rays)
+		TotalWeight += Ray.Weight;
+
+	if (TotalWeight <= 0.f) return;
+
+	TMap<AHeatmapReadyActor*, FActorHits> HitsByActor;
+
+	FVector GazeLocation = FVector::ZeroVector;
+	float GazeWeight = 0.f;
+
+	for (int32 i = 0; i < Results.Num(); ++i)
+	{
+		if (Results[i].OutHits.IsEmpty() || !Results[i].OutHits[0].bBlockingHit) continue;
+
+		const FHitResult& HitResult = Results[i].OutHits[0];
+		const float Weight = Batch.Rays[i].Weight;
+
+		AHeatmapReadyActor* HitActor = Cast<AHeatmapReadyActor>(HitResult.HitObjectHandle.FetchActor());
+
+		// Every ray counts in world space with its share of the frame
+		AttentionVolume.AddHit(HitResult.ImpactPoint, Batch.DeltaSeconds * Weight / TotalWeight,
+			HitActor ? HitActor->HeatmapActorGuid : FGuid());
+
+		GazeLocation += HitResult.ImpactPoint * Weight;
+		GazeWeight += Weight;
+
+		if (!HitActor) continue;
+
+		FActorHits& ActorHits = HitsByActor.FindOrAdd(HitActor);
+		ActorHits.Weight += Weight;
+		ActorHits.WeightedLocation += HitResult.ImpactPoint * Weight;
+		ActorHits.Hits.Add(&HitResult);
+	}
+
+	if (GazeWeight > 0.f)
+		GazePoints.AddPoint(GazeLocation / GazeWeight, Batch.Time);
+
+	AHeatmapReadyActor* ActorToPaint = nullptr;
+	const FActorHits* DominantHits = nullptr;
+
+	for (const TPair<AHeatmapReadyActor*, FActorHits>& ActorHits : HitsByActor)
+	{
+		if (!DominantHits || ActorHits.Value.Weight > DominantHits->Weight)
+		{
+			ActorToPaint = ActorHits.Key;
+			DominantHits = &ActorHits.Value;
+		}
+	}
+
+	if (!DominantHits) return;
+
+	// The hit closest to the weighted center stands for the cone; averaging UVs could cross seams
+	const FVector Center = DominantHits->WeightedLocation / DominantHits->Weight;
+	const FHitResult* CenterHit = DominantHits->Hits[0];
+
+	for (const FHitResult* HitResult : DominantHits->Hits)
+	{
+		if (FVector::DistSquared(HitResult->ImpactPoint, Center) < FVector::DistSquared(CenterHit->ImpactPoint, Center))
+			CenterHit = HitResult;
+	}
+
+	RecordHeatmapHit(*CenterHit, ActorToPaint, UvChannel, Batch.Time, DominantHits->Weight / TotalWeight);
+}
+
+FVector2D AEyeTrackingCharacter::CalculateScaleDivisor(AActor* HitActor, const FVector ImpactNormal)
+{
+	const AHeatmapReadyActor* HeatmapReadyActor = Cast<AHeatmapReadyActor>(HitActor);
+
+	if (!HeatmapReadyActor) return FVector2D(1.f, 1.f);
+
+	return HeatmapReadyActor->GetScaleDivisor(HeatmapReadyActor->GetFaceAxis(ImpactNormal));
 }
 
 void AEyeTrackingCharacter::SetEyeTrackingState()
 {
 	bIsTracking = !bIsTracking;
 
-	if (bIsTracking) HeatmapData.Empty();
+	if (bIsTracking)
+	{
+		HeatmapData.Empty();
+		AttentionVolume.Reset(AttentionVoxelSize);
+		GazePoints.Reset();
+		GazeRays.Reset();
+		PoseTrack.Reset();
+		SegmentMarkers.Empty();
+
+		TArray<AActor*> Waypoints;
+		UGameplayStatics::GetAllActorsOfClass(this, AWaypoint::StaticClass(), Waypoints);
+
+		Waypoints.Sort([](const AActor& A, const AActor& B)
+		{
+			return Cast<AWaypoint>(&A)->Index < Cast<AWaypoint>(&B)->Index;
+		});
+
+		RouteWaypoints.Reset();
+		NextRouteWaypoint = 0;
+
+		for (AActor* Waypoint : Waypoints)
+			RouteWaypoints.Add(Cast<AWaypoint>(Waypoint));
+
+		if (bTrackVisibility)
+			VisibilityTracker.Init(this);
+	}
+
+	PendingFovealBatches.Reset();
 
 	TrackingStartTime = UGameplayStatics::GetTimeSeconds(this);
 }
 
+template <typename TSidecar>
+static void SaveSidecar(const TSidecar& Sidecar, const FString& SessionFilePath, const FString& Description)
+{
+	const FString FilePath = TSidecar::GetSidecarFilePath(SessionFilePath);
+
+	DebugHeader::ShowNotifyInfoIf(!Sidecar.SaveToFile(FilePath), "Failed to save " + Description + " to " + FilePath);
+}
+
+void AEyeTrackingCharacter::SaveSession(const FString& FileName) const
+{
+	UHeatmapRT::SaveHeatmap(FileName, HeatmapData);
+}
+
+void AEyeTrackingCharacter::SaveSessionSidecars(const FString& FileName) const
+{
+	// Another character's session; every tracked frame leaves a gaze ray
+	if (GazeRays.GetRays().IsEmpty()) return;
+
+	const FString SessionFilePath = UJsonParser::AttentionTrackingDataFolderPath() + FileName;
+
+	SaveSidecar(AttentionVolume, SessionFilePath, "attention volume");
+	SaveSidecar(GazePoints, SessionFilePath, "gaze points");
+
+	// The raw rays, so the session can be re-projected after the level changed
+	SaveSidecar(GazeRays, SessionFilePath, "gaze rays");
+
+	// The camera path and orientation while tracking, for walk-through replays
+	SaveSidecar(PoseTrack, SessionFilePath, "pose track");
+
+	// Waypoints reached while tracking, which split the metrics into the legs of the route
+	const FString SegmentMarkersFilePath = UJsonParser::SegmentMarkersFilePath(SessionFilePath);
+
+	bool bSegmentMarkersSaved;
+	UJsonParser::WriteSegmentMarkersToJsonFile(SegmentMarkers, SegmentMarkersFilePath, bSegmentMarkersSaved);
+
+	DebugHeader::ShowNotifyInfoIf(!bSegmentMarkersSaved, "Failed to save segment markers to " + SegmentMarkersFilePath);
+
+	if (bTrackVisibility)
+	{
+		const FString VisibilityFilePath = FHeatmapVisibilityTracker::GetSidecarFilePath(SessionFilePath);
+
+		// Seconds each metrics actor was in view while tracking, per MetricsName
+		TMap<FString, float> VisibleTimes;
+		VisibilityTracker.GetVisibleTimes(VisibleTimes);
+
+		bool bOutSuccess;
+		UJsonParser::WriteFloatMapToJsonFile(VisibleTimes, VisibilityFilePath, bOutSuccess);
+
+		DebugHeader::ShowNotifyInfoIf(!bOutSuccess, "Failed to save visible times to " + VisibilityFilePath);
+	}
+}
+
+bool AEyeTrackingCharacter::StartPoseReplay(const FString& FileName)
+{
+	const FString FilePath =
+		FPoseTrack::GetSidecarFilePath(UJsonParser::AttentionTrackingDataFolderPath() + FileName);
+
+	if (!ReplayedPoseTrack.LoadFromFile(FilePath) || ReplayedPoseTrack.Num() == 0)
+	{
+		DebugHeader::ShowNotifyInfo("No pose track recorded for " + FileName);
+		return false;
+	}
+
+	// The track moves the pawn, input and gravity shouldn't
+	if (!bIsReplayingPose)
+	{
+		PreReplayMovementMode = GetCharacterMovement()->MovementMode;
+		PreReplayCustomMovementMode = GetCharacterMovement()->CustomMovementMode;
+	}
+
+	GetCharacterMovement()->DisableMovement();
+
+	bIsReplayingPose = true;
+	PoseReplayTime = ReplayedPoseTrack.GetStartTime();
+
+	UpdatePoseReplay(0.f);
+
+	return true;
+}
+
+void AEyeTrackingCharacter::StopPoseReplay()
+{
+	if (!bIsReplayingPose) return;
+
+	bIsReplayingPose = false;
+	GetCharacterMovement()->SetMovementMode(PreReplayMovementMode, PreReplayCustomMovementMode);
+}
+
+void AEyeTrackingCharacter::SeekPoseReplay(const float Time)
+{
+	if (!bIsReplayingPose) return;
+
+	PoseReplayTime = Time;
+	UpdatePoseReplay(0.f);
+}
+
+void AEyeTrackingCharacter::UpdatePoseReplay(const float DeltaTime)
+{
+	PoseReplayTime += DeltaTime;
+
+	FVector CameraLocation;
+	FQuat CameraRotation;
+
+	if (!ReplayedPoseTrack.Evaluate(PoseReplayTime, CameraLocation, CameraRotation))
+	{
+		StopPoseReplay();
+		return;
+	}
+
+	if (AController* PawnController = GetController())
+		PawnController->SetControlRotation(CameraRotation.Rotator());
+
+	// The pawn is placed so that its camera ends up on the recorded pose
+	const UCameraComponent* Camera = FindComponentByClass<UCameraComponent>();
+	const FVector CameraOffset = Camera ? Camera->GetComponentLocation() - GetActorLocation() : FVector::ZeroVector;
+
+	SetActorLocation(CameraLocation - CameraOffset, false, nullptr, ETeleportType::TeleportPhysics);
+
+	if (PoseReplayTime >= ReplayedPoseTrack.GetEndTime())
+		StopPoseReplay();
+}
+
+void AEyeTrackingCharacter::UpdateRoute()
+{
+	const FVector Location = GetActorLocation();
+
+	for (int32 i = NextRouteWaypoint; i < RouteWaypoints.Num(); ++i)
+	{
+		const AWaypoint* Waypoint = RouteWaypoints[i].Get();
+
+		if (!Waypoint ||
+			FVector::DistSquared(Waypoint->GetActorLocation(), Location) > FMath::Square(Waypoint->ReachRadius)) continue;
+
+		SegmentMarkers.Add({ UGameplayStatics::GetTimeSeconds(this) - TrackingStartTime, Waypoint->Index });
+		NextRouteWaypoint = i + 1;
+		return;
+	}
+}
+
+void AEyeTrackingCharacter::UpdateVisibility(const float DeltaTime)
+{
+	const APlayerCameraManager* PlayerCameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+
+	if (!PlayerCameraManager) return;
+
+	FMatrix ViewMatrix, ProjectionMatrix, ViewProjectionMatrix;
+	UGameplayStatics::GetViewProjectionMatrix(PlayerCameraManager->GetCameraCacheView(), ViewMatrix, ProjectionMatrix,
+		ViewProjectionMatrix);
+
+	FConvexVolume Frustum;
+	GetViewFrustumBounds(Frustum, ViewProjectionMatrix, false);
+
+	VisibilityTracker.Update(Frustum, DeltaTime, bVisibilityOcclusion);
+}
+
 void AEyeTrackingCharacter::PaintHeatmapDataPoint(const FAttentionTrackingDataPoint& DataPoint) const 
 {
 	UHeatmapRT::PaintHeatmapDataPoint(DataPoint, this);
@@ -258,6 +631,14 @@ void AEyeTrackingCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	if (bIsTracking && bTrackVisibility)
+		UpdateVisibility(DeltaTime);
+
+	if (bIsTracking)
+		UpdateRoute();
+
+	if (bIsReplayingPose)
+		UpdatePoseReplay(DeltaTime);
 }
 
 // Called to bind functionality to input
@@ -0,0 +1,231 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "GazePointCloud.h"
+
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+FGazePointQuery FGazePointQuery::MakeRadius(const FVector& Center, const float Radius)
+{
+	FGazePointQuery Query;
+	Query.Type = EType::Radius;
+	Query.Center = Center;
+	Query.Radius = Radius;
+
+	return Query;
+}
+
+FGazePointQuery FGazePointQuery::MakeBox(const FBox& Box)
+{
+	FGazePointQuery Query;
+	Query.Type = EType::Box;
+	Query.Box = Box;
+
+	return Query;
+}
+
+FGazePointQuery FGazePointQuery::MakeFrustum(const FConvexVolume& Frustum)
+{
+	FGazePointQuery Query;
+	Query.Type = EType::Frustum;
+	Query.Frustum = Frustum;
+
+	return Query;
+}
+
+FGazePointCloud::FGazePointCloud()
+	: Octree(MakeUnique<FOctree>(FVector::ZeroVector, RootExtent))
+{
+}
+
+void FGazePointCloud::AddPoint(const FVector& Location, const float Time)
+{
+	const int32 PointIndex = Points.Add({ Location, Time });
+
+	Octree->AddElement({ Location, PointIndex });
+}
+
+void FGazePointCloud::Reset()
+{
+	Points.Empty();
+	Octree = MakeUnique<FOctree>(FVector::ZeroVector, RootExtent);
+}
+
+void FGazePointCloud::QueryRadius(const FVector& Center, const float Radius, TArray<FGazeSampleRange>& OutRanges) const
+{
+	TArray<int32> PointIndices;
+	const double RadiusSquared = FMath::Square(static_cast<double>(Radius));
+
+	Octree->FindElementsWithBoundsTest(FBoxCenterAndExtent(Center, FVector(Radius)),
+		[&PointIndices, &Center, RadiusSquared](const FElement& Element)
+		{
+			if (FVector::DistSquared(Element.Location, Center) <= RadiusSquared)
+				PointIndices.Add(Element.PointIndex);
+		});
+
+	MakeRanges(PointIndices, Points, OutRanges);
+}
+
+void FGazePointCloud::QueryBox(const FBox& Box, TArray<FGazeSampleRange>& OutRanges) const
+{
+	TArray<int32> PointIndices;
+
+	if (Box.IsValid)
+	{
+		Octree->FindElementsWithBoundsTest(FBoxCenterAndExtent(Box),
+			[&PointIndices, &Box](const FElement& Element)
+			{
+				if (Box.IsInsideOrOn(Element.Location))
+					PointIndices.Add(Element.PointIndex);
+			});
+	}
+
+	MakeRanges(PointIndices, Points, OutRanges);
+}
+
+void FGazePointCloud::QueryFrustum(const FConvexVolume& Frustum, TArray<FGazeSampleRange>& OutRanges) const
+{
+	TArray<int32> PointIndices;
+
+	Octree->FindElementsWithPredicate(
+		[&Frustum](FOctree::FNodeIndex ParentNodeIndex, FOctree::FNodeIndex NodeIndex, const FBoxCenterAndExtent& NodeBounds)
+		{
+			return Frustum.IntersectBox(NodeBounds.Center, NodeBounds.Extent);
+		},
+		[&PointIndices, &Frustum](FOctree::FNodeIndex ParentNodeIndex, const FElement& Element)
+		{
+			if (Frustum.IntersectPoint(Element.Location))
+				PointIndices.Add(Element.PointIndex);
+		});
+
+	MakeRanges(PointIndices, Points, OutRanges);
+}
+
+void FGazePointCloud::Query(const FGazePointQuery& Query, TArray<FGazeSampleRange>& OutRanges) const
+{
+	switch (Query.Type)
+	{
+	case FGazePointQuery::EType::Radius:
+		QueryRadius(Query.Center, Query.Radius, OutRanges);
+		break;
+
+	case FGazePointQuery::EType::Box:
+		QueryBox(Query.Box, OutRanges);
+		break;
+
+	case FGazePointQuery::EType::Frustum:
+		QueryFrustum(Query.Frustum, OutRanges);
+		break;
+	}
+}
+
+void FGazePointCloud::QueryBatch(const TArray<FGazePointQuery>& Queries,
+	TArray<TArray<FGazeSampleRange>>& OutRanges) const
+{
+	OutRanges.SetNum(Queries.Num());
+
+	ParallelFor(Queries.Num(), [this, &Queries, &OutRanges](const int32 i)
+	{
+		Query(Queries[i], OutRanges[i]);
+	});
+}
+
+void FGazePointCloud::MakeRanges(TArray<int32>& PointIndices, const TArray<FGazePoint>& Points,
+	TArray<FGazeSampleRange>& OutRanges)
+{
+	OutRanges.Reset();
+
+	if (PointIndices.IsEmpty()) return;
+
+	// The octree returns points in spatial order
+	PointIndices.Sort();
+
+	FGazeSampleRange Range = { PointIndices[0], PointIndices[0], Points[PointIndices[0]].Time, Points[PointIndices[0]].Time };
+
+	for (int32 i = 1; i < PointIndices.Num(); ++i)
+	{
+		const int32 PointIndex = PointIndices[i];
+
+		if (PointIndex == Range.LastSample + 1)
+		{
+			Range.LastSample = PointIndex;
+			Range.EndTime = Points[PointIndex].Time;
+			continue;
+		}
+
+		OutRanges.Add(Range);
+		Range = { PointIndex, PointIndex, Points[PointIndex].Time, Points[PointIndex].Time };
+	}
+
+	OutRanges.Add(Range);
+}
+
+bool FGazePointCloud::SaveToFile(const FString& FilePath) const
+{
+	TArray<uint8> FileData;
+	FMemoryWriter Writer(FileData);
+
+	uint32 Magic = FileMagic, Version = FileVersion;
+	int32 PointsNum = Points.Num();
+
+	Writer << Magic << Version << PointsNum;
+
+	for (const FGazePoint& Point : Points)
+	{
+		FVector3f Location(Point.Location);
+		float Time = Point.Time;
+
+		Writer << Location << Time;
+	}
+
+	return FFileHelper::SaveArrayToFile(FileData, *FilePath);
+}
+
+bool FGazePointCloud::LoadFromFile(const FString& FilePath)
+{
+	TArray<uint8> FileData;
+
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath, FILEREAD_Silent)) return false;
+
+	FMemoryReader Reader(FileData);
+
+	uint32 Magic = 0, Version = 0;
+	int32 PointsNum = 0;
+
+	Reader << Magic << Version;
+
+	if (Magic != FileMagic || Version != FileVersion) return false;
+
+	Reader << PointsNum;
+
+	if (Reader.IsError() || PointsNum < 0) return false;
+
+	Reset();
+	Points.Reserve(PointsNum);
+
+	for (int32 i = 0; i < PointsNum && !Reader.IsError(); ++i)
+	{
+		FVector3f Location;
+		float Time;
+
+		Reader << Location << Time;
+
+		AddPoint(FVector(Location), Time);
+	}
+
+	if (Reader.IsError())
+	{
+		Reset();
+		return false;
+	}
+
+	return true;
+}
+
+FString FGazePointCloud::GetSidecarFilePath(const FString& SessionFilePath)
+{
+	return FPaths::ChangeExtension(SessionFilePath, "gaze");
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "GazeRayStream.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void FGazeRayStream::AddRay(const FVector& Start, const FVector& End, const float Time)
+{
+	const FVector Ray = End - Start;
+
+	Rays.Add({ Start, FVector3f(Ray.GetSafeNormal()), Time });
+	Bounds += Start;
+	TraceLength = FMath::Max(TraceLength, static_cast<float>(Ray.Size()));
+}
+
+void FGazeRayStream::Reset()
+{
+	Rays.Empty();
+	Bounds = FBox(ForceInit);
+	TraceLength = 0.f;
+}
+
+bool FGazeRayStream::SaveToFile(const FString& FilePath) const
+{
+	TArray<uint8> FileData;
+	FMemoryWriter Writer(FileData);
+
+	uint32 Magic = FileMagic, Version = FileVersion;
+	uint8 SavedUvChannel = UvChannel;
+	float SavedTraceLength = TraceLength;
+	FVector3f BoundsMin = Bounds.IsValid ? FVector3f(Bounds.Min) : FVector3f::ZeroVector;
+	FVector3f BoundsMax = Bounds.IsValid ? FVector3f(Bounds.Max) : FVector3f::ZeroVector;
+	int32 RaysNum = Rays.Num();
+
+	Writer << Magic << Version << SavedUvChannel << SavedTraceLength << BoundsMin << BoundsMax << RaysNum;
+
+	const FVector3f BoundsSize = BoundsMax - BoundsMin;
+
+	for (const FGazeRay& Ray : Rays)
+	{
+		float Time = Ray.Time;
+		uint16 Origin[3];
+		int16 U, V;
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			const float Alpha = BoundsSize[Axis] > 0.f ?
+				(static_cast<float>(Ray.Origin[Axis]) - BoundsMin[Axis]) / BoundsSize[Axis] : 0.f;
+
+			Origin[Axis] = static_cast<uint16>(FMath::RoundToInt(FMath::Clamp(Alpha, 0.f, 1.f) * MAX_uint16));
+		}
+
+		EncodeDirection(Ray.Direction, U, V);
+
+		Writer << Time << Origin[0] << Origin[1] << Origin[2] << U << V;
+	}
+
+	return FFileHelper::SaveArrayToFile(FileData, *FilePath);
+}
+
+bool FGazeRayStream::LoadFromFile(const FString& FilePath)
+{
+	TArray<uint8> FileData;
+
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath, FILEREAD_Silent)) return false;
+
+	FMemoryReader Reader(FileData);
+
+	uint32 Magic = 0, Version = 0;
+
+	Reader << Magic << Version;
+
+	if (Magic != FileMagic || Version != FileVersion) return false;
+
+	uint8 LoadedUvChannel = 0;
+	float LoadedTraceLength = 0.f;
+	FVector3f BoundsMin, BoundsMax;
+	int32 RaysNum = 0;
+
+	Reader << LoadedUvChannel << LoadedTraceLength << BoundsMin << BoundsMax << RaysNum;
+
+	if (Reader.IsError() || RaysNum < 0) return false;
+
+	Reset();
+	UvChannel = LoadedUvChannel;
+	TraceLength = LoadedTraceLength;
+	Rays.Reserve(RaysNum);
+
+	const FVector3f BoundsSize = BoundsMax - BoundsMin;
+
+	for (int32 i = 0; i < RaysNum && !Reader.IsError(); ++i)
+	{
+		float Time;
+		uint16 Origin[3];
+		int16 U, V;
+
+		Reader << Time << Origin[0] << Origin[1] << Origin[2] << U << V;
+
+		const FVector3f Location = BoundsMin + BoundsSize *
+			FVector3f(Origin[0], Origin[1], Origin[2]) / static_cast<float>(MAX_uint16);
+
+		Rays.Add({ FVector(Location), DecodeDirection(U, V), Time });
+		Bounds += FVector(Location);
+	}
+
+	if (Reader.IsError())
+	{
+		Reset();
+		return false;
+	}
+
+	return true;
+}
+
+FString FGazeRayStream::GetSidecarFilePath(const FString& SessionFilePath)
+{
+	return FPaths::ChangeExtension(SessionFilePath, "rays");
+}
+
+void FGazeRayStream::EncodeDirection(const FVector3f& Direction, int16& OutU, int16& OutV)
+{
+	// Octahedral mapping: project onto |x| + |y| + |z| = 1, fold the lower half over the diagonals
+	const float L1Norm = FMath::Abs(Direction.X) + FMath::Abs(Direction.Y) + FMath::Abs(Direction.Z);
+
+	float U = L1Norm > 0.f ? Direction.X / L1Norm : 0.f;
+	float V = L1Norm > 0.f ? Direction.Y / L1Norm : 0.f;
+
+	if (Direction.Z < 0.f)
+	{
+		const float FoldedU = (1.f - FMath::Abs(V)) * (U >= 0.f ? 1.f : -1.f);
+		V = (1.f - FMath::Abs(U)) * (V >= 0.f ? 1.f : -1.f);
+		U = FoldedU;
+	}
+
+	OutU = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(U, -1.f, 1.f) * MAX_int16));
+	OutV = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(V, -1.f, 1.f) * MAX_int16));
+}
+
+FVector3f FGazeRayStream::DecodeDirection(const int16 U, const int16 V)
+{
+	float X = FMath::Max(U / static_cast<float>(MAX_int16), -1.f);
+	float Y = FMath::Max(V / static_cast<float>(MAX_int16), -1.f);
+	const float Z = 1.f - FMath::Abs(X) - FMath::Abs(Y);
+
+	if (Z < 0.f)
+	{
+		const float UnfoldedX = (1.f - FMath::Abs(Y)) * (X >= 0.f ? 1.f : -1.f);
+		Y = (1.f - FMath::Abs(X)) * (Y >= 0.f ? 1.f : -1.f);
+		X = UnfoldedX;
+	}
+
+	return FVector3f(X, Y, Z).GetSafeNormal();
+}
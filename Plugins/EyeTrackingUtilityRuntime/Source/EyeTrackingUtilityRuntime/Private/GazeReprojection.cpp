@@ -0,0 +1,118 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "GazeReprojection.h"
+
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "Kismet/GameplayStatics.h"
+#include "Kismet/KismetSystemLibrary.h"
+
+#include "HeatmapRT.h"
+#include "HeatmapReadyActor.h"
+#include "HeatmapActorRegistry.h"
+#include "HeatmapUvLookupCache.h"
+#include "GazeRayStream.h"
+
+bool FGazeReprojector::Reproject(const UWorld* World, const FGazeRayStream& GazeRays,
+	TArray<FAttentionTrackingDataPoint>& OutAttentionTrackingData, FGazePointCloud* OutGazePoints,
+	FAttentionVolume* OutAttentionVolume, const int32 BatchSize)
+{
+	OutAttentionTrackingData.Reset();
+
+	if (!World || !World->GetPhysicsScene()) return false;
+
+	const TArray<FGazeRay>& Rays = GazeRays.GetRays();
+
+	// The registry rebuilds lazily, so the cache is fetched here and not on the workers
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(World);
+	const AHeatmapUvLookupCache* UvLookupCache = Registry ? Registry->GetUvLookupCache() : nullptr;
+
+	struct FReprojectedRay
+	{
+		bool bHit = false;
+		FVector ImpactPoint = FVector::ZeroVector;
+		AHeatmapReadyActor* Actor = nullptr;
+		FVector2D Uv = FVector2D::ZeroVector;
+		EHeatmapFaceAxis FaceAxis = EHeatmapFaceAxis::EHFA_Forward;
+	};
+
+	TArray<FReprojectedRay> Results;
+	Results.SetNum(Rays.Num());
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GazeReprojection), true);
+	QueryParams.bReturnFaceIndex = true;
+
+	const FCollisionObjectQueryParams ObjectQueryParams(ECC_WorldStatic);
+
+	const double TraceLength = GazeRays.GetTraceLength();
+	const int32 RaysPerBatch = FMath::Max(BatchSize, 1);
+
+	ParallelFor(FMath::DivideAndRoundUp(Rays.Num(), RaysPerBatch), [&](const int32 Batch)
+	{
+		const int32 LastRay = FMath::Min((Batch + 1) * RaysPerBatch, Rays.Num());
+
+		for (int32 i = Batch * RaysPerBatch; i < LastRay; ++i)
+		{
+			const FGazeRay& Ray = Rays[i];
+			FReprojectedRay& Result = Results[i];
+
+			FHitResult HitResult;
+
+			if (!World->LineTraceSingleByObjectType(HitResult, Ray.Origin,
+				Ray.Origin + FVector(Ray.Direction) * TraceLength, ObjectQueryParams, QueryParams)) continue;
+
+			Result.bHit = true;
+			Result.ImpactPoint = HitResult.ImpactPoint;
+
+			AHeatmapReadyActor* Actor = Cast<AHeatmapReadyActor>(HitResult.HitObjectHandle.FetchActor());
+
+			if (!Actor) continue;
+
+			const int32 HeatmapUvChannel = Actor->GetHeatmapUvChannel(GazeRays.GetUvChannel());
+
+			if (!AHeatmapUvLookupCache::FindCollisionUv(UvLookupCache, HitResult, HeatmapUvChannel, Result.Uv) &&
+				!UGameplayStatics::FindCollisionUV(HitResult, HeatmapUvChannel, Result.Uv)) continue;
+
+			Result.Actor = Actor;
+			Result.FaceAxis = Actor->GetFaceAxis(HitResult.ImpactNormal);
+		}
+	});
+
+	for (int32 i = 0; i < Rays.Num(); ++i)
+	{
+		const FReprojectedRay& Result = Results[i];
+
+		if (!Result.bHit) continue;
+
+		const float Time = Rays[i].Time;
+
+		if (OutAttentionVolume)
+		{
+			const float DwellTime = i > 0 ? FMath::Clamp(Time - Rays[i - 1].Time, 0.f, MaxRayDwellTime) : 0.f;
+
+			OutAttentionVolume->AddHit(Result.ImpactPoint, DwellTime,
+				Result.Actor ? Result.Actor->HeatmapActorGuid : FGuid());
+		}
+
+		if (OutGazePoints)
+			OutGazePoints->AddPoint(Result.ImpactPoint, Time);
+
+		if (!Result.Actor) continue;
+
+		const FAttentionTrackingDataPoint DataPoint
+		{
+			FMath::Clamp<float>(Time, 0.f, 1024.f),
+			UKismetSystemLibrary::GetObjectName(Result.Actor),
+			Result.Actor->HeatmapActorGuid,
+			Result.Uv,
+			Result.FaceAxis
+		};
+
+		if (!OutAttentionTrackingData.IsEmpty() && UHeatmapRT::TryMergeIntoRun(OutAttentionTrackingData.Last(),
+			DataPoint, UHeatmapRT::DefaultRunLengthUvEpsilon)) continue;
+
+		OutAttentionTrackingData.Add(DataPoint);
+	}
+
+	return true;
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "HeatmapActorRegistry.h"
+
+#include "EngineUtils.h"
+
+#include "HeatmapReadyActor.h"
+#include "HeatmapUvLookupCache.h"
+
+void UHeatmapActorRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const UWorld* World = GetWorld();
+
+	if (!World) return;
+
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateUObject(this, &UHeatmapActorRegistry::OnActorSpawned));
+
+	ActorDestroyedHandle = World->AddOnActorDestroyedHandler(
+		FOnActorDestroyed::FDelegate::CreateUObject(this, &UHeatmapActorRegistry::OnActorDestroyed));
+
+	// Actors loaded with a level don't go through OnActorSpawned
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UHeatmapActorRegistry::OnLevelsChanged);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UHeatmapActorRegistry::OnLevelsChanged);
+}
+
+void UHeatmapActorRegistry::Deinitialize()
+{
+	if (const UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		World->RemoveOnActorDestroyededHandler(ActorDestroyedHandle);
+	}
+
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	ActorsByGuid.Empty();
+	GuidsByObjectName.Empty();
+	MissingGuids.Empty();
+
+	Super::Deinitialize();
+}
+
+UHeatmapActorRegistry* UHeatmapActorRegistry::Get(const UObject* WorldContextObject)
+{
+	if (!WorldContextObject) return nullptr;
+
+	const UWorld* World = WorldContextObject->GetWorld();
+
+	return World ? World->GetSubsystem<UHeatmapActorRegistry>() : nullptr;
+}
+
+AHeatmapReadyActor* UHeatmapActorRegistry::FindActor(const FGuid& ActorGuid)
+{
+	if (!ActorGuid.IsValid()) return nullptr;
+	
+	RebuildIfDirty();
+
+	const TWeakObjectPtr<AHeatmapReadyActor>* Found = ActorsByGuid.Find(ActorGuid);
+
+	if (Found && Found->IsValid() && (*Found)->HeatmapActorGuid == ActorGuid)
+		return Found->Get();
+
+	if (MissingGuids.Contains(ActorGuid)) return nullptr;
+
+	// Guids can change after spawning (e.g. pasted actors), so a miss triggers one full rescan
+	Rebuild();
+	Found = ActorsByGuid.Find(ActorGuid);
+
+	if (Found && Found->IsValid())
+		return Found->Get();
+
+	MissingGuids.Add(ActorGuid);
+	return nullptr;
+}
+
+FGuid UHeatmapActorRegistry::FindGuidByObjectName(const FString& ObjectName)
+{
+	RebuildIfDirty();
+
+	const FGuid* Found = GuidsByObjectName.Find(ObjectName);
+
+	return Found ? *Found : FGuid();
+}
+
+void UHeatmapActorRegistry::GetAllActors(TArray<AHeatmapReadyActor*>& OutActors)
+{
+	RebuildIfDirty();
+	
+	OutActors.Empty(ActorsByGuid.Num());
+
+	for (const TPair<FGuid, TWeakObjectPtr<AHeatmapReadyActor>>& Entry : ActorsByGuid)
+	{
+		if (AHeatmapReadyActor* Actor = Entry.Value.Get())
+			OutActors.Add(Actor);
+	}
+}
+
+AHeatmapUvLookupCache* UHeatmapActorRegistry::GetUvLookupCache()
+{
+	RebuildIfDirty();
+
+	return UvLookupCache.Get();
+}
+
+void UHeatmapActorRegistry::RegisterActor(AHeatmapReadyActor* Actor)
+{
+	if (!Actor || !Actor->HeatmapActorGuid.IsValid()) return;
+
+	ActorsByGuid.Add(Actor->HeatmapActorGuid, Actor);
+
+	for (const FString& LegacyObjectName : Actor->LegacyObjectNames)
+		GuidsByObjectName.Add(LegacyObjectName, Actor->HeatmapActorGuid);
+
+	// The current name takes precedence over names other actors had before
+	GuidsByObjectName.Add(Actor->GetName(), Actor->HeatmapActorGuid);
+}
+
+void UHeatmapActorRegistry::UnregisterActor(const AHeatmapReadyActor* Actor)
+{
+	if (!Actor) return;
+
+	ActorsByGuid.Remove(Actor->HeatmapActorGuid);
+}
+
+void UHeatmapActorRegistry::OnActorSpawned(AActor* Actor)
+{
+	if (AHeatmapUvLookupCache* SpawnedUvLookupCache = Cast<AHeatmapUvLookupCache>(Actor))
+	{
+		UvLookupCache = SpawnedUvLookupCache;
+		return;
+	}
+
+	AHeatmapReadyActor* HeatmapReadyActor = Cast<AHeatmapReadyActor>(Actor);
+
+	if (!HeatmapReadyActor) return;
+
+	MissingGuids.Empty();
+	RegisterActor(HeatmapReadyActor);
+}
+
+void UHeatmapActorRegistry::OnActorDestroyed(AActor* Actor)
+{
+	UnregisterActor(Cast<AHeatmapReadyActor>(Actor));
+}
+
+void UHeatmapActorRegistry::OnLevelsChanged(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld())
+		bDirty = true;
+}
+
+void UHeatmapActorRegistry::Rebuild()
+{
+	ActorsByGuid.Empty();
+	GuidsByObjectName.Empty();
+	MissingGuids.Empty();
+
+	bDirty = false;
+	
+	UWorld* World = GetWorld();
+
+	if (!World) return;
+
+	for (TActorIterator<AHeatmapReadyActor> It(World); It; ++It)
+		RegisterActor(*It);
+
+	TActorIterator<AHeatmapUvLookupCache> UvLookupCacheIt(World);
+	UvLookupCache = UvLookupCacheIt ? *UvLookupCacheIt : nullptr;
+}
+
+void UHeatmapActorRegistry::RebuildIfDirty()
+{
+	if (bDirty) Rebuild();
+}
@@ -0,0 +1,231 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "HeatmapAoi.h"
+
+#include "HeatmapUvLookupCache.h"
+
+void FHeatmapAoiIndex::Build(const TArray<FHeatmapAoi>& Aois, const FHeatmapUvTriangleTable* Table,
+	const int32 InResolution)
+{
+	Resolution = FMath::Max(InResolution, 1);
+
+	Polygons.Reset();
+	Polygons.SetNum(Aois.Num());
+
+	TArray<TArray<uint32>> CellEntries;
+	CellEntries.SetNum(Resolution * Resolution);
+
+	TArray<int32> BoxAoiIndices;
+
+	for (int32 AoiIndex = 0; AoiIndex < Aois.Num(); ++AoiIndex)
+	{
+		const FHeatmapAoi& Aoi = Aois[AoiIndex];
+
+		if (Aoi.Shape == EHeatmapAoiShape::EHAS_LocalBox)
+		{
+			if (Aoi.LocalBox.IsValid)
+				BoxAoiIndices.Add(AoiIndex);
+
+			continue;
+		}
+
+		if (Aoi.UvPolygon.Num() < 3) continue;
+
+		Polygons[AoiIndex] = Aoi.UvPolygon;
+
+		const FBox2D Bounds(Aoi.UvPolygon);
+
+		const int32 MinX = FMath::Clamp(FMath::FloorToInt32(Bounds.Min.X * Resolution), 0, Resolution - 1);
+		const int32 MaxX = FMath::Clamp(FMath::FloorToInt32(Bounds.Max.X * Resolution), 0, Resolution - 1);
+		const int32 MinY = FMath::Clamp(FMath::FloorToInt32(Bounds.Min.Y * Resolution), 0, Resolution - 1);
+		const int32 MaxY = FMath::Clamp(FMath::FloorToInt32(Bounds.Max.Y * Resolution), 0, Resolution - 1);
+
+		for (int32 y = MinY; y <= MaxY; ++y)
+		{
+			for (int32 x = MinX; x <= MaxX; ++x)
+				CellEntries[y * Resolution + x].Add(static_cast<uint32>(AoiIndex) | NeedsTestFlag);
+		}
+	}
+
+	// Sample the surface at every cell center through the mesh triangles and mark the boxes containing it
+	if (!BoxAoiIndices.IsEmpty() && Table)
+	{
+		// Coarse grid over the boxes, so a triangle is only tested against the boxes near it
+		FBox BoxesBounds(ForceInit);
+
+		for (const int32 AoiIndex : BoxAoiIndices)
+			BoxesBounds += Aois[AoiIndex].LocalBox;
+
+		const FVector BoxCellSize = (BoxesBounds.GetSize() / BoxGridResolution).ComponentMax(FVector(UE_KINDA_SMALL_NUMBER));
+
+		auto GetBoxCell = [&BoxesBounds, &BoxCellSize](const FVector& Position)
+		{
+			const FVector Cell = (Position - BoxesBounds.Min) / BoxCellSize;
+
+			return FIntVector(
+				FMath::Clamp(FMath::FloorToInt32(Cell.X), 0, BoxGridResolution - 1),
+				FMath::Clamp(FMath::FloorToInt32(Cell.Y), 0, BoxGridResolution - 1),
+				FMath::Clamp(FMath::FloorToInt32(Cell.Z), 0, BoxGridResolution - 1));
+		};
+
+		TArray<TArray<int32>> BoxCells;
+		BoxCells.SetNum(BoxGridResolution * BoxGridResolution * BoxGridResolution);
+
+		for (const int32 AoiIndex : BoxAoiIndices)
+		{
+			const FIntVector MinCell = GetBoxCell(Aois[AoiIndex].LocalBox.Min);
+			const FIntVector MaxCell = GetBoxCell(Aois[AoiIndex].LocalBox.Max);
+
+			for (int32 z = MinCell.Z; z <= MaxCell.Z; ++z)
+			{
+				for (int32 y = MinCell.Y; y <= MaxCell.Y; ++y)
+				{
+					for (int32 x = MinCell.X; x <= MaxCell.X; ++x)
+						BoxCells[(z * BoxGridResolution + y) * BoxGridResolution + x].Add(AoiIndex);
+				}
+			}
+		}
+
+		// Boxes spanning several cells are only collected once per triangle
+		TArray<int32> LastCandidateTriangle;
+		LastCandidateTriangle.Init(INDEX_NONE, Aois.Num());
+
+		const int32 TrianglesNum = Table->Indices.Num() / 3;
+
+		for (int32 Triangle = 0; Triangle < TrianglesNum; ++Triangle)
+		{
+			const uint32 I0 = Table->Indices[Triangle * 3];
+			const uint32 I1 = Table->Indices[Triangle * 3 + 1];
+			const uint32 I2 = Table->Indices[Triangle * 3 + 2];
+
+			const FVector P0(Table->Positions[I0]), P1(Table->Positions[I1]), P2(Table->Positions[I2]);
+
+			FBox TriangleBounds(ForceInit);
+			TriangleBounds += P0;
+			TriangleBounds += P1;
+			TriangleBounds += P2;
+
+			if (!BoxesBounds.Intersect(TriangleBounds)) continue;
+
+			TArray<int32, TInlineAllocator<8>> CandidateBoxes;
+
+			const FIntVector MinCell = GetBoxCell(TriangleBounds.Min);
+			const FIntVector MaxCell = GetBoxCell(TriangleBounds.Max);
+
+			for (int32 z = MinCell.Z; z <= MaxCell.Z; ++z)
+			{
+				for (int32 y = MinCell.Y; y <= MaxCell.Y; ++y)
+				{
+					for (int32 x = MinCell.X; x <= MaxCell.X; ++x)
+					{
+						for (const int32 AoiIndex : BoxCells[(z * BoxGridResolution + y) * BoxGridResolution + x])
+						{
+							if (LastCandidateTriangle[AoiIndex] == Triangle) continue;
+
+							LastCandidateTriangle[AoiIndex] = Triangle;
+
+							if (Aois[AoiIndex].LocalBox.Intersect(TriangleBounds))
+								CandidateBoxes.Add(AoiIndex);
+						}
+					}
+				}
+			}
+
+			if (CandidateBoxes.IsEmpty()) continue;
+
+			const FVector2D Uv0(Table->Uvs[I0]), Uv1(Table->Uvs[I1]), Uv2(Table->Uvs[I2]);
+
+			const double Denominator = (Uv1.Y - Uv2.Y) * (Uv0.X - Uv2.X) + (Uv2.X - Uv1.X) * (Uv0.Y - Uv2.Y);
+
+			if (FMath::IsNearlyZero(Denominator)) continue;
+
+			FBox2D UvBounds(ForceInit);
+			UvBounds += Uv0;
+			UvBounds += Uv1;
+			UvBounds += Uv2;
+
+			const int32 MinX = FMath::Clamp(FMath::FloorToInt32(UvBounds.Min.X * Resolution), 0, Resolution - 1);
+			const int32 MaxX = FMath::Clamp(FMath::FloorToInt32(UvBounds.Max.X * Resolution), 0, Resolution - 1);
+			const int32 MinY = FMath::Clamp(FMath::FloorToInt32(UvBounds.Min.Y * Resolution), 0, Resolution - 1);
+			const int32 MaxY = FMath::Clamp(FMath::FloorToInt32(UvBounds.Max.Y * Resolution), 0, Resolution - 1);
+
+			for (int32 y = MinY; y <= MaxY; ++y)
+			{
+				for (int32 x = MinX; x <= MaxX; ++x)
+				{
+					const FVector2D CellCenter((x + 0.5) / Resolution, (y + 0.5) / Resolution);
+
+					const double B0 = ((Uv1.Y - Uv2.Y) * (CellCenter.X - Uv2.X) + (Uv2.X - Uv1.X) * (CellCenter.Y - Uv2.Y)) / Denominator;
+					const double B1 = ((Uv2.Y - Uv0.Y) * (CellCenter.X - Uv2.X) + (Uv0.X - Uv2.X) * (CellCenter.Y - Uv2.Y)) / Denominator;
+					const double B2 = 1.0 - B0 - B1;
+
+					if (B0 < 0.0 || B1 < 0.0 || B2 < 0.0) continue;
+
+					const FVector LocalPosition = P0 * B0 + P1 * B1 + P2 * B2;
+
+					for (const int32 AoiIndex : CandidateBoxes)
+					{
+						if (Aois[AoiIndex].LocalBox.IsInsideOrOn(LocalPosition))
+							CellEntries[y * Resolution + x].AddUnique(static_cast<uint32>(AoiIndex));
+					}
+				}
+			}
+		}
+	}
+
+	CellStarts.SetNumUninitialized(CellEntries.Num() + 1);
+	Entries.Reset();
+
+	for (int32 Cell = 0; Cell < CellEntries.Num(); ++Cell)
+	{
+		CellStarts[Cell] = Entries.Num();
+		Entries.Append(CellEntries[Cell]);
+	}
+
+	CellStarts[CellEntries.Num()] = Entries.Num();
+}
+
+void FHeatmapAoiIndex::Classify(const FVector2D& Uv, TArray<int32, TInlineAllocator<4>>& OutAoiIndices) const
+{
+	OutAoiIndices.Reset();
+
+	if (Entries.IsEmpty()) return;
+
+	const int32 Cell = GetCellIndex(Uv);
+
+	for (int32 i = CellStarts[Cell]; i < CellStarts[Cell + 1]; ++i)
+	{
+		const uint32 Entry = Entries[i];
+		const int32 AoiIndex = static_cast<int32>(Entry & ~NeedsTestFlag);
+
+		if ((Entry & NeedsTestFlag) && !IsInsidePolygon(Uv, Polygons[AoiIndex])) continue;
+
+		OutAoiIndices.AddUnique(AoiIndex);
+	}
+}
+
+bool FHeatmapAoiIndex::IsInsidePolygon(const FVector2D& Point, const TArray<FVector2D>& Polygon)
+{
+	// Crossing number
+	bool bInside = false;
+
+	for (int32 i = 0, j = Polygon.Num() - 1; i < Polygon.Num(); j = i++)
+	{
+		const FVector2D& A = Polygon[i];
+		const FVector2D& B = Polygon[j];
+
+		if ((A.Y > Point.Y) != (B.Y > Point.Y) &&
+			Point.X < (B.X - A.X) * (Point.Y - A.Y) / (B.Y - A.Y) + A.X)
+			bInside = !bInside;
+	}
+
+	return bInside;
+}
+
+int32 FHeatmapAoiIndex::GetCellIndex(const FVector2D& Uv) const
+{
+	const int32 X = FMath::Clamp(FMath::FloorToInt32(Uv.X * Resolution), 0, Resolution - 1);
+	const int32 Y = FMath::Clamp(FMath::FloorToInt32(Uv.Y * Resolution), 0, Resolution - 1);
+
+	return Y * Resolution + X;
+}
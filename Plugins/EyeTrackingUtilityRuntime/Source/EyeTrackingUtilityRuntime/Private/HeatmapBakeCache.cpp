@@ -0,0 +1,188 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "HeatmapBakeCache.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#include "HeatmapReadyActor.h"
+#include "JsonParser.h"
+
+FString FHeatmapBakeCache::ComputeSessionHash(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData)
+{
+	FSHA1 Sha;
+
+	for (const FAttentionTrackingDataPoint& DataPoint : AttentionTrackingData)
+	{
+		const FVector2f Coordinates(DataPoint.Coordinates);
+		const uint8 FaceAxis = static_cast<uint8>(DataPoint.FaceAxis);
+
+		Sha.Update(reinterpret_cast<const uint8*>(&DataPoint.ActorGuid), sizeof(FGuid));
+		Sha.Update(reinterpret_cast<const uint8*>(&Coordinates), sizeof(FVector2f));
+		Sha.Update(&FaceAxis, sizeof(uint8));
+		Sha.Update(reinterpret_cast<const uint8*>(&DataPoint.SampleCount), sizeof(int32));
+
+		// Only foveal samples carry a weight, so hashes of single-ray sessions stay as they were. Weights are
+		// painted as brush area, so the tag keeps bakes from when the brush ignored them from matching.
+		if (DataPoint.Weight != 1.f)
+		{
+			constexpr uint8 WeightAsAreaTag = 1;
+			Sha.Update(&WeightAsAreaTag, sizeof(uint8));
+			Sha.Update(reinterpret_cast<const uint8*>(&DataPoint.Weight), sizeof(float));
+		}
+	}
+
+	Sha.Final();
+
+	FSHAHash Hash;
+	Sha.GetHash(Hash.Hash);
+
+	return Hash.ToString();
+}
+
+FString FHeatmapBakeCache::MakeKey(const FString& SessionHash, const AHeatmapReadyActor* HeatmapReadyActor)
+{
+	FString Key = SessionHash + "|" + HeatmapReadyActor->HeatmapActorGuid.ToString() + "|" +
+		HeatmapReadyActor->GetPaintBrushMaterialPath() + "|" + FString::FromInt(HeatmapReadyActor->GetHeatmapResolution());
+
+	// The brush size depends on the actor's scale, so rescaled actors must not hit old bakes
+	for (int32 i = 0; i < static_cast<int32>(EHeatmapFaceAxis::EHFA_MAX); ++i)
+		Key += "|" + HeatmapReadyActor->GetPaintBrushScaleDivisor(static_cast<EHeatmapFaceAxis>(i)).ToString();
+
+	return Key;
+}
+
+bool FHeatmapBakeCache::Load(const FString& Key, const int32 Resolution, TArray<FFloat16Color>& OutPixels)
+{
+	const FString FilePath = GetFilePath(Key);
+	TArray<uint8> FileData;
+
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath, FILEREAD_Silent)) return false;
+
+	FMemoryReader Reader(FileData);
+
+	uint32 Magic = 0, Version = 0;
+	FString StoredKey;
+	int32 StoredResolution = 0, UncompressedSize = 0;
+	uint32 StoredCrc = 0;
+	TArray<uint8> CompressedPixels;
+
+	Reader << Magic << Version;
+
+	if (Magic != FileMagic || Version != FileVersion) return false;
+
+	Reader << StoredKey << StoredResolution << UncompressedSize << StoredCrc << CompressedPixels;
+
+	const int32 ExpectedSize = Resolution * Resolution * sizeof(FFloat16Color);
+
+	if (Reader.IsError() || StoredKey != Key || StoredResolution != Resolution || UncompressedSize != ExpectedSize)
+		return false;
+
+	if (!UncompressPixels(CompressedPixels, Resolution * Resolution, OutPixels) ||
+		FCrc::MemCrc32(OutPixels.GetData(), UncompressedSize) != StoredCrc)
+		return false;
+
+	// The modification time is the last use, Trim goes by it
+	IFileManager::Get().SetTimeStamp(*FilePath, FDateTime::UtcNow());
+
+	return true;
+}
+
+bool FHeatmapBakeCache::Save(const FString& Key, const int32 Resolution, const TArray<FFloat16Color>& Pixels)
+{
+	int32 UncompressedSize = Pixels.Num() * sizeof(FFloat16Color);
+
+	if (Pixels.Num() != Resolution * Resolution) return false;
+
+	TArray<uint8> CompressedPixels;
+
+	if (!CompressPixels(Pixels, CompressedPixels)) return false;
+
+	uint32 Magic = FileMagic, Version = FileVersion;
+	FString StoredKey = Key;
+	int32 StoredResolution = Resolution;
+	uint32 Crc = FCrc::MemCrc32(Pixels.GetData(), UncompressedSize);
+
+	TArray<uint8> FileData;
+	FMemoryWriter Writer(FileData);
+
+	Writer << Magic << Version << StoredKey << StoredResolution << UncompressedSize << Crc << CompressedPixels;
+
+	return FFileHelper::SaveArrayToFile(FileData, *GetFilePath(Key));
+}
+
+FString FHeatmapBakeCache::CacheFolderPath()
+{
+	return UJsonParser::CacheFolderPath() + "BakedHeatmaps/";
+}
+
+void FHeatmapBakeCache::Trim(const int64 MaxSize)
+{
+	struct FBakeFile
+	{
+		FString FilePath;
+		FDateTime LastUsed;
+		int64 Size;
+	};
+
+	TArray<FBakeFile> BakeFiles;
+	int64 TotalSize = 0;
+
+	IFileManager::Get().IterateDirectoryStat(*CacheFolderPath(), [&](const TCHAR* FilePath, const FFileStatData& StatData)
+	{
+		if (!StatData.bIsDirectory && FPaths::GetExtension(FilePath) == TEXT("hmb"))
+		{
+			BakeFiles.Add({ FilePath, StatData.ModificationTime, StatData.FileSize });
+			TotalSize += StatData.FileSize;
+		}
+
+		return true;
+	});
+
+	if (TotalSize <= MaxSize) return;
+
+	BakeFiles.Sort([](const FBakeFile& A, const FBakeFile& B) { return A.LastUsed < B.LastUsed; });
+
+	for (const FBakeFile& BakeFile : BakeFiles)
+	{
+		if (TotalSize <= MaxSize) break;
+
+		if (IFileManager::Get().Delete(*BakeFile.FilePath, false, false, true))
+			TotalSize -= BakeFile.Size;
+	}
+}
+
+bool FHeatmapBakeCache::CompressPixels(const TArray<FFloat16Color>& Pixels, TArray<uint8>& OutCompressed)
+{
+	const int32 UncompressedSize = Pixels.Num() * sizeof(FFloat16Color);
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Oodle, UncompressedSize);
+
+	OutCompressed.SetNumUninitialized(CompressedSize);
+
+	if (!FCompression::CompressMemory(NAME_Oodle, OutCompressed.GetData(), CompressedSize,
+		Pixels.GetData(), UncompressedSize))
+		return false;
+
+	OutCompressed.SetNum(CompressedSize);
+
+	return true;
+}
+
+bool FHeatmapBakeCache::UncompressPixels(const TArray<uint8>& Compressed, const int32 NumPixels,
+	TArray<FFloat16Color>& OutPixels)
+{
+	OutPixels.SetNumUninitialized(NumPixels);
+
+	return FCompression::UncompressMemory(NAME_Oodle, OutPixels.GetData(), NumPixels * sizeof(FFloat16Color),
+		Compressed.GetData(), Compressed.Num());
+}
+
+FString FHeatmapBakeCache::GetFilePath(const FString& Key)
+{
+	return CacheFolderPath() + FMD5::HashAnsiString(*Key) + ".hmb";
+}
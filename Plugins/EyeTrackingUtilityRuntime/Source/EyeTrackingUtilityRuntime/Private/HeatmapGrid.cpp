@@ -0,0 +1,757 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "HeatmapGrid.h"
+
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#include "HeatmapReadyActor.h"
+#include "HeatmapUvLookupCache.h"
+
+void FHeatmapGrid::Init(const int32 InResolution)
+{
+	Resolution = FMath::Max(InResolution, 1);
+	Values.SetNumZeroed(Resolution * Resolution);
+}
+
+void FHeatmapGrid::Reset()
+{
+	FMemory::Memzero(Values.GetData(), Values.Num() * sizeof(float));
+}
+
+void FHeatmapGrid::Splat(const FVector2D& Uv, const FVector2D& ScaleDivisor, const float BrushRadius,
+	const float Weight)
+{
+	const double RadiusU = BrushRadius / FMath::Max(FMath::Abs(ScaleDivisor.X), KINDA_SMALL_NUMBER);
+	const double RadiusV = BrushRadius / FMath::Max(FMath::Abs(ScaleDivisor.Y), KINDA_SMALL_NUMBER);
+
+	const int32 MinX = FMath::Max(FMath::FloorToInt32((Uv.X - RadiusU) * Resolution), 0);
+	const int32 MaxX = FMath::Min(FMath::CeilToInt32((Uv.X + RadiusU) * Resolution), Resolution - 1);
+	const int32 MinY = FMath::Max(FMath::FloorToInt32((Uv.Y - RadiusV) * Resolution), 0);
+	const int32 MaxY = FMath::Min(FMath::CeilToInt32((Uv.Y + RadiusV) * Resolution), Resolution - 1);
+
+	// Sigma is half the radius, so the brush has faded to ~13% at its edge
+	constexpr double InverseTwoSigmaSquared = 1.0 / (2.0 * 0.5 * 0.5);
+
+	for (int32 y = MinY; y <= MaxY; ++y)
+	{
+		const double Dv = ((y + 0.5) / Resolution - Uv.Y) / RadiusV;
+
+		for (int32 x = MinX; x <= MaxX; ++x)
+		{
+			const double Du = ((x + 0.5) / Resolution - Uv.X) / RadiusU;
+			const double DistanceSquared = Du * Du + Dv * Dv;
+
+			if (DistanceSquared > 1.0) continue;
+
+			Values[y * Resolution + x] += Weight * FMath::Exp(-DistanceSquared * InverseTwoSigmaSquared);
+		}
+	}
+}
+
+FVector2D FHeatmapGrid::WeightScaleDivisor(const FVector2D& ScaleDivisor, const float Weight)
+{
+	if (Weight == 1.f) return ScaleDivisor;
+
+	return ScaleDivisor / FMath::Sqrt(FMath::Max(Weight, KINDA_SMALL_NUMBER));
+}
+
+void FHeatmapGrid::Add(const FHeatmapGrid& Other, const float Weight)
+{
+	if (Other.Values.Num() != Values.Num()) return;
+
+	for (int32 i = 0; i < Values.Num(); ++i)
+		Values[i] += Other.Values[i] * Weight;
+}
+
+float FHeatmapGrid::GetMax() const
+{
+	float Max = 0.f;
+
+	for (const float Value : Values)
+		Max = FMath::Max(Max, Value);
+
+	return Max;
+}
+
+void FHeatmapGrid::ToColors(TArray<FColor>& OutColors, const float NormalizeMax) const
+{
+	static const FLinearColor Ramp[] =
+	{
+		FLinearColor(0.f, 0.f, 1.f, 0.f),
+		FLinearColor(0.f, 1.f, 1.f, 0.5f),
+		FLinearColor(0.f, 1.f, 0.f, 0.75f),
+		FLinearColor(1.f, 1.f, 0.f, 0.9f),
+		FLinearColor(1.f, 0.f, 0.f, 1.f)
+	};
+
+	constexpr int32 LastRampIndex = UE_ARRAY_COUNT(Ramp) - 1;
+
+	const float InverseMax = NormalizeMax > 0.f ? 1.f / NormalizeMax : 0.f;
+
+	OutColors.SetNumUninitialized(Values.Num());
+
+	for (int32 i = 0; i < Values.Num(); ++i)
+	{
+		const float Position = FMath::Clamp(Values[i] * InverseMax, 0.f, 1.f) * LastRampIndex;
+		const int32 RampIndex = FMath::Min(FMath::FloorToInt32(Position), LastRampIndex - 1);
+
+		OutColors[i] = FMath::Lerp(Ramp[RampIndex], Ramp[RampIndex + 1], Position - RampIndex).ToFColor(true);
+	}
+}
+
+// Bilinear resampling to the render target size, PixelFromValue maps a grid value to a pixel
+template <typename PixelFunctionType>
+static void ResampleToPixels(const FHeatmapGrid& Grid, TArray<FFloat16Color>& OutPixels, const int32 TargetResolution,
+	PixelFunctionType PixelFromValue)
+{
+	const int32 Resolution = Grid.Resolution;
+	const TArray<float>& Values = Grid.Values;
+
+	OutPixels.SetNumUninitialized(TargetResolution * TargetResolution);
+
+	if (Resolution <= 0)
+	{
+		FMemory::Memzero(OutPixels.GetData(), OutPixels.Num() * sizeof(FFloat16Color));
+		return;
+	}
+
+	const float SourceStep = static_cast<float>(Resolution) / TargetResolution;
+
+	ParallelFor(TargetResolution, [&](const int32 y)
+	{
+		const float SourceY = FMath::Clamp((y + 0.5f) * SourceStep - 0.5f, 0.f, Resolution - 1.f);
+		const int32 Y0 = FMath::FloorToInt32(SourceY);
+		const int32 Y1 = FMath::Min(Y0 + 1, Resolution - 1);
+		const float FractionY = SourceY - Y0;
+
+		for (int32 x = 0; x < TargetResolution; ++x)
+		{
+			const float SourceX = FMath::Clamp((x + 0.5f) * SourceStep - 0.5f, 0.f, Resolution - 1.f);
+			const int32 X0 = FMath::FloorToInt32(SourceX);
+			const int32 X1 = FMath::Min(X0 + 1, Resolution - 1);
+			const float FractionX = SourceX - X0;
+
+			const float Top = FMath::Lerp(Values[Y0 * Resolution + X0], Values[Y0 * Resolution + X1], FractionX);
+			const float Bottom = FMath::Lerp(Values[Y1 * Resolution + X0], Values[Y1 * Resolution + X1], FractionX);
+
+			OutPixels[y * TargetResolution + x] = PixelFromValue(FMath::Lerp(Top, Bottom, FractionY));
+		}
+	});
+}
+
+void FHeatmapGrid::ToRenderTargetPixels(TArray<FFloat16Color>& OutPixels, const int32 TargetResolution,
+	const float Scale) const
+{
+	ResampleToPixels(*this, OutPixels, TargetResolution, [Scale](const float Value)
+	{
+		// Running sums can drift slightly below zero after buckets are subtracted
+		const float Intensity = FMath::Clamp(Value * Scale, 0.f, 1.f);
+
+		return FFloat16Color(FLinearColor(Intensity, Intensity, Intensity, Intensity));
+	});
+}
+
+FLinearColor FHeatmapGrid::GetDivergingColor(const float SignedValue)
+{
+	static const FLinearColor Negative(0.f, 0.2f, 1.f, 1.f);
+	static const FLinearColor Neutral(1.f, 1.f, 1.f, 0.f);
+	static const FLinearColor Positive(1.f, 0.1f, 0.f, 1.f);
+
+	const float Clamped = FMath::Clamp(SignedValue, -1.f, 1.f);
+
+	return Clamped < 0.f ? FMath::Lerp(Neutral, Negative, -Clamped) : FMath::Lerp(Neutral, Positive, Clamped);
+}
+
+void FHeatmapGrid::ToDivergingColors(TArray<FColor>& OutColors, const float NormalizeMax) const
+{
+	const float InverseMax = NormalizeMax > 0.f ? 1.f / NormalizeMax : 0.f;
+
+	OutColors.SetNumUninitialized(Values.Num());
+
+	for (int32 i = 0; i < Values.Num(); ++i)
+		OutColors[i] = GetDivergingColor(Values[i] * InverseMax).ToFColor(true);
+}
+
+void FHeatmapGrid::ToDivergingRenderTargetPixels(TArray<FFloat16Color>& OutPixels, const int32 TargetResolution,
+	const float Scale) const
+{
+	ResampleToPixels(*this, OutPixels, TargetResolution, [Scale](const float Value)
+	{
+		const float Intensity = 0.5f + 0.5f * FMath::Clamp(Value * Scale, -1.f, 1.f);
+
+		return FFloat16Color(FLinearColor(Intensity, Intensity, Intensity, Intensity));
+	});
+}
+
+float FHeatmapGrid::GetMaxAbs() const
+{
+	float Max = 0.f;
+
+	for (const float Value : Values)
+		Max = FMath::Max(Max, FMath::Abs(Value));
+
+	return Max;
+}
+
+FHeatmapGridStats FHeatmapGrid::ComputeStats(const TArray<float>* TexelAreas) const
+{
+	return ComputeStats({ this }, { TexelAreas });
+}
+
+FHeatmapGridStats FHeatmapGrid::ComputeStats(const TArray<const FHeatmapGrid*>& Grids,
+	TArray<const TArray<float>*> TexelAreas)
+{
+	FHeatmapGridStats Stats;
+
+	TexelAreas.SetNumZeroed(Grids.Num());
+
+	// Rows of all grids in one list, so small grids still spread over the workers
+	TArray<TPair<int32, int32>> RowsToReduce;
+
+	for (int32 GridIndex = 0; GridIndex < Grids.Num(); ++GridIndex)
+	{
+		const FHeatmapGrid& Grid = *Grids[GridIndex];
+
+		if (TexelAreas[GridIndex] && TexelAreas[GridIndex]->Num() != Grid.Values.Num())
+			TexelAreas[GridIndex] = nullptr;
+
+		for (int32 y = 0; y < Grid.Resolution && !Grid.Values.IsEmpty(); ++y)
+			RowsToReduce.Emplace(GridIndex, y);
+	}
+
+	if (RowsToReduce.IsEmpty()) return Stats;
+
+	// Mass is attention density times area; entropies use H = ln(Sum) - Sum(x ln x) / Sum, so one pass is enough
+	struct FRowSums
+	{
+		double Area = 0.0;
+		double AreaLogArea = 0.0;
+		double CoveredArea = 0.0;
+		double Mass = 0.0;
+		double MassLogMass = 0.0;
+		double MassU = 0.0;
+		double MassV = 0.0;
+		double MassUU = 0.0;
+		double MassVV = 0.0;
+		double MassUV = 0.0;
+		float Peak = 0.f;
+	};
+
+	TArray<FRowSums> Rows;
+	Rows.SetNum(RowsToReduce.Num());
+
+	ParallelFor(RowsToReduce.Num(), [&Grids, &TexelAreas, &RowsToReduce, &Rows](const int32 RowIndex)
+	{
+		FRowSums& Row = Rows[RowIndex];
+
+		const int32 GridIndex = RowsToReduce[RowIndex].Key;
+		const int32 y = RowsToReduce[RowIndex].Value;
+
+		const int32 Resolution = Grids[GridIndex]->Resolution;
+		const TArray<float>& Values = Grids[GridIndex]->Values;
+		const TArray<float>* GridTexelAreas = TexelAreas[GridIndex];
+
+		const double V = (y + 0.5) / Resolution;
+
+		for (int32 x = 0; x < Resolution; ++x)
+		{
+			const int32 i = y * Resolution + x;
+			const double Area = GridTexelAreas ? (*GridTexelAreas)[i] : 1.0;
+
+			if (Area <= 0.0) continue;
+
+			Row.Area += Area;
+			Row.AreaLogArea += Area * FMath::Loge(Area);
+
+			if (Values[i] <= 0.f) continue;
+
+			const double U = (x + 0.5) / Resolution;
+			const double Mass = Values[i] * Area;
+
+			Row.CoveredArea += Area;
+			Row.Mass += Mass;
+			Row.MassLogMass += Mass * FMath::Loge(Mass);
+			Row.MassU += Mass * U;
+			Row.MassV += Mass * V;
+			Row.MassUU += Mass * U * U;
+			Row.MassVV += Mass * V * V;
+			Row.MassUV += Mass * U * V;
+			Row.Peak = FMath::Max(Row.Peak, Values[i]);
+		}
+	});
+
+	FRowSums Sums;
+
+	for (const FRowSums& Row : Rows)
+	{
+		Sums.Area += Row.Area;
+		Sums.AreaLogArea += Row.AreaLogArea;
+		Sums.CoveredArea += Row.CoveredArea;
+		Sums.Mass += Row.Mass;
+		Sums.MassLogMass += Row.MassLogMass;
+		Sums.MassU += Row.MassU;
+		Sums.MassV += Row.MassV;
+		Sums.MassUU += Row.MassUU;
+		Sums.MassVV += Row.MassVV;
+		Sums.MassUV += Row.MassUV;
+		Sums.Peak = FMath::Max(Sums.Peak, Row.Peak);
+	}
+
+	Stats.Peak = Sums.Peak;
+
+	if (Sums.Area <= 0.0 || Sums.Mass <= 0.0) return Stats;
+
+	Stats.Coverage = Sums.CoveredArea / Sums.Area;
+
+	const FVector2D Centroid(Sums.MassU / Sums.Mass, Sums.MassV / Sums.Mass);
+
+	Stats.Centroid = Centroid;
+	Stats.Variance = FVector2D(FMath::Max(Sums.MassUU / Sums.Mass - Centroid.X * Centroid.X, 0.0),
+		FMath::Max(Sums.MassVV / Sums.Mass - Centroid.Y * Centroid.Y, 0.0));
+	Stats.Covariance = Sums.MassUV / Sums.Mass - Centroid.X * Centroid.Y;
+
+	const double Entropy = FMath::Loge(Sums.Mass) - Sums.MassLogMass / Sums.Mass;
+	const double MaxEntropy = FMath::Loge(Sums.Area) - Sums.AreaLogArea / Sums.Area;
+
+	Stats.Entropy = MaxEntropy > 0.0 ? FMath::Clamp(Entropy / MaxEntropy, 0.0, 1.0) : 0.f;
+
+	return Stats;
+}
+
+void FHeatmapGrid::ComputeTexelAreas(const FHeatmapUvTriangleTable& Table, const FVector& Scale,
+	const int32 Resolution, TArray<float>& OutTexelAreas)
+{
+	OutTexelAreas.Reset();
+	OutTexelAreas.SetNumZeroed(Resolution * Resolution);
+
+	const double TexelUvArea = 1.0 / (static_cast<double>(Resolution) * Resolution);
+	const int32 TrianglesNum = Table.Indices.Num() / 3;
+
+	for (int32 Triangle = 0; Triangle < TrianglesNum; ++Triangle)
+	{
+		const uint32 I0 = Table.Indices[Triangle * 3];
+		const uint32 I1 = Table.Indices[Triangle * 3 + 1];
+		const uint32 I2 = Table.Indices[Triangle * 3 + 2];
+
+		const FVector P0 = FVector(Table.Positions[I0]) * Scale;
+		const FVector P1 = FVector(Table.Positions[I1]) * Scale;
+		const FVector P2 = FVector(Table.Positions[I2]) * Scale;
+
+		const FVector2D Uv0(Table.Uvs[I0]), Uv1(Table.Uvs[I1]), Uv2(Table.Uvs[I2]);
+		const double Denominator = (Uv1.Y - Uv2.Y) * (Uv0.X - Uv2.X) + (Uv2.X - Uv1.X) * (Uv0.Y - Uv2.Y);
+
+		if (FMath::IsNearlyZero(Denominator)) continue;
+
+		// Surface area per unit of UV area is constant across a triangle
+		const double SurfaceArea = 0.5 * ((P1 - P0) ^ (P2 - P0)).Size();
+		const float AreaPerTexel = SurfaceArea / (0.5 * FMath::Abs(Denominator)) * TexelUvArea;
+
+		FBox2D UvBounds(ForceInit);
+		UvBounds += Uv0;
+		UvBounds += Uv1;
+		UvBounds += Uv2;
+
+		const int32 MinX = FMath::Clamp(FMath::FloorToInt32(UvBounds.Min.X * Resolution), 0, Resolution - 1);
+		const int32 MaxX = FMath::Clamp(FMath::FloorToInt32(UvBounds.Max.X * Resolution), 0, Resolution - 1);
+		const int32 MinY = FMath::Clamp(FMath::FloorToInt32(UvBounds.Min.Y * Resolution), 0, Resolution - 1);
+		const int32 MaxY = FMath::Clamp(FMath::FloorToInt32(UvBounds.Max.Y * Resolution), 0, Resolution - 1);
+
+		for (int32 y = MinY; y <= MaxY; ++y)
+		{
+			for (int32 x = MinX; x <= MaxX; ++x)
+			{
+				const FVector2D TexelCenter((x + 0.5) / Resolution, (y + 0.5) / Resolution);
+
+				const double B0 = ((Uv1.Y - Uv2.Y) * (TexelCenter.X - Uv2.X) + (Uv2.X - Uv1.X) * (TexelCenter.Y - Uv2.Y)) / Denominator;
+				const double B1 = ((Uv2.Y - Uv0.Y) * (TexelCenter.X - Uv2.X) + (Uv0.X - Uv2.X) * (TexelCenter.Y - Uv2.Y)) / Denominator;
+
+				if (B0 < 0.0 || B1 < 0.0 || B0 + B1 > 1.0) continue;
+
+				OutTexelAreas[y * Resolution + x] += AreaPerTexel;
+			}
+		}
+	}
+}
+
+void FHeatmapGrid::SignedDifference(const FHeatmapGrid* A, const float ScaleA, const FHeatmapGrid* B,
+	const float ScaleB, FHeatmapGrid& OutDifference)
+{
+	const int32 Resolution = A ? A->Resolution : B ? B->Resolution : 0;
+
+	OutDifference.Init(Resolution);
+
+	if ((A && A->Values.Num() != OutDifference.Values.Num()) || (B && B->Values.Num() != OutDifference.Values.Num()))
+		return;
+
+	// An actor only one side looked at differs by that side's grid alone
+	const float* ValuesA = A ? A->Values.GetData() : nullptr;
+	const float* ValuesB = B ? B->Values.GetData() : nullptr;
+	float* Difference = OutDifference.Values.GetData();
+
+	const int32 Num = OutDifference.Values.Num();
+	const int32 VectorNum = Num & ~3;
+
+	const VectorRegister4Float VectorScaleA = VectorSetFloat1(ScaleA);
+	const VectorRegister4Float VectorScaleB = VectorSetFloat1(ScaleB);
+
+	for (int32 i = 0; i < VectorNum; i += 4)
+	{
+		const VectorRegister4Float WeightedA = ValuesA ? VectorMultiply(VectorLoad(ValuesA + i), VectorScaleA) : VectorZero();
+		const VectorRegister4Float WeightedB = ValuesB ? VectorMultiply(VectorLoad(ValuesB + i), VectorScaleB) : VectorZero();
+
+		VectorStore(VectorSubtract(WeightedA, WeightedB), Difference + i);
+	}
+
+	for (int32 i = VectorNum; i < Num; ++i)
+		Difference[i] = (ValuesA ? ValuesA[i] * ScaleA : 0.f) - (ValuesB ? ValuesB[i] * ScaleB : 0.f);
+}
+
+FHeatmapAccumulator::FHeatmapAccumulator(const int32 InResolution, const float InBrushRadius)
+	: Resolution(InResolution),
+	  BrushRadius(InBrushRadius)
+{
+}
+
+void FHeatmapAccumulator::SetScaleDivisors(const FGuid& ActorGuid, const TArray<FVector2D>& ScaleDivisors)
+{
+	ScaleDivisorsByActor.Add(ActorGuid, ScaleDivisors);
+}
+
+void FHeatmapAccumulator::SetScaleDivisors(const AHeatmapReadyActor* HeatmapReadyActor)
+{
+	if (!HeatmapReadyActor) return;
+
+	TArray<FVector2D> ScaleDivisors;
+
+	for (int32 i = 0; i < static_cast<int32>(EHeatmapFaceAxis::EHFA_MAX); ++i)
+		ScaleDivisors.Add(HeatmapReadyActor->GetPaintBrushScaleDivisor(static_cast<EHeatmapFaceAxis>(i)));
+
+	SetScaleDivisors(HeatmapReadyActor->HeatmapActorGuid, ScaleDivisors);
+}
+
+void FHeatmapAccumulator::Accumulate(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	const float Weight)
+{
+	TMap<FGuid, TArray<int32>> DataIndicesByActor;
+
+	for (int32 i = 0; i < AttentionTrackingData.Num(); ++i)
+	{
+		if (AttentionTrackingData[i].ActorGuid.IsValid())
+			DataIndicesByActor.FindOrAdd(AttentionTrackingData[i].ActorGuid).Add(i);
+	}
+
+	// Grids are added up front, so the pointers stay stable while the workers paint
+	TArray<FHeatmapGrid*> ActorGrids;
+	TArray<const TArray<int32>*> ActorDataIndices;
+
+	for (const TPair<FGuid, TArray<int32>>& Entry : DataIndicesByActor)
+	{
+		FHeatmapGrid& Grid = Grids.FindOrAdd(Entry.Key);
+
+		if (Grid.Resolution != Resolution)
+			Grid.Init(Resolution);
+
+		ActorGrids.Add(&Grid);
+		ActorDataIndices.Add(&Entry.Value);
+	}
+
+	ParallelFor(ActorGrids.Num(), [&](const int32 ActorIndex)
+	{
+		for (const int32 DataIndex : *ActorDataIndices[ActorIndex])
+		{
+			const FAttentionTrackingDataPoint& DataPoint = AttentionTrackingData[DataIndex];
+
+			// A run stands for SampleCount frames painted at the same spot
+			ActorGrids[ActorIndex]->Splat(DataPoint.Coordinates, FHeatmapGrid::WeightScaleDivisor(
+				GetScaleDivisor(DataPoint.ActorGuid, DataPoint.FaceAxis), DataPoint.Weight),
+				BrushRadius, Weight * DataPoint.SampleCount);
+		}
+	});
+}
+
+void FHeatmapAccumulator::AccumulateComposite(const TArray<const TArray<FAttentionTrackingDataPoint>*>& Sessions,
+	const bool bNormalizePerParticipant)
+{
+	struct FChunk
+	{
+		int32 SessionIndex;
+		int32 Begin;
+		int32 End;
+	};
+
+	constexpr int32 ChunkSize = 1024;
+
+	TArray<float> SessionWeights;
+	TArray<FChunk> Chunks;
+
+	for (int32 SessionIndex = 0; SessionIndex < Sessions.Num(); ++SessionIndex)
+	{
+		const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData = *Sessions[SessionIndex];
+
+		int64 SampleCount = 0;
+
+		for (const FAttentionTrackingDataPoint& DataPoint : AttentionTrackingData)
+			SampleCount += DataPoint.SampleCount;
+
+		SessionWeights.Add(bNormalizePerParticipant && SampleCount > 0 ? 1.f / SampleCount : 1.f);
+
+		for (int32 Begin = 0; Begin < AttentionTrackingData.Num(); Begin += ChunkSize)
+			Chunks.Add({ SessionIndex, Begin, FMath::Min(Begin + ChunkSize, AttentionTrackingData.Num()) });
+	}
+
+	if (Chunks.IsEmpty()) return;
+
+	// One set of partial grids per worker, chunks are striped across them
+	const int32 NumPartials = FMath::Min(Chunks.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+
+	TArray<TMap<FGuid, FHeatmapGrid>> Partials;
+	Partials.SetNum(NumPartials);
+
+	ParallelFor(NumPartials, [&](const int32 PartialIndex)
+	{
+		TMap<FGuid, FHeatmapGrid>& PartialGrids = Partials[PartialIndex];
+
+		for (int32 ChunkIndex = PartialIndex; ChunkIndex < Chunks.Num(); ChunkIndex += NumPartials)
+		{
+			const FChunk& Chunk = Chunks[ChunkIndex];
+			const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData = *Sessions[Chunk.SessionIndex];
+			const float Weight = SessionWeights[Chunk.SessionIndex];
+
+			for (int32 i = Chunk.Begin; i < Chunk.End; ++i)
+			{
+				const FAttentionTrackingDataPoint& DataPoint = AttentionTrackingData[i];
+
+				if (!DataPoint.ActorGuid.IsValid()) continue;
+
+				FHeatmapGrid& Grid = PartialGrids.FindOrAdd(DataPoint.ActorGuid);
+
+				if (Grid.Resolution != Resolution)
+					Grid.Init(Resolution);
+
+				Grid.Splat(DataPoint.Coordinates, FHeatmapGrid::WeightScaleDivisor(
+					GetScaleDivisor(DataPoint.ActorGuid, DataPoint.FaceAxis), DataPoint.Weight),
+					BrushRadius, Weight * DataPoint.SampleCount);
+			}
+		}
+	});
+
+	// Reduce per actor, in parallel across actors
+	TSet<FGuid> ActorGuidSet;
+
+	for (const TMap<FGuid, FHeatmapGrid>& PartialGrids : Partials)
+	{
+		for (const TPair<FGuid, FHeatmapGrid>& PartialGrid : PartialGrids)
+		{
+			FHeatmapGrid& Grid = Grids.FindOrAdd(PartialGrid.Key);
+
+			if (Grid.Resolution != Resolution)
+				Grid.Init(Resolution);
+
+			ActorGuidSet.Add(PartialGrid.Key);
+		}
+	}
+
+	const TArray<FGuid> ActorGuids = ActorGuidSet.Array();
+	TArray<FHeatmapGrid*> ActorGrids;
+
+	// Pointers only once the map stops growing
+	for (const FGuid& ActorGuid : ActorGuids)
+		ActorGrids.Add(&Grids.FindChecked(ActorGuid));
+
+	ParallelFor(ActorGuids.Num(), [&](const int32 ActorIndex)
+	{
+		for (const TMap<FGuid, FHeatmapGrid>& PartialGrids : Partials)
+		{
+			if (const FHeatmapGrid* PartialGrid = PartialGrids.Find(ActorGuids[ActorIndex]))
+				ActorGrids[ActorIndex]->Add(*PartialGrid);
+		}
+	});
+}
+
+void FHeatmapAccumulator::Reset()
+{
+	Grids.Empty();
+}
+
+FVector2D FHeatmapAccumulator::GetScaleDivisor(const FGuid& ActorGuid, const EHeatmapFaceAxis FaceAxis) const
+{
+	const TArray<FVector2D>* ScaleDivisors = ScaleDivisorsByActor.Find(ActorGuid);
+	const int32 Index = static_cast<int32>(FaceAxis);
+
+	return ScaleDivisors && ScaleDivisors->IsValidIndex(Index) ? (*ScaleDivisors)[Index] : FVector2D(1.0, 1.0);
+}
+
+FHeatmapTemporalAccumulator::FHeatmapTemporalAccumulator(const EHeatmapAccumulationMode InMode, const float InSeconds,
+	const int32 InResolution, const float InBrushRadius)
+	: Mode(InMode),
+	  Seconds(FMath::Max(InSeconds, KINDA_SMALL_NUMBER)),
+	  Resolution(InResolution),
+	  BrushRadius(InBrushRadius)
+{
+}
+
+void FHeatmapTemporalAccumulator::AddSample(const FGuid& ActorGuid, const float Time, const FVector2D& Uv,
+	const FVector2D& ScaleDivisor, const float Weight)
+{
+	if (Mode == EHeatmapAccumulationMode::EHAM_ExponentialDecay)
+	{
+		// Keep the pre-scaling exponent small enough for floats
+		if ((Time - DecayReferenceTime) / Seconds > 30.f)
+			RebaseDecay(Time);
+
+		FHeatmapGrid& Grid = DecayGrids.FindOrAdd(ActorGuid);
+
+		if (Grid.Resolution != Resolution)
+			Grid.Init(Resolution);
+
+		Grid.Splat(Uv, ScaleDivisor, BrushRadius, Weight * FMath::Exp((Time - DecayReferenceTime) / Seconds));
+
+		float& LastSampleTime = LastSampleTimes.FindOrAdd(ActorGuid, Time);
+		LastSampleTime = FMath::Max(LastSampleTime, Time);
+
+		DirtyGrids.Add(ActorGuid);
+		LiveGrids.Add(ActorGuid);
+		return;
+	}
+
+	const float BucketDuration = Seconds / NumBuckets;
+	const int64 Bucket = FMath::FloorToInt64(Time / BucketDuration);
+
+	if (Bucket > HeadBucket)
+		AdvanceTo(Time);
+
+	// Already out of the window
+	if (Bucket <= HeadBucket - NumBuckets) return;
+
+	TArray<FHeatmapGrid>& Buckets = WindowBuckets.FindOrAdd(ActorGuid);
+	FHeatmapGrid& Sum = WindowSums.FindOrAdd(ActorGuid);
+
+	if (Sum.Resolution != Resolution)
+	{
+		Buckets.SetNum(NumBuckets);
+
+		for (FHeatmapGrid& BucketGrid : Buckets)
+			BucketGrid.Init(Resolution);
+
+		Sum.Init(Resolution);
+	}
+
+	const int32 Slot = static_cast<int32>((Bucket % NumBuckets + NumBuckets) % NumBuckets);
+
+	Buckets[Slot].Splat(Uv, ScaleDivisor, BrushRadius, Weight);
+	Sum.Splat(Uv, ScaleDivisor, BrushRadius, Weight);
+
+	FilledBuckets.FindOrAdd(ActorGuid) |= 1 << Slot;
+	DirtyGrids.Add(ActorGuid);
+	LiveGrids.Add(ActorGuid);
+}
+
+void FHeatmapTemporalAccumulator::AdvanceTo(const float Time)
+{
+	if (Time <= CurrentTime) return;
+
+	CurrentTime = Time;
+
+	if (Mode == EHeatmapAccumulationMode::EHAM_ExponentialDecay)
+	{
+		if ((CurrentTime - DecayReferenceTime) / Seconds > 30.f)
+			RebaseDecay(CurrentTime);
+
+		for (auto It = LiveGrids.CreateIterator(); It; ++It)
+		{
+			if (CurrentTime <= LastSampleTimes.FindRef(*It) + GetHistorySpan()) continue;
+
+			DecayGrids.FindChecked(*It).Reset();
+			DirtyGrids.Add(*It);
+			It.RemoveCurrent();
+		}
+
+		return;
+	}
+
+	const int64 NewHeadBucket = FMath::FloorToInt64(CurrentTime / (Seconds / NumBuckets));
+
+	if (NewHeadBucket <= HeadBucket) return;
+
+	const int64 Steps = NewHeadBucket - HeadBucket;
+
+	for (auto It = LiveGrids.CreateIterator(); It; ++It)
+	{
+		TArray<FHeatmapGrid>& Buckets = WindowBuckets.FindChecked(*It);
+		FHeatmapGrid& Sum = WindowSums.FindChecked(*It);
+		uint8& Filled = FilledBuckets.FindChecked(*It);
+
+		for (int64 Bucket = HeadBucket + 1; Bucket <= NewHeadBucket && Filled != 0; ++Bucket)
+		{
+			const int32 Slot = static_cast<int32>((Bucket % NumBuckets + NumBuckets) % NumBuckets);
+
+			if (!(Filled & (1 << Slot))) continue;
+
+			Sum.Add(Buckets[Slot], -1.f);
+			Buckets[Slot].Reset();
+
+			Filled &= ~(1 << Slot);
+			DirtyGrids.Add(*It);
+		}
+
+		if (Filled != 0) continue;
+
+		// Everything left the window, start over instead of accumulating subtraction error
+		Sum.Reset();
+		It.RemoveCurrent();
+	}
+
+	HeadBucket = NewHeadBucket;
+}
+
+void FHeatmapTemporalAccumulator::Reset()
+{
+	WindowBuckets.Empty();
+	WindowSums.Empty();
+	FilledBuckets.Empty();
+	DecayGrids.Empty();
+	LastSampleTimes.Empty();
+	DirtyGrids.Empty();
+	LiveGrids.Empty();
+
+	HeadBucket = 0;
+	CurrentTime = 0.f;
+	DecayReferenceTime = 0.f;
+}
+
+float FHeatmapTemporalAccumulator::GetReadOutScale() const
+{
+	return Mode == EHeatmapAccumulationMode::EHAM_ExponentialDecay ?
+		FMath::Exp((DecayReferenceTime - CurrentTime) / Seconds) : 1.f;
+}
+
+float FHeatmapTemporalAccumulator::GetHistorySpan() const
+{
+	// After five time constants less than 1% is left
+	return Mode == EHeatmapAccumulationMode::EHAM_ExponentialDecay ? 5.f * Seconds : Seconds;
+}
+
+const TMap<FGuid, FHeatmapGrid>& FHeatmapTemporalAccumulator::GetGrids() const
+{
+	return Mode == EHeatmapAccumulationMode::EHAM_ExponentialDecay ? DecayGrids : WindowSums;
+}
+
+void FHeatmapTemporalAccumulator::ConsumeDirtyGrids(TSet<FGuid>& OutDirtyGrids)
+{
+	OutDirtyGrids = MoveTemp(DirtyGrids);
+	DirtyGrids.Reset();
+}
+
+void FHeatmapTemporalAccumulator::RebaseDecay(const float NewReferenceTime)
+{
+	const float Factor = FMath::Exp((DecayReferenceTime - NewReferenceTime) / Seconds);
+
+	for (TPair<FGuid, FHeatmapGrid>& Grid : DecayGrids)
+	{
+		for (float& Value : Grid.Value.Values)
+			Value *= Factor;
+	}
+
+	DecayReferenceTime = NewReferenceTime;
+}
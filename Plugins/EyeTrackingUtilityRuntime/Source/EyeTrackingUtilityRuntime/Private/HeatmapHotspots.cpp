@@ -0,0 +1,275 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "HeatmapHotspots.h"
+
+#include "Async/ParallelFor.h"
+
+#include "HeatmapRT.h"
+#include "GazePointCloud.h"
+
+void FHeatmapHotspotFinder::FindUvHotspots(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	const TMap<FString, FString>& MetricsNames, const FHeatmapHotspotSettings& Settings,
+	TArray<FHeatmapHotspot>& OutHotspots)
+{
+	OutHotspots.Reset();
+
+	if (AttentionTrackingData.IsEmpty() || Settings.UvRadius <= 0.f) return;
+
+	struct FActorSamples
+	{
+		const FAttentionTrackingDataPoint* FirstDataPoint = nullptr;
+		TArray<FSample> Samples;
+		TArray<FHeatmapHotspot> Hotspots;
+	};
+
+	TMap<FString, int32> ActorIndices;
+	TArray<FActorSamples> Actors;
+
+	for (int32 i = 0; i < AttentionTrackingData.Num(); ++i)
+	{
+		const FAttentionTrackingDataPoint& DataPoint = AttentionTrackingData[i];
+
+		// A run stands for its whole duration, a single sample for the time until the next one
+		float DwellTime = DataPoint.Duration + Settings.MaxSampleDwellTime;
+
+		if (AttentionTrackingData.IsValidIndex(i + 1))
+		{
+			DwellTime = FMath::Clamp(AttentionTrackingData[i + 1].TimePassedSinceRecordingStarted
+				- DataPoint.TimePassedSinceRecordingStarted, 0.f, DwellTime);
+		}
+
+		const FString Key = UHeatmapRT::GetMetricsKey(DataPoint);
+		int32* ActorIndex = ActorIndices.Find(Key);
+
+		if (!ActorIndex)
+		{
+			ActorIndex = &ActorIndices.Add(Key, Actors.AddDefaulted());
+			Actors[*ActorIndex].FirstDataPoint = &DataPoint;
+		}
+
+		Actors[*ActorIndex].Samples.Add({ FVector(DataPoint.Coordinates, 0.0),
+			DataPoint.TimePassedSinceRecordingStarted, DwellTime });
+	}
+
+	ParallelFor(Actors.Num(), [&Actors, &Settings](const int32 i)
+	{
+		FActorSamples& Actor = Actors[i];
+
+		TArray<int32> Labels;
+		const int32 ClustersNum = Cluster(Actor.Samples, Settings.UvRadius, Settings.MinDwellTime, true, Labels);
+
+		MakeHotspots(Actor.Samples, Labels, ClustersNum, EHeatmapHotspotSpace::EHHS_Uv, Actor.Hotspots);
+	});
+
+	for (const FActorSamples& Actor : Actors)
+	{
+		const FString* MetricsName = MetricsNames.Find(UHeatmapRT::GetMetricsKey(*Actor.FirstDataPoint));
+
+		for (const FHeatmapHotspot& Hotspot : Actor.Hotspots)
+		{
+			FHeatmapHotspot& NewHotspot = OutHotspots.Add_GetRef(Hotspot);
+			NewHotspot.Name = MetricsName ? *MetricsName : Actor.FirstDataPoint->ObjectName;
+			NewHotspot.ActorGuid = Actor.FirstDataPoint->ActorGuid;
+		}
+	}
+
+	RankHotspots(OutHotspots, Settings.MaxHotspots);
+}
+
+void FHeatmapHotspotFinder::FindWorldHotspots(const FGazePointCloud& GazePoints,
+	const FHeatmapHotspotSettings& Settings, TArray<FHeatmapHotspot>& OutHotspots)
+{
+	OutHotspots.Reset();
+
+	if (GazePoints.Num() == 0 || Settings.WorldRadius <= 0.f) return;
+
+	const TArray<FGazePoint>& Points = GazePoints.GetPoints();
+
+	TArray<FSample> Samples;
+	Samples.Reserve(Points.Num());
+
+	for (int32 i = 0; i < Points.Num(); ++i)
+	{
+		const float DwellTime = Points.IsValidIndex(i + 1) ?
+			FMath::Clamp(Points[i + 1].Time - Points[i].Time, 0.f, Settings.MaxSampleDwellTime) : 0.f;
+
+		Samples.Add({ Points[i].Location, Points[i].Time, DwellTime });
+	}
+
+	TArray<int32> Labels;
+	const int32 ClustersNum = Cluster(Samples, Settings.WorldRadius, Settings.MinDwellTime, false, Labels);
+
+	MakeHotspots(Samples, Labels, ClustersNum, EHeatmapHotspotSpace::EHHS_World, OutHotspots);
+	RankHotspots(OutHotspots, Settings.MaxHotspots);
+}
+
+void FHeatmapHotspotFinder::RankHotspots(TArray<FHeatmapHotspot>& Hotspots, const int32 MaxHotspots)
+{
+	Hotspots.Sort([](const FHeatmapHotspot& A, const FHeatmapHotspot& B)
+	{
+		return A.DwellTime > B.DwellTime;
+	});
+
+	if (MaxHotspots > 0 && Hotspots.Num() > MaxHotspots)
+		Hotspots.SetNum(MaxHotspots);
+
+	for (int32 i = 0; i < Hotspots.Num(); ++i)
+		Hotspots[i].Rank = i + 1;
+}
+
+int32 FHeatmapHotspotFinder::Cluster(const TArray<FSample>& Samples, const float Radius, const float MinDwellTime,
+	const bool bPlanar, TArray<int32>& OutLabels)
+{
+	const int32 SamplesNum = Samples.Num();
+	const double InvRadius = 1.0 / Radius;
+	const double RadiusSquared = FMath::Square(static_cast<double>(Radius));
+
+	auto GetCell = [InvRadius, bPlanar](const FVector& Location)
+	{
+		return FIntVector(FMath::FloorToInt(Location.X * InvRadius), FMath::FloorToInt(Location.Y * InvRadius),
+			bPlanar ? 0 : FMath::FloorToInt(Location.Z * InvRadius));
+	};
+
+	// Spatial hash as one sorted index array, each cell a contiguous range of it
+	TArray<FIntVector> SampleCells;
+	SampleCells.SetNumUninitialized(SamplesNum);
+
+	TMap<FIntVector, TPair<int32, int32>> CellRanges;
+
+	for (int32 i = 0; i < SamplesNum; ++i)
+	{
+		SampleCells[i] = GetCell(Samples[i].Location);
+		++CellRanges.FindOrAdd(SampleCells[i], TPair<int32, int32>(0, 0)).Value;
+	}
+
+	int32 CellStart = 0;
+
+	for (TPair<FIntVector, TPair<int32, int32>>& CellRange : CellRanges)
+	{
+		CellRange.Value.Key = CellStart;
+		CellStart += CellRange.Value.Value;
+		CellRange.Value.Value = 0;
+	}
+
+	TArray<int32> CellSamples;
+	CellSamples.SetNumUninitialized(SamplesNum);
+
+	for (int32 i = 0; i < SamplesNum; ++i)
+	{
+		TPair<int32, int32>& CellRange = CellRanges[SampleCells[i]];
+		CellSamples[CellRange.Key + CellRange.Value++] = i;
+	}
+
+	const int32 CellsZ = bPlanar ? 0 : 1;
+
+	auto ForEachNeighbour = [&](const int32 SampleIndex, auto&& Func)
+	{
+		const FIntVector& Cell = SampleCells[SampleIndex];
+		const FVector& Location = Samples[SampleIndex].Location;
+
+		for (int32 z = -CellsZ; z <= CellsZ; ++z)
+		for (int32 y = -1; y <= 1; ++y)
+		for (int32 x = -1; x <= 1; ++x)
+		{
+			const TPair<int32, int32>* CellRange = CellRanges.Find(Cell + FIntVector(x, y, z));
+
+			if (!CellRange) continue;
+
+			for (int32 i = CellRange->Key; i < CellRange->Key + CellRange->Value; ++i)
+			{
+				if (FVector::DistSquared(Samples[CellSamples[i]].Location, Location) <= RadiusSquared)
+					Func(CellSamples[i]);
+			}
+		}
+	};
+
+	// Densities only read the hash, so they are computed in parallel; the expansion below is sequential
+	TArray<bool> bCoreSamples;
+	bCoreSamples.SetNumZeroed(SamplesNum);
+
+	ParallelFor(SamplesNum, [&Samples, &bCoreSamples, &ForEachNeighbour, MinDwellTime](const int32 i)
+	{
+		float DwellTime = 0.f;
+
+		ForEachNeighbour(i, [&Samples, &DwellTime](const int32 Neighbour)
+		{
+			DwellTime += Samples[Neighbour].DwellTime;
+		});
+
+		bCoreSamples[i] = DwellTime >= MinDwellTime;
+	});
+
+	OutLabels.Init(INDEX_NONE, SamplesNum);
+
+	int32 ClustersNum = 0;
+	TArray<int32> Frontier;
+
+	for (int32 i = 0; i < SamplesNum; ++i)
+	{
+		if (!bCoreSamples[i] || OutLabels[i] != INDEX_NONE) continue;
+
+		OutLabels[i] = ClustersNum;
+		Frontier.Reset();
+		Frontier.Add(i);
+
+		while (!Frontier.IsEmpty())
+		{
+			ForEachNeighbour(Frontier.Pop(false), [&](const int32 Neighbour)
+			{
+				if (OutLabels[Neighbour] != INDEX_NONE) return;
+
+				// Border samples join the first hotspot that reaches them but don't extend it
+				OutLabels[Neighbour] = ClustersNum;
+
+				if (bCoreSamples[Neighbour])
+					Frontier.Add(Neighbour);
+			});
+		}
+
+		++ClustersNum;
+	}
+
+	return ClustersNum;
+}
+
+void FHeatmapHotspotFinder::MakeHotspots(const TArray<FSample>& Samples, const TArray<int32>& Labels,
+	const int32 ClustersNum, const EHeatmapHotspotSpace Space, TArray<FHeatmapHotspot>& OutHotspots)
+{
+	TArray<FBox> Bounds;
+	Bounds.Init(FBox(ForceInit), ClustersNum);
+
+	TArray<double> CentroidWeights;
+	CentroidWeights.SetNumZeroed(ClustersNum);
+
+	const int32 FirstHotspot = OutHotspots.Num();
+	OutHotspots.AddDefaulted(ClustersNum);
+
+	for (int32 i = 0; i < Samples.Num(); ++i)
+	{
+		if (Labels[i] == INDEX_NONE) continue;
+
+		const FSample& Sample = Samples[i];
+		FHeatmapHotspot& Hotspot = OutHotspots[FirstHotspot + Labels[i]];
+
+		// Samples without dwell time still pull the centroid a little
+		const double CentroidWeight = FMath::Max(Sample.DwellTime, KINDA_SMALL_NUMBER);
+
+		Hotspot.Centroid += Sample.Location * CentroidWeight;
+		CentroidWeights[Labels[i]] += CentroidWeight;
+		Hotspot.DwellTime += Sample.DwellTime;
+		++Hotspot.SampleCount;
+		Hotspot.Timestamps.Add(Sample.Time);
+
+		Bounds[Labels[i]] += Sample.Location;
+	}
+
+	for (int32 i = 0; i < ClustersNum; ++i)
+	{
+		FHeatmapHotspot& Hotspot = OutHotspots[FirstHotspot + i];
+
+		Hotspot.Centroid /= CentroidWeights[i];
+		Hotspot.Extent = Bounds[i].GetExtent();
+		Hotspot.Space = Space;
+		Hotspot.Timestamps.Sort();
+	}
+}
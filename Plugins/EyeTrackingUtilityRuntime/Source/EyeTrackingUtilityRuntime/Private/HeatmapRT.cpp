@@ -6,49 +6,107 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Materials/MaterialParameterCollection.h"
 #include "Materials/MaterialParameterCollectionInstance.h"
+#include "Camera/CameraComponent.h"
+#include "SceneManagement.h"
+#include "HAL/FileManager.h"
 
 #include "HeatmapReadyActor.h"
+#include "HeatmapActorRegistry.h"
+#include "HeatmapGrid.h"
+#include "HeatmapSessionSubsystem.h"
+#include "HeatmapVisibility.h"
+#include "GazeRayStream.h"
+#include "GazeReprojection.h"
 #include "JsonParser.h"
 #include "DebugHeader.h"
 
-AHeatmapReadyActor* UHeatmapRT::LastActorPaintedOn = nullptr;
-TArray<AHeatmapReadyActor*> UHeatmapRT::HeatmapReadyActors;
 FString UHeatmapRT::LastSavedOrLoadedHeatmapFileName = "";
-TArray<FAttentionTrackingDataPoint> UHeatmapRT::AttentionTrackingDataCurrentlyLoaded;
-TMap<FString, FAttentionMetricsEntry> UHeatmapRT::AttentionMetrics;
-
-TArray<FTimerHandle> UHeatmapRT::HeatmapTimerHandles;
-TMap<FName, FTimerHandle> UHeatmapRT::BlendParameterTimerHandles; 
+FOnHeatmapSaved UHeatmapRT::OnHeatmapSaved;
 
 void UHeatmapRT::SaveHeatmap(const FString& FileName, const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData)
+{
+	if (WriteHeatmap(UJsonParser::AttentionTrackingDataFolderPath() + FileName, AttentionTrackingData))
+		OnHeatmapSaved.Broadcast(FileName);
+}
+
+bool UHeatmapRT::WriteHeatmap(const FString& FilePath, const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData)
 {
 	bool bOutSuccess = false;
-	FString FilePath = UJsonParser::AttentionTrackingDataFolderPath();
-	FilePath.Append(FileName);
 
-	UJsonParser::WriteAttentionTrackingDataToJsonFile(AttentionTrackingData, FilePath, bOutSuccess);
+	TArray<FAttentionTrackingDataPoint> CompressedData = AttentionTrackingData;
+	CompressAttentionTrackingData(CompressedData);
+
+	UJsonParser::WriteAttentionTrackingDataToJsonFile(CompressedData, FilePath, bOutSuccess);
 	
 	DebugHeader::ShowNotifyInfoIf(!bOutSuccess, "Failed to save heatmap to " + FilePath);
+
+	return bOutSuccess;
 }
 
 void UHeatmapRT::LoadHeatmap(const FString& FileName, const UObject* WorldContextObject, const float MetricsThreshold)
 {
-	bool bOutSuccess;
-	FString FilePath = UJsonParser::AttentionTrackingDataFolderPath();
-	FilePath.Append(FileName);
-	
-	UJsonParser::ReadAttentionTrackingDataFromJsonFile(FilePath,
-		AttentionTrackingDataCurrentlyLoaded, bOutSuccess);
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
 
-	if (!bOutSuccess)
+	if (!SessionSubsystem)
 	{
-		DebugHeader::ShowNotifyInfo("Failed to load heatmap from " + FilePath);
+		DebugHeader::PrintError("UHeatmapRT::LoadHeatmap: HeatmapSessionSubsystem invalid");
 		return;
 	}
 
-	TMap<FString, FString> MetricsNames;
-	GetMetricsNames(WorldContextObject, MetricsNames);
-	CalculateAttentionMetrics(MetricsNames, MetricsThreshold);
+	// A file that fails to load keeps the current session active
+	const int32 PreviousSessionHandle = SessionSubsystem->GetActiveSession();
+
+	if (SessionSubsystem->LoadSession(FileName, MetricsThreshold) != INDEX_NONE)
+		SessionSubsystem->UnloadSession(PreviousSessionHandle);
+}
+
+bool UHeatmapRT::ReprojectHeatmap(const UObject* WorldContextObject, const FString& FileName,
+	const FString& ReprojectedFileName)
+{
+	const FString FilePath = UJsonParser::AttentionTrackingDataFolderPath() + FileName;
+	const FString ReprojectedFilePath = UJsonParser::AttentionTrackingDataFolderPath() + ReprojectedFileName;
+
+	FGazeRayStream GazeRays;
+
+	if (!GazeRays.LoadFromFile(FGazeRayStream::GetSidecarFilePath(FilePath)))
+	{
+		DebugHeader::ShowNotifyInfo("No gaze rays recorded for " + FileName);
+		return false;
+	}
+
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+
+	TArray<FAttentionTrackingDataPoint> AttentionTrackingData;
+	FGazePointCloud GazePoints;
+	FAttentionVolume AttentionVolume;
+
+	if (!FGazeReprojector::Reproject(World, GazeRays, AttentionTrackingData, &GazePoints, &AttentionVolume))
+	{
+		DebugHeader::PrintError("UHeatmapRT::ReprojectHeatmap: World has no collision to trace against");
+		return false;
+	}
+
+	// The re-projected sidecars below replace the recording's, so the recorders aren't notified
+	if (!WriteHeatmap(ReprojectedFilePath, AttentionTrackingData)) return false;
+
+	const FString GazePointsFilePath = FGazePointCloud::GetSidecarFilePath(ReprojectedFilePath);
+	const FString AttentionVolumeFilePath = FAttentionVolume::GetSidecarFilePath(ReprojectedFilePath);
+	const FString GazeRaysFilePath = FGazeRayStream::GetSidecarFilePath(ReprojectedFilePath);
+
+	DebugHeader::ShowNotifyInfoIf(!GazePoints.SaveToFile(GazePointsFilePath),
+		"Failed to save gaze points to " + GazePointsFilePath);
+	DebugHeader::ShowNotifyInfoIf(!AttentionVolume.SaveToFile(AttentionVolumeFilePath),
+		"Failed to save attention volume to " + AttentionVolumeFilePath);
+	DebugHeader::ShowNotifyInfoIf(!GazeRays.SaveToFile(GazeRaysFilePath),
+		"Failed to save gaze rays to " + GazeRaysFilePath);
+
+	// Visibility was measured from the participant's view and carries over as recorded
+	const FString VisibilityFilePath = FHeatmapVisibilityTracker::GetSidecarFilePath(FilePath);
+
+	if (FPaths::FileExists(VisibilityFilePath))
+		IFileManager::Get().Copy(*FHeatmapVisibilityTracker::GetSidecarFilePath(ReprojectedFilePath), *VisibilityFilePath);
+
+	return true;
 }
 
 void UHeatmapRT::PaintLoadedHeatmap(UObject* WorldContextObject, const bool bLoadImmediately)
@@ -59,73 +117,90 @@ void UHeatmapRT::PaintLoadedHeatmap(UObject* WorldContextObject, const bool bLoa
 		return;
 	}
 	
-	const UWorld* World = WorldContextObject->GetWorld();
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
 
-	if (!World)
+	if (!SessionSubsystem)
 	{
 		DebugHeader::PrintError("UHeatmapRT::LoadHeatmap: World Ref invalid");
 		return;
 	}
 
-	const uint64 Num = AttentionTrackingDataCurrentlyLoaded.Num();
+	SessionSubsystem->PaintSession(SessionSubsystem->GetActiveSession(), bLoadImmediately);
+}
 
-	if (Num == 0)
+void UHeatmapRT::StopTimer(UObject* WorldContextObject)
+{
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+
+	if (!SessionSubsystem)
 	{
-		DebugHeader::ShowNotifyInfo("No heatmap loaded");
+		DebugHeader::PrintError("UHeatmapRT::LoadHeatmap: World Ref invalid");
 		return;
 	}
 
-	TArray<AActor*> OutActors;
-	UGameplayStatics::GetAllActorsOfClass(WorldContextObject, AHeatmapReadyActor::StaticClass(), OutActors);
-	const uint64 NumActors = OutActors.Num();
+	SessionSubsystem->StopSession(SessionSubsystem->GetActiveSession());
+}
 
-	HeatmapReadyActors.Empty();
-	HeatmapReadyActors.Reserve(NumActors);
-	
-	for (uint64 i = 0; i < NumActors; i++)
-		HeatmapReadyActors.Push(Cast<AHeatmapReadyActor>(OutActors[i]));
-	
-	for (uint64 i = 0; i < Num; ++i)
+void UHeatmapRT::PaintCompositeHeatmap(UObject* WorldContextObject, const TArray<FString>& FileNames,
+	const bool bNormalizePerParticipant, const float MetricsThreshold)
+{
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+
+	if (!SessionSubsystem)
 	{
-		if (bLoadImmediately)
-		{
-			PaintHeatmapDataPoint(AttentionTrackingDataCurrentlyLoaded[i], WorldContextObject);
-		}
+		DebugHeader::PrintError("UHeatmapRT::PaintCompositeHeatmap: World Ref invalid");
+		return;
+	}
 
-		else
-		{
-			const float DelayTime = AttentionTrackingDataCurrentlyLoaded[i].TimePassedSinceRecordingStarted;
+	SessionSubsystem->PaintCompositeSessions(SessionSubsystem->FindOrLoadSessions(FileNames, MetricsThreshold),
+		bNormalizePerParticipant);
+}
 
-			HeatmapTimerHandles.Emplace(FTimerHandle());
-			FTimerDelegate TimerDelegate;
+void UHeatmapRT::PaintDifferenceHeatmap(UObject* WorldContextObject, const TArray<FString>& FileNamesA,
+	const TArray<FString>& FileNamesB, TMap<FString, FAttentionMetricsDelta>& OutMetricsDeltas,
+	const float MetricsThreshold)
+{
+	OutMetricsDeltas.Empty();
 
-			TimerDelegate.BindLambda([=]()
-			{
-				PaintHeatmapDataPoint(AttentionTrackingDataCurrentlyLoaded[i], WorldContextObject);
-			});
-			
-			World->GetTimerManager().SetTimer(HeatmapTimerHandles[i], TimerDelegate, DelayTime, false);
-		}
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+
+	if (!SessionSubsystem)
+	{
+		DebugHeader::PrintError("UHeatmapRT::PaintDifferenceHeatmap: World Ref invalid");
+		return;
 	}
 
-	LastActorPaintedOn = nullptr;
+	const TArray<int32> SessionHandlesA = SessionSubsystem->FindOrLoadSessions(FileNamesA, MetricsThreshold);
+	const TArray<int32> SessionHandlesB = SessionSubsystem->FindOrLoadSessions(FileNamesB, MetricsThreshold);
+
+	SessionSubsystem->PaintDifferenceSessions(SessionHandlesA, SessionHandlesB, OutMetricsDeltas);
 }
 
-void UHeatmapRT::StopTimer(UObject* WorldContextObject)
+void UHeatmapRT::SetHeatmapAccumulationMode(UObject* WorldContextObject, const EHeatmapAccumulationMode Mode,
+	const float Seconds)
 {
-	const UWorld* World = WorldContextObject->GetWorld();
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
 
-	if (!World)
+	if (!SessionSubsystem)
 	{
-		DebugHeader::PrintError("UHeatmapRT::LoadHeatmap: World Ref invalid");
+		DebugHeader::PrintError("UHeatmapRT::SetHeatmapAccumulationMode: World Ref invalid");
 		return;
 	}
 
-	for (FTimerHandle TimerHandle : HeatmapTimerHandles)
+	SessionSubsystem->SetAccumulationMode(Mode, Seconds);
+}
+
+void UHeatmapRT::SeekLoadedHeatmap(UObject* WorldContextObject, const float Time, const bool bResumePlayback)
+{
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+
+	if (!SessionSubsystem)
 	{
-		if (TimerHandle.IsValid())
-			World->GetTimerManager().ClearTimer(TimerHandle);
+		DebugHeader::PrintError("UHeatmapRT::SeekLoadedHeatmap: World Ref invalid");
+		return;
 	}
+
+	SessionSubsystem->SeekSession(SessionSubsystem->GetActiveSession(), Time, bResumePlayback);
 }
 
 FString UHeatmapRT::GetLastSavedOrLoadedHeatmapFileName()
@@ -159,9 +234,30 @@ void UHeatmapRT::ResetHeatmap(UObject* WorldContextObject, UMaterialInterface* P
 	}
 }
 
-void UHeatmapRT::CalculateAttentionMetrics(const TMap<FString, FString>& MetricsNames, const float Threshold)
+void UHeatmapRT::CalculateAttentionMetrics(const UObject* WorldContextObject, const TMap<FString, FString>& MetricsNames,
+	const float Threshold)
 {
-	AttentionMetrics.Empty();
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+
+	if (!SessionSubsystem) return;
+
+	SessionSubsystem->CalculateSessionMetrics(SessionSubsystem->GetActiveSession(), MetricsNames, Threshold);
+}
+
+void UHeatmapRT::ComputeAttentionMetrics(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	const TMap<FString, FString>& MetricsNames, const float Threshold, TMap<FString, FAttentionMetricsEntry>& OutMetrics)
+{
+	TArray<FHeatmapSegmentMetrics> SegmentMetrics;
+	ComputeAttentionMetrics(AttentionTrackingData, MetricsNames, Threshold, {}, OutMetrics, SegmentMetrics);
+}
+
+void UHeatmapRT::ComputeAttentionMetrics(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	const TMap<FString, FString>& MetricsNames, const float Threshold,
+	const TArray<FHeatmapSegmentMarker>& SegmentMarkers, TMap<FString, FAttentionMetricsEntry>& OutMetrics,
+	TArray<FHeatmapSegmentMetrics>& OutSegmentMetrics)
+{
+	OutMetrics.Empty();
+	OutSegmentMetrics.Empty();
 	
 	int AttentionSequenceIndex = 0;
 	float CurrentAttentionTime = 0.f;
@@ -169,130 +265,419 @@ void UHeatmapRT::CalculateAttentionMetrics(const TMap<FString, FString>& Metrics
 	
 	const FAttentionTrackingDataPoint* PreviousDataPoint = nullptr;
 
-	if (AttentionTrackingDataCurrentlyLoaded.IsEmpty())
+	if (AttentionTrackingData.IsEmpty())
 	{
 		DebugHeader::ShowNotifyInfo("No heatmap loaded");
 		return;
 	}
+
+	const FAttentionTrackingDataPoint& LastDataPoint = AttentionTrackingData.Last();
+	MakeSegments(SegmentMarkers, LastDataPoint.TimePassedSinceRecordingStarted + LastDataPoint.Duration,
+		OutSegmentMetrics);
+
+	// Dwells start in time order, so the current leg only ever moves forward
+	int32 SegmentIndex = 0;
+	TArray<int32> SegmentSequenceIndices;
+	SegmentSequenceIndices.SetNumZeroed(OutSegmentMetrics.Num());
+
+	auto StoreAttention = [&](const FString& MetricsName, const float AttentionTime, const float FirstAttentionAfter)
+	{
+		AddAttention(OutMetrics, MetricsName, AttentionTime, FirstAttentionAfter, AttentionSequenceIndex++);
+
+		if (OutSegmentMetrics.IsEmpty()) return;
+
+		while (OutSegmentMetrics.IsValidIndex(SegmentIndex + 1) &&
+			OutSegmentMetrics[SegmentIndex + 1].StartTime <= FirstAttentionAfter)
+			++SegmentIndex;
+
+		FHeatmapSegmentMetrics& Segment = OutSegmentMetrics[SegmentIndex];
+
+		AddAttention(Segment.Metrics, MetricsName, AttentionTime, FirstAttentionAfter - Segment.StartTime,
+			SegmentSequenceIndices[SegmentIndex]++);
+	};
 	
-	for (FAttentionTrackingDataPoint& DataPoint : AttentionTrackingDataCurrentlyLoaded)
+	for (const FAttentionTrackingDataPoint& DataPoint : AttentionTrackingData)
 	{
 		if (!PreviousDataPoint)
 		{
 			PreviousDataPoint = &DataPoint;
 			FirstAttentionTime = DataPoint.TimePassedSinceRecordingStarted;
+			CurrentAttentionTime = DataPoint.Duration;
 			continue;
 		}
 
-		if (DataPoint.ObjectName == PreviousDataPoint->ObjectName)
+		if (IsSameActor(DataPoint, *PreviousDataPoint))
 		{
-			CurrentAttentionTime +=
-				DataPoint.TimePassedSinceRecordingStarted - PreviousDataPoint->TimePassedSinceRecordingStarted;
+			// Gap since the end of the previous run, plus the time covered by this run
+			CurrentAttentionTime += DataPoint.TimePassedSinceRecordingStarted
+				- (PreviousDataPoint->TimePassedSinceRecordingStarted + PreviousDataPoint->Duration)
+				+ DataPoint.Duration;
 
 			PreviousDataPoint = &DataPoint;
 			continue;
 		}
+
+		const float FirstAttentionTimeToStore = FirstAttentionTime;
+		FirstAttentionTime = DataPoint.TimePassedSinceRecordingStarted;
 		
-		if (DataPoint.ObjectName != PreviousDataPoint->ObjectName)
+		const float CurrentAttentionTimeToStore = CurrentAttentionTime;
+		CurrentAttentionTime = DataPoint.Duration;
+
+		const FString* MetricsName = MetricsNames.Find(GetMetricsKey(*PreviousDataPoint));
+		PreviousDataPoint = &DataPoint;
+
+		// DebugHeader::PrintLog("CurrentAttentionTimeToStore: " + FString::SanitizeFloat(CurrentAttentionTimeToStore));
+		
+		if (CurrentAttentionTimeToStore < Threshold || !MetricsName) continue;
+
+		StoreAttention(*MetricsName, CurrentAttentionTimeToStore, FirstAttentionTimeToStore);
+	}
+
+	// Update the last focused object
+	if (const FString* MetricsName = MetricsNames.Find(GetMetricsKey(*PreviousDataPoint)))
+		StoreAttention(*MetricsName, CurrentAttentionTime, FirstAttentionTime);
+}
+
+void UHeatmapRT::AddAttention(TMap<FString, FAttentionMetricsEntry>& Metrics, const FString& MetricsName,
+	const float AttentionTime, const float FirstAttentionAfter, const int32 AttentionSequenceIndex)
+{
+	FAttentionMetricsEntry* Entry = Metrics.Find(MetricsName);
+
+	if (!Entry)
+	{
+		FAttentionMetricsEntry& NewEntry = Metrics.Add(MetricsName);
+		NewEntry.TotalAttentionTime = AttentionTime;
+		NewEntry.AverageAttentionTime = AttentionTime;
+		NewEntry.FirstAttentionAfter = FirstAttentionAfter;
+		NewEntry.TimesFocussed = 1;
+		NewEntry.AttentionSequenceIndices.Add(AttentionSequenceIndex);
+		return;
+	}
+
+	Entry->AttentionSequenceIndices.Add(AttentionSequenceIndex);
+	Entry->TotalAttentionTime += AttentionTime;
+	Entry->AverageAttentionTime = Entry->TotalAttentionTime / static_cast<float>(Entry->AttentionSequenceIndices.Num());
+	++Entry->TimesFocussed;
+}
+
+void UHeatmapRT::MakeSegments(const TArray<FHeatmapSegmentMarker>& SegmentMarkers, const float EndTime,
+	TArray<FHeatmapSegmentMetrics>& OutSegmentMetrics)
+{
+	OutSegmentMetrics.Empty();
+
+	if (SegmentMarkers.IsEmpty()) return;
+
+	TArray<FHeatmapSegmentMarker> SortedMarkers = SegmentMarkers;
+	SortedMarkers.StableSort([](const FHeatmapSegmentMarker& A, const FHeatmapSegmentMarker& B)
+	{
+		return A.Time < B.Time;
+	});
+
+	FHeatmapSegmentMetrics Segment;
+
+	for (const FHeatmapSegmentMarker& Marker : SortedMarkers)
+	{
+		Segment.ToWaypointIndex = Marker.WaypointIndex;
+		Segment.EndTime = Marker.Time;
+		OutSegmentMetrics.Add(Segment);
+
+		Segment.FromWaypointIndex = Marker.WaypointIndex;
+		Segment.StartTime = Marker.Time;
+	}
+
+	Segment.ToWaypointIndex = INDEX_NONE;
+	Segment.EndTime = FMath::Max(EndTime, Segment.StartTime);
+	OutSegmentMetrics.Add(Segment);
+}
+
+void UHeatmapRT::GetAttentionTrackingDataCurrentlyLoaded(const UObject* WorldContextObject,
+	TArray<FAttentionTrackingDataPoint>& OutData)
+{
+	OutData.Empty();
+	
+	if (const UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject))
+		SessionSubsystem->GetSessionData(SessionSubsystem->GetActiveSession(), OutData);
+}
+
+void UHeatmapRT::GetAttentionMetrics(const UObject* WorldContextObject, TMap<FString, FAttentionMetricsEntry>& OutMetrics)
+{
+	OutMetrics.Empty();
+	
+	if (const UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject))
+		SessionSubsystem->GetSessionMetrics(SessionSubsystem->GetActiveSession(), OutMetrics);
+}
+
+void UHeatmapRT::GetAoiMetrics(const UObject* WorldContextObject, TMap<FString, FAttentionMetricsEntry>& OutMetrics)
+{
+	OutMetrics.Empty();
+
+	if (const UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject))
+	{
+		if (const FHeatmapSession* Session = SessionSubsystem->FindSession(SessionSubsystem->GetActiveSession()))
+			OutMetrics = Session->AoiMetrics;
+	}
+}
+
+void UHeatmapRT::GetSegmentMetrics(const UObject* WorldContextObject, TArray<FHeatmapSegmentMetrics>& OutSegmentMetrics)
+{
+	OutSegmentMetrics.Empty();
+
+	if (const UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject))
+	{
+		if (const FHeatmapSession* Session = SessionSubsystem->FindSession(SessionSubsystem->GetActiveSession()))
+			OutSegmentMetrics = Session->SegmentMetrics;
+	}
+}
+
+void UHeatmapRT::ComputeAoiMetrics(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	const TMap<FString, FString>& MetricsNames, const UObject* WorldContextObject, const float Threshold,
+	TMap<FString, FAttentionMetricsEntry>& OutMetrics)
+{
+	OutMetrics.Empty();
+
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(WorldContextObject);
+
+	if (!Registry) return;
+
+	struct FAoiVisit
+	{
+		FString MetricsName;
+		float StartTime;
+		float EndTime;
+		float AttentionTime;
+	};
+
+	// Actor lookups and index builds happen once per actor, not per sample
+	TMap<FGuid, AHeatmapReadyActor*> ActorsByGuid;
+
+	// Only the actor of the previous data point can have open visits, keyed by AOI index
+	const FAttentionTrackingDataPoint* PreviousDataPoint = nullptr;
+	TMap<int32, FAoiVisit> ActiveVisits;
+	TArray<FAoiVisit> FinishedVisits;
+
+	auto FinishVisit = [&FinishedVisits, Threshold](FAoiVisit& Visit)
+	{
+		if (Visit.AttentionTime >= Threshold)
+			FinishedVisits.Add(MoveTemp(Visit));
+	};
+
+	TArray<int32, TInlineAllocator<4>> AoiIndices;
+
+	for (const FAttentionTrackingDataPoint& DataPoint : AttentionTrackingData)
+	{
+		AHeatmapReadyActor* Actor = nullptr;
+
+		if (AHeatmapReadyActor** CachedActor = ActorsByGuid.Find(DataPoint.ActorGuid))
+			Actor = *CachedActor;
+
+		else
+			Actor = ActorsByGuid.Add(DataPoint.ActorGuid, Registry->FindActor(DataPoint.ActorGuid));
+
+		const FString* MetricsName = MetricsNames.Find(GetMetricsKey(DataPoint));
+
+		AoiIndices.Reset();
+
+		if (Actor && MetricsName && !Actor->Aois.IsEmpty())
+			Actor->GetAoiIndex().Classify(DataPoint.Coordinates, AoiIndices);
+
+		if (PreviousDataPoint && !IsSameActor(DataPoint, *PreviousDataPoint))
 		{
-			const float FirstAttentionTimeToStore = FirstAttentionTime;
-			FirstAttentionTime = DataPoint.TimePassedSinceRecordingStarted;
-			
-			const float CurrentAttentionTimeToStore = CurrentAttentionTime;
-			CurrentAttentionTime = 0.f;
+			for (TPair<int32, FAoiVisit>& Visit : ActiveVisits)
+				FinishVisit(Visit.Value);
 
-			// DebugHeader::PrintLog("CurrentAttentionTimeToStore: " + FString::SanitizeFloat(CurrentAttentionTimeToStore));
-			
-			if (CurrentAttentionTimeToStore < Threshold)
-			{
-				PreviousDataPoint = &DataPoint;
-				continue;
-			}
-			
-			const FString& ObjectName = PreviousDataPoint->ObjectName;
+			ActiveVisits.Reset();
+		}
 
-			if (!MetricsNames.Contains(ObjectName))
-			{
-				PreviousDataPoint = &DataPoint;
-				continue;
-			}
+		for (auto It = ActiveVisits.CreateIterator(); It; ++It)
+		{
+			if (AoiIndices.Contains(It->Key)) continue;
 
-			const FString& MetricsName = MetricsNames[ObjectName];
-			// DebugHeader::PrintLog("Metrics Name: " + MetricsName);
-			
-			if (!AttentionMetrics.Contains(MetricsName))
+			FinishVisit(It->Value);
+			It.RemoveCurrent();
+		}
+
+		const float EndTime = DataPoint.TimePassedSinceRecordingStarted + DataPoint.Duration;
+
+		for (const int32 AoiIndex : AoiIndices)
+		{
+			if (FAoiVisit* Visit = ActiveVisits.Find(AoiIndex))
 			{
-				FAttentionMetricsEntry NewEntry = { CurrentAttentionTimeToStore,
-					CurrentAttentionTimeToStore,
-					FirstAttentionTimeToStore,
-					1,
-					{ AttentionSequenceIndex } };
-				
-				AttentionMetrics.Add(MetricsName, NewEntry);
-
-				++AttentionSequenceIndex;
-				PreviousDataPoint = &DataPoint;
+				// Same rule as the per-actor dwells: gap since the end of the previous run, plus this run
+				Visit->AttentionTime += DataPoint.TimePassedSinceRecordingStarted - Visit->EndTime + DataPoint.Duration;
+				Visit->EndTime = EndTime;
 				continue;
 			}
 
-			FAttentionMetricsEntry& CurrentEntry = AttentionMetrics[MetricsName];
-			
-			CurrentEntry.AttentionSequenceIndices.Add(AttentionSequenceIndex);
-			CurrentEntry.TotalAttentionTime += CurrentAttentionTimeToStore;
-			CurrentEntry.AverageAttentionTime =
-				CurrentEntry.TotalAttentionTime / static_cast<float>(CurrentEntry.AttentionSequenceIndices.Num());
-			++CurrentEntry.TimesFocussed;
-			++AttentionSequenceIndex;
-			
-			PreviousDataPoint = &DataPoint;
+			ActiveVisits.Add(AoiIndex, { *MetricsName + "/" + Actor->Aois[AoiIndex].Name,
+				DataPoint.TimePassedSinceRecordingStarted, EndTime, DataPoint.Duration });
 		}
+
+		PreviousDataPoint = &DataPoint;
 	}
 
-	// Update the last focused object if PreviousDataPoint is valid
-	if (PreviousDataPoint)
+	for (TPair<int32, FAoiVisit>& Visit : ActiveVisits)
+		FinishVisit(Visit.Value);
+
+	// Overlapping AOIs close out of order; store them by start time so the sequence matches the per-actor one
+	FinishedVisits.StableSort([](const FAoiVisit& A, const FAoiVisit& B) { return A.StartTime < B.StartTime; });
+
+	int32 AttentionSequenceIndex = 0;
+
+	for (const FAoiVisit& Visit : FinishedVisits)
+		AddAttention(OutMetrics, Visit.MetricsName, Visit.AttentionTime, Visit.StartTime, AttentionSequenceIndex++);
+}
+
+void UHeatmapRT::SortAttentionMetrics(const UObject* WorldContextObject, ESortMode SortMode, bool bAscending)
+{
+	if (UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject))
+		SessionSubsystem->SortSessionMetrics(SessionSubsystem->GetActiveSession(), SortMode, bAscending);
+}
+
+void UHeatmapRT::ComputeDensityMetrics(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	const TMap<FString, FString>& MetricsNames, const UObject* WorldContextObject,
+	TMap<FString, FAttentionMetricsEntry>& InOutMetrics)
+{
+	if (InOutMetrics.IsEmpty()) return;
+
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(WorldContextObject);
+
+	if (!Registry) return;
+
+	FHeatmapAccumulator Accumulator(DensityMetricsResolution);
+
+	TArray<AHeatmapReadyActor*> HeatmapReadyActors;
+	Registry->GetAllActors(HeatmapReadyActors);
+
+	for (const AHeatmapReadyActor* HeatmapReadyActor : HeatmapReadyActors)
+		Accumulator.SetScaleDivisors(HeatmapReadyActor);
+
+	Accumulator.Accumulate(AttentionTrackingData);
+
+	ComputeDensityMetrics(Accumulator.GetGrids(), MetricsNames, WorldContextObject, InOutMetrics);
+}
+
+void UHeatmapRT::ComputeDensityMetrics(const TMap<FGuid, FHeatmapGrid>& Grids, const TMap<FString, FString>& MetricsNames,
+	const UObject* WorldContextObject, TMap<FString, FAttentionMetricsEntry>& InOutMetrics)
+{
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(WorldContextObject);
+
+	if (!Registry) return;
+
+	struct FMetricsSurface
 	{
-		const float CurrentAttentionTimeToStore = CurrentAttentionTime;
-		// DebugHeader::PrintLog("CurrentAttentionTimeToStore: " + FString::SanitizeFloat(CurrentAttentionTimeToStore));
-	
-		const FString& ObjectName = PreviousDataPoint->ObjectName;
-		
-		if (!MetricsNames.Contains(ObjectName)) return;
-		
-		const FString& MetricsName = MetricsNames[ObjectName];
+		TArray<const FHeatmapGrid*> Grids;
+		TArray<const AHeatmapReadyActor*> Actors;
+	};
 
-		if (!AttentionMetrics.Contains(MetricsName))
+	// Actors sharing a metrics name share an entry, so their grids are reduced as one surface
+	TMap<FString, FMetricsSurface> Surfaces;
+
+	for (const TPair<FGuid, FHeatmapGrid>& Grid : Grids)
+	{
+		const FString* MetricsName = MetricsNames.Find(Grid.Key.ToString());
+
+		if (!MetricsName || !InOutMetrics.Contains(*MetricsName)) continue;
+
+		FMetricsSurface& Surface = Surfaces.FindOrAdd(*MetricsName);
+		Surface.Grids.Add(&Grid.Value);
+		Surface.Actors.Add(Registry->FindActor(Grid.Key));
+	}
+
+	for (const TPair<FString, FMetricsSurface>& Surface : Surfaces)
+	{
+		TArray<TArray<float>> TexelAreas;
+		TexelAreas.SetNum(Surface.Value.Grids.Num());
+
+		bool bHasTexelAreas = true;
+
+		for (int32 i = 0; i < Surface.Value.Grids.Num() && bHasTexelAreas; ++i)
 		{
-			FAttentionMetricsEntry NewEntry = { CurrentAttentionTime,
-				CurrentAttentionTimeToStore,
-				FirstAttentionTime,
-				1,
-				{ AttentionSequenceIndex } };
-				
-			AttentionMetrics.Add(MetricsName, NewEntry);
-			++AttentionSequenceIndex;
-			return;
+			const AHeatmapReadyActor* HeatmapReadyActor = Surface.Value.Actors[i];
+
+			bHasTexelAreas = HeatmapReadyActor &&
+				HeatmapReadyActor->ComputeTexelAreas(Surface.Value.Grids[i]->Resolution, TexelAreas[i]);
 		}
-		
-		FAttentionMetricsEntry& CurrentEntry = AttentionMetrics[MetricsName];
-		CurrentEntry.AttentionSequenceIndices.Add(AttentionSequenceIndex);
-		CurrentEntry.TotalAttentionTime += CurrentAttentionTimeToStore;
-		CurrentEntry.AverageAttentionTime =
-			CurrentEntry.TotalAttentionTime / static_cast<float>(CurrentEntry.AttentionSequenceIndices.Num());
-		++CurrentEntry.TimesFocussed;
+
+		// Without a lookup table for every actor, every texel counts the same; areas and texel counts don't mix
+		TArray<const TArray<float>*> TexelAreaPointers;
+
+		if (bHasTexelAreas)
+		{
+			for (const TArray<float>& Areas : TexelAreas)
+				TexelAreaPointers.Add(&Areas);
+		}
+
+		const FHeatmapGridStats Stats = FHeatmapGrid::ComputeStats(Surface.Value.Grids, TexelAreaPointers);
+
+		FAttentionMetricsEntry& Entry = InOutMetrics[Surface.Key];
+		Entry.Coverage = Stats.Coverage;
+		Entry.Entropy = Stats.Entropy;
+		Entry.PeakDensity = Stats.Peak;
+		Entry.DensityCentroid = Stats.Centroid;
+		Entry.DensityVariance = Stats.Variance;
+		Entry.DensityCovariance = Stats.Covariance;
 	}
 }
 
-void UHeatmapRT::GetAttentionTrackingDataCurrentlyLoaded(TArray<FAttentionTrackingDataPoint>& OutData)
+void UHeatmapRT::ApplyVisibleTimes(const TMap<FString, float>& VisibleTimes,
+	TMap<FString, FAttentionMetricsEntry>& InOutMetrics)
 {
-	OutData = AttentionTrackingDataCurrentlyLoaded;
+	for (const TPair<FString, float>& VisibleTime : VisibleTimes)
+	{
+		FAttentionMetricsEntry& Entry = InOutMetrics.FindOrAdd(VisibleTime.Key);
+
+		Entry.VisibleTime = VisibleTime.Value;
+		Entry.AttendedToVisibleRatio = VisibleTime.Value > 0.f ? Entry.TotalAttentionTime / VisibleTime.Value : 0.f;
+	}
 }
 
-void UHeatmapRT::GetAttentionMetrics(TMap<FString, FAttentionMetricsEntry>& OutMetrics)
+void UHeatmapRT::ComputeAttentionMetricsDeltas(const TArray<const TMap<FString, FAttentionMetricsEntry>*>& MetricsA,
+	const TArray<const TMap<FString, FAttentionMetricsEntry>*>& MetricsB, TMap<FString, FAttentionMetricsDelta>& OutDeltas)
 {
-	OutMetrics = AttentionMetrics;
+	OutDeltas.Empty();
+
+	// Sums first, averages below; sessions that never attended an object count as zero dwell time
+	for (const TMap<FString, FAttentionMetricsEntry>* SessionMetrics : MetricsA)
+	{
+		for (const TPair<FString, FAttentionMetricsEntry>& Entry : *SessionMetrics)
+		{
+			FAttentionMetricsDelta& Delta = OutDeltas.FindOrAdd(Entry.Key);
+			Delta.TotalAttentionTimeA += Entry.Value.TotalAttentionTime;
+			Delta.FirstAttentionAfterA += Entry.Value.FirstAttentionAfter;
+			++Delta.SessionsAttendedA;
+		}
+	}
+
+	for (const TMap<FString, FAttentionMetricsEntry>* SessionMetrics : MetricsB)
+	{
+		for (const TPair<FString, FAttentionMetricsEntry>& Entry : *SessionMetrics)
+		{
+			FAttentionMetricsDelta& Delta = OutDeltas.FindOrAdd(Entry.Key);
+			Delta.TotalAttentionTimeB += Entry.Value.TotalAttentionTime;
+			Delta.FirstAttentionAfterB += Entry.Value.FirstAttentionAfter;
+			++Delta.SessionsAttendedB;
+		}
+	}
+
+	for (TPair<FString, FAttentionMetricsDelta>& Entry : OutDeltas)
+	{
+		FAttentionMetricsDelta& Delta = Entry.Value;
+
+		Delta.TotalAttentionTimeA = MetricsA.IsEmpty() ? 0.f : Delta.TotalAttentionTimeA / MetricsA.Num();
+		Delta.TotalAttentionTimeB = MetricsB.IsEmpty() ? 0.f : Delta.TotalAttentionTimeB / MetricsB.Num();
+		Delta.TotalAttentionTimeDelta = Delta.TotalAttentionTimeA - Delta.TotalAttentionTimeB;
+
+		Delta.FirstAttentionAfterA = Delta.SessionsAttendedA > 0 ? Delta.FirstAttentionAfterA / Delta.SessionsAttendedA : 0.f;
+		Delta.FirstAttentionAfterB = Delta.SessionsAttendedB > 0 ? Delta.FirstAttentionAfterB / Delta.SessionsAttendedB : 0.f;
+
+		// Only meaningful when both cohorts looked at it
+		Delta.FirstAttentionAfterDelta = Delta.SessionsAttendedA > 0 && Delta.SessionsAttendedB > 0 ?
+			Delta.FirstAttentionAfterA - Delta.FirstAttentionAfterB : 0.f;
+	}
 }
 
-void UHeatmapRT::SortAttentionMetrics(ESortMode SortMode, bool bAscending)
+void UHeatmapRT::SortAttentionMetricsMap(TMap<FString, FAttentionMetricsEntry>& AttentionMetrics,
+	ESortMode SortMode, bool bAscending)
 {
 	TArray<TPair<FString, FAttentionMetricsEntry>> Array = AttentionMetrics.Array();
 
@@ -345,30 +730,104 @@ void UHeatmapRT::PaintHeatmapDataPoint(const FAttentionTrackingDataPoint& DataPo
 		DebugHeader::ShowNotifyInfo("From UHeatmapRT::PaintHeatmapDataPoint(): World invalid");
 		return;
 	}
-	
-	if (LastActorPaintedOn && DataPoint.ObjectName == UKismetSystemLibrary::GetObjectName(LastActorPaintedOn))
+
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+
+	if (!SessionSubsystem) return;
+
+	SessionSubsystem->PaintDataPoint(SessionSubsystem->GetActiveSession(), DataPoint);
+}
+
+bool UHeatmapRT::IsSameActor(const FAttentionTrackingDataPoint& A, const FAttentionTrackingDataPoint& B)
+{
+	if (A.ActorGuid.IsValid() && B.ActorGuid.IsValid())
+		return A.ActorGuid == B.ActorGuid;
+
+	return A.ObjectName == B.ObjectName;
+}
+
+FString UHeatmapRT::GetMetricsKey(const FAttentionTrackingDataPoint& DataPoint)
+{
+	return DataPoint.ActorGuid.IsValid() ? DataPoint.ActorGuid.ToString() : DataPoint.ObjectName;
+}
+
+void UHeatmapRT::ResolveLegacyActorGuids(TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	const UObject* WorldContextObject)
+{
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(WorldContextObject);
+
+	if (!Registry) return;
+
+	for (FAttentionTrackingDataPoint& DataPoint : AttentionTrackingData)
 	{
-		LastActorPaintedOn->ScalePaintBrush(DataPoint.PaintBrushScaleDivisor);
-		LastActorPaintedOn->PaintHeatmap(DataPoint.Coordinates);
+		if (!DataPoint.ActorGuid.IsValid())
+			DataPoint.ActorGuid = Registry->FindGuidByObjectName(DataPoint.ObjectName);
 	}
-	
-	else
+}
+
+bool UHeatmapRT::TryMergeIntoRun(FAttentionTrackingDataPoint& Run, const FAttentionTrackingDataPoint& DataPoint,
+	const float UvEpsilon)
+{
+	if (!IsSameActor(DataPoint, Run) || DataPoint.FaceAxis != Run.FaceAxis ||
+		!FMath::IsNearlyEqual(DataPoint.Weight, Run.Weight))
+		return false;
+
+	// Compare against the first sample of the run, so slow drifts can't add up beyond the epsilon
+	if (!DataPoint.Coordinates.Equals(Run.Coordinates, UvEpsilon))
+		return false;
+
+	const float RunEnd = DataPoint.TimePassedSinceRecordingStarted + DataPoint.Duration;
+
+	if (RunEnd < Run.TimePassedSinceRecordingStarted + Run.Duration)
+		return false;
+
+	Run.Duration = RunEnd - Run.TimePassedSinceRecordingStarted;
+	Run.SampleCount += DataPoint.SampleCount;
+
+	return true;
+}
+
+void UHeatmapRT::CompressAttentionTrackingData(TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	const float UvEpsilon)
+{
+	const int32 Num = AttentionTrackingData.Num();
+
+	if (Num < 2) return;
+
+	int32 RunIndex = 0;
+
+	for (int32 i = 1; i < Num; ++i)
 	{
-		for (AHeatmapReadyActor* Actor : HeatmapReadyActors)
-		{
-			if (!Actor || DataPoint.ObjectName != UKismetSystemLibrary::GetObjectName(Actor))
-				continue;
+		if (TryMergeIntoRun(AttentionTrackingData[RunIndex], AttentionTrackingData[i], UvEpsilon))
+			continue;
 
-			LastActorPaintedOn = Actor;
-				
-			if (!LastActorPaintedOn)
-				continue;
+		++RunIndex;
+
+		if (RunIndex != i)
+			AttentionTrackingData[RunIndex] = AttentionTrackingData[i];
+	}
 
-			LastActorPaintedOn->ScalePaintBrush(DataPoint.PaintBrushScaleDivisor);
-			LastActorPaintedOn->PaintHeatmap(DataPoint.Coordinates);
+	AttentionTrackingData.SetNum(RunIndex + 1);
+}
 
-			break;
-		}
+void UHeatmapRT::ResolveLegacyScaleDivisors(TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	const TMap<int32, FVector2D>& LegacyScaleDivisors, const UObject* WorldContextObject)
+{
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(WorldContextObject);
+
+	if (!Registry) return;
+
+	// Older files store the divisor itself; map it back onto the closest entry of the actor's table
+	for (const TPair<int32, FVector2D>& LegacyScaleDivisor : LegacyScaleDivisors)
+	{
+		if (!AttentionTrackingData.IsValidIndex(LegacyScaleDivisor.Key)) continue;
+
+		FAttentionTrackingDataPoint& DataPoint = AttentionTrackingData[LegacyScaleDivisor.Key];
+		const AHeatmapReadyActor* HeatmapReadyActor = Registry->FindActor(DataPoint.ActorGuid);
+
+		if (!HeatmapReadyActor) continue;
+
+		DataPoint.FaceAxis = HeatmapReadyActor->FindFaceAxisForScaleDivisor(LegacyScaleDivisor.Value);
 	}
 }
 
@@ -389,21 +848,27 @@ void UHeatmapRT::BlendMaterialParameter(const UObject* WorldContextObject, const
 
 	const float TargetValue = UKismetMathLibrary::Round(1.f - CurrentValue);
 
-	FTimerHandle& TimerHandle = BlendParameterTimerHandles.FindOrAdd(ParameterName);
+	UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+
+	if (!SessionSubsystem) return;
+
+	FTimerHandle& TimerHandle = SessionSubsystem->GetBlendParameterTimerHandles().FindOrAdd(ParameterName);
 
 	if (World->GetTimerManager().IsTimerActive(TimerHandle))
 		World->GetTimerManager().ClearTimer(TimerHandle);
 	
 	FTimerDelegate TimerDelegate;
-	
-	TimerDelegate.BindLambda([World, TimerHandle, ParameterCollectionInstance, ParameterName, CurrentValue, TargetValue]() mutable
+
+	// The handle is looked up when the timer fires; it's only assigned by SetTimer below
+	TimerDelegate.BindWeakLambda(SessionSubsystem,
+		[World, SessionSubsystem, ParameterCollectionInstance, ParameterName, CurrentValue, TargetValue]() mutable
 	{
 		const float NewValue = FMath::Lerp(CurrentValue, TargetValue, 0.1f);
 		ParameterCollectionInstance->SetScalarParameterValue(ParameterName, NewValue);
 
 		if (FMath::IsNearlyEqual(NewValue, TargetValue, 0.01f))
 		{
-			World->GetTimerManager().ClearTimer(TimerHandle);
+			World->GetTimerManager().ClearTimer(SessionSubsystem->GetBlendParameterTimerHandles().FindOrAdd(ParameterName));
 			ParameterCollectionInstance->SetScalarParameterValue(ParameterName, UKismetMathLibrary::Round(TargetValue));
 
 			FConfigData ConfigData;
@@ -427,14 +892,18 @@ void UHeatmapRT::ClearAllTimers(const bool bOnEndPieMode)
 	
 	if (!World) return;
 	
-	for (auto Timer : BlendParameterTimerHandles)
+	UHeatmapSessionSubsystem* SessionSubsystem = World->GetSubsystem<UHeatmapSessionSubsystem>();
+
+	if (!SessionSubsystem) return;
+	
+	for (auto Timer : SessionSubsystem->GetBlendParameterTimerHandles())
 	{
 		if (World->GetTimerManager().IsTimerActive(Timer.Value))
 			World->GetTimerManager().ClearTimer(Timer.Value);
 	}			
 }
 
-void UHeatmapRT::LogAttentionMetrics()
+void UHeatmapRT::LogAttentionMetrics(const TMap<FString, FAttentionMetricsEntry>& AttentionMetrics)
 {
 	static int TimesCalled = 0;
 	++TimesCalled;
@@ -456,6 +925,139 @@ void UHeatmapRT::LogAttentionMetrics()
 	DebugHeader::PrintLog(ToLog);
 }
 
+bool UHeatmapRT::QueryAttentionVolumeBox(const UObject* WorldContextObject, const FBox& Box,
+	FAttentionVolumeQueryResult& OutResult)
+{
+	OutResult = FAttentionVolumeQueryResult();
+
+	const UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+	const FHeatmapSession* Session = SessionSubsystem ?
+		SessionSubsystem->FindSession(SessionSubsystem->GetActiveSession()) : nullptr;
+
+	if (!Session || !Session->AttentionVolume) return false;
+
+	OutResult = Session->AttentionVolume->QueryBox(Box);
+
+	return true;
+}
+
+bool UHeatmapRT::QueryAttentionVolumeActor(const UObject* WorldContextObject, const AActor* Actor,
+	FAttentionVolumeQueryResult& OutResult)
+{
+	OutResult = FAttentionVolumeQueryResult();
+
+	const UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+	const FHeatmapSession* Session = SessionSubsystem ?
+		SessionSubsystem->FindSession(SessionSubsystem->GetActiveSession()) : nullptr;
+
+	if (!Actor || !Session || !Session->AttentionVolume) return false;
+
+	if (const AHeatmapReadyActor* HeatmapReadyActor = Cast<AHeatmapReadyActor>(Actor))
+	{
+		OutResult = Session->AttentionVolume->QueryActor(HeatmapReadyActor->HeatmapActorGuid);
+		return true;
+	}
+
+	OutResult = Session->AttentionVolume->QueryBox(Actor->GetComponentsBoundingBox(true));
+
+	return true;
+}
+
+const FGazePointCloud* UHeatmapRT::GetActiveSessionGazePoints(const UObject* WorldContextObject)
+{
+	const UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+	const FHeatmapSession* Session = SessionSubsystem ?
+		SessionSubsystem->FindSession(SessionSubsystem->GetActiveSession()) : nullptr;
+
+	return Session ? Session->GazePoints.Get() : nullptr;
+}
+
+void UHeatmapRT::FindHotspots(const UObject* WorldContextObject, const FHeatmapHotspotSettings& Settings,
+	TArray<FHeatmapHotspot>& OutHotspots)
+{
+	OutHotspots.Empty();
+
+	const UHeatmapSessionSubsystem* SessionSubsystem = UHeatmapSessionSubsystem::Get(WorldContextObject);
+	const FHeatmapSession* Session = SessionSubsystem ?
+		SessionSubsystem->FindSession(SessionSubsystem->GetActiveSession()) : nullptr;
+
+	if (!Session)
+	{
+		DebugHeader::ShowNotifyInfo("No heatmap loaded");
+		return;
+	}
+
+	TMap<FString, FString> MetricsNames;
+	GetMetricsNames(WorldContextObject, MetricsNames);
+
+	FHeatmapHotspotFinder::FindUvHotspots(Session->AttentionTrackingData, MetricsNames, Settings, OutHotspots);
+}
+
+bool UHeatmapRT::FindWorldHotspots(const UObject* WorldContextObject, const FHeatmapHotspotSettings& Settings,
+	TArray<FHeatmapHotspot>& OutHotspots)
+{
+	OutHotspots.Empty();
+
+	const FGazePointCloud* GazePoints = GetActiveSessionGazePoints(WorldContextObject);
+
+	if (!GazePoints) return false;
+
+	FHeatmapHotspotFinder::FindWorldHotspots(*GazePoints, Settings, OutHotspots);
+
+	return true;
+}
+
+bool UHeatmapRT::QueryGazePointsInRadius(const UObject* WorldContextObject, const FVector& Center, const float Radius,
+	TArray<FGazeSampleRange>& OutRanges)
+{
+	OutRanges.Empty();
+
+	const FGazePointCloud* GazePoints = GetActiveSessionGazePoints(WorldContextObject);
+
+	if (!GazePoints) return false;
+
+	GazePoints->QueryRadius(Center, Radius, OutRanges);
+
+	return true;
+}
+
+bool UHeatmapRT::QueryGazePointsInBox(const UObject* WorldContextObject, const FBox& Box,
+	TArray<FGazeSampleRange>& OutRanges)
+{
+	OutRanges.Empty();
+
+	const FGazePointCloud* GazePoints = GetActiveSessionGazePoints(WorldContextObject);
+
+	if (!GazePoints) return false;
+
+	GazePoints->QueryBox(Box, OutRanges);
+
+	return true;
+}
+
+bool UHeatmapRT::QueryGazePointsInCameraView(const UObject* WorldContextObject, UCameraComponent* Camera,
+	TArray<FGazeSampleRange>& OutRanges)
+{
+	OutRanges.Empty();
+
+	const FGazePointCloud* GazePoints = GetActiveSessionGazePoints(WorldContextObject);
+
+	if (!GazePoints || !Camera) return false;
+
+	FMinimalViewInfo ViewInfo;
+	Camera->GetCameraView(0.f, ViewInfo);
+
+	FMatrix ViewMatrix, ProjectionMatrix, ViewProjectionMatrix;
+	UGameplayStatics::GetViewProjectionMatrix(ViewInfo, ViewMatrix, ProjectionMatrix, ViewProjectionMatrix);
+
+	FConvexVolume Frustum;
+	GetViewFrustumBounds(Frustum, ViewProjectionMatrix, false);
+
+	GazePoints->QueryFrustum(Frustum, OutRanges);
+
+	return true;
+}
+
 void UHeatmapRT::GetMetricsNames(const UObject* WorldContextObject, TMap<FString, FString>& OutMetricsNames)
 {
 	if (!WorldContextObject)
@@ -483,13 +1085,12 @@ void UHeatmapRT::GetMetricsNames(const UObject* WorldContextObject, TMap<FString
 		if (!HeatmapReadyActor || !HeatmapReadyActor->bNeedsMetrics)
 			continue;
 
-		const FString& ObjectName = UKismetSystemLibrary::GetObjectName(HeatmapReadyActor);
 		const FString& MetricsName = HeatmapReadyActor->MetricsName;
 
 		if (MetricsName.IsEmpty() || MetricsName == "unset")
 			continue;
 		
-		LocalMetricsNames.Add(ObjectName, MetricsName);
+		LocalMetricsNames.Add(HeatmapReadyActor->HeatmapActorGuid.ToString(), MetricsName);
 	}
 	
 	OutMetricsNames = LocalMetricsNames;
@@ -2,12 +2,20 @@
 
 #include "HeatmapReadyActor.h"
 
+#include "Engine/Canvas.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+#include "Engine/Level.h"
 #include "Engine/TextureRenderTarget2D.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Kismet/KismetRenderingLibrary.h"
 #include "Kismet/KismetMaterialLibrary.h"
 
+#include "HeatmapActorRegistry.h"
+#include "HeatmapGrid.h"
+#include "HeatmapUvLookupCache.h"
 #include "DebugHeader.h"
+#include "AdditionalUtility.h"
 
 FColor AHeatmapReadyActor::EyesColor;
 
@@ -47,6 +55,7 @@ void AHeatmapReadyActor::SetupMaterials(UMaterialInterface* PaintBrushMaterialAs
 	CanvasInstances.Empty();
 
 	PaintBrushMaterial = UKismetMaterialLibrary::CreateDynamicMaterialInstance(this, PaintBrushMaterialAsset);
+	LastScaledFaceAxis = EHeatmapFaceAxis::EHFA_MAX;
 
 	RenderTarget = UKismetRenderingLibrary::CreateRenderTarget2D(this, 1024, 1024);
 
@@ -79,6 +88,7 @@ void AHeatmapReadyActor::SetupMaterials(UMaterialInterface* PaintBrushMaterialAs
 		StaticMeshComponent->SetMaterial(i, CanvasInstance);
 
 		CanvasInstance->SetTextureParameterValue(FName("HeatmapAlpha"), RenderTarget);
+		CanvasInstance->SetScalarParameterValue(FName("HeatmapUvChannel"), GetHeatmapUvChannel(0));
 		CanvasInstances.Add(CanvasInstance);
 	}
 }
@@ -86,6 +96,10 @@ void AHeatmapReadyActor::SetupMaterials(UMaterialInterface* PaintBrushMaterialAs
 void AHeatmapReadyActor::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Levels prepared before the scale table existed
+	if (ScaleDivisors.Num() != static_cast<int32>(EHeatmapFaceAxis::EHFA_MAX))
+		UpdateScaleDivisors();
 }
 
 void AHeatmapReadyActor::ScalePaintBrush(FVector2D ScaleDivisor) const
@@ -94,13 +108,217 @@ void AHeatmapReadyActor::ScalePaintBrush(FVector2D ScaleDivisor) const
 	
 	if (bOverrideScaleDivisor && ScaleDivisorOverride.X != 0.0 && ScaleDivisorOverride.Y != 0.0)
 		ScaleDivisor = ScaleDivisorOverride;
-	
+
+	PaintBrushScaleDivisor = ScaleDivisor;
+	LastScaledFaceAxis = EHeatmapFaceAxis::EHFA_MAX;
+	ApplyPaintBrushScale();
+}
+
+void AHeatmapReadyActor::ApplyPaintBrushScale() const
+{
+	const FVector2D ScaleDivisor = FHeatmapGrid::WeightScaleDivisor(PaintBrushScaleDivisor, PaintBrushWeight);
 	const FLinearColor NewScaleDivisorValue = FLinearColor(ScaleDivisor.X, ScaleDivisor.Y, 0.f, 1.f);
 
 	PaintBrushMaterial->SetVectorParameterValue(FName("ScaleDivisor"), NewScaleDivisorValue);
 }
 
-void AHeatmapReadyActor::PaintHeatmap(const FVector2D UV)
+void AHeatmapReadyActor::SetPaintBrushWeight(const float Weight)
+{
+	if (Weight == PaintBrushWeight) return;
+
+	PaintBrushWeight = Weight;
+	ApplyPaintBrushScale();
+}
+
+void AHeatmapReadyActor::ScalePaintBrushForFaceAxis(const EHeatmapFaceAxis FaceAxis)
+{
+	if (FaceAxis == LastScaledFaceAxis) return;
+
+	ScalePaintBrush(GetScaleDivisor(FaceAxis));
+	LastScaledFaceAxis = FaceAxis;
+}
+
+void AHeatmapReadyActor::UpdateScaleDivisors()
+{
+	ScaleDivisors.Init(FVector2D(1.0, 1.0), static_cast<int32>(EHeatmapFaceAxis::EHFA_MAX));
+	LastScaledFaceAxis = EHeatmapFaceAxis::EHFA_MAX;
+
+	const UStaticMeshComponent* StaticMeshComponent = GetComponentByClass<UStaticMeshComponent>();
+
+	if (!StaticMeshComponent || !StaticMeshComponent->GetStaticMesh()) return;
+
+	FVector Min, Max;
+	StaticMeshComponent->GetLocalBounds(Min, Max);
+
+	TArray<double> SortedBoundsAxes;
+	UAdditionalUtility::GetAxesByLength(Max, SortedBoundsAxes);
+	const float LongestAxis = SortedBoundsAxes[0] / 100.f;
+
+	const FVector MeshScale = StaticMeshComponent->GetComponentScale() * LongestAxis;
+
+	ScaleDivisors[static_cast<int32>(EHeatmapFaceAxis::EHFA_Forward)] = FVector2D(MeshScale.Y, MeshScale.Z);
+	ScaleDivisors[static_cast<int32>(EHeatmapFaceAxis::EHFA_Right)] = FVector2D(MeshScale.X, MeshScale.Y);
+	ScaleDivisors[static_cast<int32>(EHeatmapFaceAxis::EHFA_Up)] = FVector2D(MeshScale.X, MeshScale.Y);
+}
+
+EHeatmapFaceAxis AHeatmapReadyActor::GetFaceAxis(const FVector& ImpactNormal) const
+{
+	const float ForwardDot = FMath::Abs(FVector::DotProduct(ImpactNormal, GetActorForwardVector()));
+	const float RightDot = FMath::Abs(FVector::DotProduct(ImpactNormal, GetActorRightVector()));
+	const float UpDot = FMath::Abs(FVector::DotProduct(ImpactNormal, GetActorUpVector()));
+
+	if (ForwardDot >= RightDot && ForwardDot >= UpDot)
+		return EHeatmapFaceAxis::EHFA_Forward;
+
+	if (RightDot >= UpDot)
+		return EHeatmapFaceAxis::EHFA_Right;
+
+	return EHeatmapFaceAxis::EHFA_Up;
+}
+
+FVector2D AHeatmapReadyActor::GetScaleDivisor(const EHeatmapFaceAxis FaceAxis) const
+{
+	const int32 Index = static_cast<int32>(FaceAxis);
+
+	return ScaleDivisors.IsValidIndex(Index) ? ScaleDivisors[Index] : FVector2D(1.0, 1.0);
+}
+
+const FHeatmapAoiIndex& AHeatmapReadyActor::GetAoiIndex()
+{
+	if (!bAoiIndexDirty) return AoiIndex;
+
+	bAoiIndexDirty = false;
+
+	const FHeatmapUvTriangleTable* Table = FindUvTriangleTable();
+
+	const bool bHasBoxAois = Aois.ContainsByPredicate([](const FHeatmapAoi& Aoi)
+	{
+		return Aoi.Shape == EHeatmapAoiShape::EHAS_LocalBox;
+	});
+
+	if (bHasBoxAois && !Table)
+		DebugHeader::PrintWarning(GetName() + ": box AOIs need a UV lookup table, run the heatmap UV assignment first");
+
+	AoiIndex.Build(Aois, Table);
+
+	return AoiIndex;
+}
+
+const FHeatmapUvTriangleTable* AHeatmapReadyActor::FindUvTriangleTable() const
+{
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(this);
+	const AHeatmapUvLookupCache* UvLookupCache = Registry ? Registry->GetUvLookupCache() : nullptr;
+
+	return UvLookupCache && StaticMesh ? UvLookupCache->FindTable(StaticMesh->GetStaticMesh()) : nullptr;
+}
+
+bool AHeatmapReadyActor::ComputeTexelAreas(const int32 Resolution, TArray<float>& OutTexelAreas) const
+{
+	const FHeatmapUvTriangleTable* Table = FindUvTriangleTable();
+
+	if (!Table) return false;
+
+	FHeatmapGrid::ComputeTexelAreas(*Table, StaticMesh->GetComponentScale(), Resolution, OutTexelAreas);
+
+	return true;
+}
+
+bool AHeatmapReadyActor::ReadHeatmapPixels(TArray<FFloat16Color>& OutPixels) const
+{
+	if (!RenderTarget) return false;
+
+	FTextureRenderTargetResource* RenderTargetResource = RenderTarget->GameThread_GetRenderTargetResource();
+
+	return RenderTargetResource && RenderTargetResource->ReadFloat16Pixels(OutPixels);
+}
+
+bool AHeatmapReadyActor::EnqueueHeatmapPixelsRead(TArray<FFloat16Color>& OutPixels) const
+{
+	if (!RenderTarget) return false;
+
+	FTextureRenderTargetResource* RenderTargetResource = RenderTarget->GameThread_GetRenderTargetResource();
+
+	if (!RenderTargetResource) return false;
+
+	const FIntRect Rect(0, 0, RenderTarget->SizeX, RenderTarget->SizeY);
+	TArray<FFloat16Color>* Pixels = &OutPixels;
+
+	ENQUEUE_RENDER_COMMAND(ReadHeatmapPixels)(
+		[RenderTargetResource, Rect, Pixels](FRHICommandListImmediate& RHICmdList)
+		{
+			RHICmdList.ReadSurfaceFloatData(RenderTargetResource->GetRenderTargetTexture(), Rect, *Pixels,
+				CubeFace_PosX, 0, 0);
+		});
+
+	return true;
+}
+
+bool AHeatmapReadyActor::WriteHeatmapPixels(TArray<FFloat16Color>&& Pixels)
+{
+	if (!RenderTarget || Pixels.Num() != RenderTarget->SizeX * RenderTarget->SizeY) return false;
+
+	FTextureRenderTargetResource* RenderTargetResource = RenderTarget->GameThread_GetRenderTargetResource();
+
+	if (!RenderTargetResource) return false;
+
+	const uint32 SizeX = RenderTarget->SizeX;
+	const uint32 SizeY = RenderTarget->SizeY;
+
+	ENQUEUE_RENDER_COMMAND(WriteHeatmapPixels)(
+		[RenderTargetResource, SizeX, SizeY, Pixels = MoveTemp(Pixels)](FRHICommandListImmediate& RHICmdList)
+		{
+			const FUpdateTextureRegion2D Region(0, 0, 0, 0, SizeX, SizeY);
+
+			RHIUpdateTexture2D(RenderTargetResource->GetRenderTargetTexture(), 0, Region,
+				SizeX * sizeof(FFloat16Color), reinterpret_cast<const uint8*>(Pixels.GetData()));
+		});
+
+	return true;
+}
+
+void AHeatmapReadyActor::ClearHeatmap()
+{
+	if (RenderTarget)
+		UKismetRenderingLibrary::ClearRenderTarget2D(this, RenderTarget, FLinearColor::Transparent);
+}
+
+int32 AHeatmapReadyActor::GetHeatmapResolution() const
+{
+	return RenderTarget ? RenderTarget->SizeX : 0;
+}
+
+FString AHeatmapReadyActor::GetPaintBrushMaterialPath() const
+{
+	return PaintBrushMaterial && PaintBrushMaterial->Parent ? PaintBrushMaterial->Parent->GetPathName() : FString();
+}
+
+FVector2D AHeatmapReadyActor::GetPaintBrushScaleDivisor(const EHeatmapFaceAxis FaceAxis) const
+{
+	if (bOverrideScaleDivisor && ScaleDivisorOverride.X != 0.0 && ScaleDivisorOverride.Y != 0.0)
+		return ScaleDivisorOverride;
+
+	return GetScaleDivisor(FaceAxis);
+}
+
+EHeatmapFaceAxis AHeatmapReadyActor::FindFaceAxisForScaleDivisor(const FVector2D& ScaleDivisor) const
+{
+	EHeatmapFaceAxis ClosestFaceAxis = EHeatmapFaceAxis::EHFA_Forward;
+	double ClosestDistanceSquared = TNumericLimits<double>::Max();
+
+	for (int32 i = 0; i < ScaleDivisors.Num(); ++i)
+	{
+		const double DistanceSquared = FVector2D::DistSquared(ScaleDivisors[i], ScaleDivisor);
+
+		if (DistanceSquared >= ClosestDistanceSquared) continue;
+
+		ClosestDistanceSquared = DistanceSquared;
+		ClosestFaceAxis = static_cast<EHeatmapFaceAxis>(i);
+	}
+
+	return ClosestFaceAxis;
+}
+
+void AHeatmapReadyActor::PaintHeatmap(const FVector2D UV, const float Weight)
 {
 	if (!PaintBrushMaterial)
 	{
@@ -111,12 +329,46 @@ void AHeatmapReadyActor::PaintHeatmap(const FVector2D UV)
 	const FLinearColor NewPositionValue = FLinearColor(UV.X, UV.Y, 0.f, 2.f);
 
 	PaintBrushMaterial->SetVectorParameterValue(FName("Position"), NewPositionValue);
+	SetPaintBrushWeight(Weight);
 
 	if (!RenderTarget) DebugHeader::Print("RenderTarget invalid", FColor::Red, 2.f);
 	
 	UKismetRenderingLibrary::DrawMaterialToRenderTarget(this, RenderTarget, PaintBrushMaterial);
 }
 
+void AHeatmapReadyActor::PaintHeatmapRun(const FVector2D UV, const int32 SampleCount, const float Weight)
+{
+	if (SampleCount <= 1)
+	{
+		PaintHeatmap(UV, Weight);
+		return;
+	}
+	
+	if (!PaintBrushMaterial || !RenderTarget)
+	{
+		DebugHeader::Print("PaintBrushMaterial or RenderTarget invalid", FColor::Red, 5.f);
+		return;
+	}
+
+	const FLinearColor NewPositionValue = FLinearColor(UV.X, UV.Y, 0.f, 2.f);
+
+	PaintBrushMaterial->SetVectorParameterValue(FName("Position"), NewPositionValue);
+	SetPaintBrushWeight(Weight);
+
+	// One canvas pass for the whole run, instead of a render target round trip per sample
+	UCanvas* DrawCanvas;
+	FVector2D DrawSize;
+	FDrawToRenderTargetContext DrawContext;
+	
+	UKismetRenderingLibrary::BeginDrawCanvasToRenderTarget(this, RenderTarget, DrawCanvas, DrawSize, DrawContext);
+
+	// The draw is ended even without a canvas, so the context doesn't leak into the next one
+	for (int32 i = 0; DrawCanvas && i < SampleCount; ++i)
+		DrawCanvas->K2_DrawMaterial(PaintBrushMaterial, FVector2D::ZeroVector, DrawSize, FVector2D::ZeroVector);
+
+	UKismetRenderingLibrary::EndDrawCanvasToRenderTarget(this, DrawContext);
+}
+
 TArray<UMaterialInterface*> AHeatmapReadyActor::GetMaterials()
 {
 	return Materials;
@@ -141,6 +393,69 @@ void AHeatmapReadyActor::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 }
 
+void AHeatmapReadyActor::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	if (!HeatmapActorGuid.IsValid())
+	{
+		HeatmapActorGuid = FGuid::NewGuid();
+		LegacyObjectNames.AddUnique(GetName());
+	}
+
+	UpdateScaleDivisors();
+}
+
+void AHeatmapReadyActor::PostLoad()
+{
+	Super::PostLoad();
+
+	// Actors saved before GUIDs existed get one derived from their path, so it's the same on every load
+	if (!HeatmapActorGuid.IsValid() && !HasAnyFlags(RF_ClassDefaultObject))
+	{
+		HeatmapActorGuid = FGuid::NewDeterministicGuid(GetPathName());
+		LegacyObjectNames.AddUnique(GetName());
+	}
+}
+
+void AHeatmapReadyActor::PostDuplicate(EDuplicateMode::Type DuplicateMode)
+{
+	Super::PostDuplicate(DuplicateMode);
+
+	// PIE copies and copies of whole levels keep the identity recorded sessions refer to,
+	// only a second actor with the same GUID in one level becomes a new actor
+	if (DuplicateMode == EDuplicateMode::PIE || !HasGuidTwinInLevel()) return;
+
+	HeatmapActorGuid = FGuid::NewGuid();
+	LegacyObjectNames.Reset();
+}
+
+bool AHeatmapReadyActor::HasGuidTwinInLevel() const
+{
+	const ULevel* Level = GetLevel();
+
+	if (!Level) return false;
+
+	for (const AActor* Actor : Level->Actors)
+	{
+		const AHeatmapReadyActor* HeatmapReadyActor = Cast<AHeatmapReadyActor>(Actor);
+
+		if (HeatmapReadyActor && HeatmapReadyActor != this && HeatmapReadyActor->HeatmapActorGuid == HeatmapActorGuid)
+			return true;
+	}
+
+	return false;
+}
+
+void AHeatmapReadyActor::PostEditImport()
+{
+	Super::PostEditImport();
+
+	// Pasted actors
+	HeatmapActorGuid = FGuid::NewGuid();
+	LegacyObjectNames = { GetName() };
+}
+
 void AHeatmapReadyActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
@@ -148,6 +463,12 @@ void AHeatmapReadyActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyC
 	const FName PropertyName = PropertyChangedEvent.Property != nullptr ?
 		PropertyChangedEvent.Property->GetFName() : NAME_None;
 
+	const FName MemberPropertyName = PropertyChangedEvent.MemberProperty != nullptr ?
+		PropertyChangedEvent.MemberProperty->GetFName() : NAME_None;
+
+	if (MemberPropertyName == GET_MEMBER_NAME_CHECKED(AHeatmapReadyActor, Aois))
+		InvalidateAoiIndex();
+
 	if (PropertyName == GET_MEMBER_NAME_CHECKED(AHeatmapReadyActor, MetricsName))
 	{
 		if (MetricsName == "unset" || MetricsName.IsEmpty())
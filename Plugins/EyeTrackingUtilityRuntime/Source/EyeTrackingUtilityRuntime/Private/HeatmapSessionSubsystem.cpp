@@ -0,0 +1,927 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "HeatmapSessionSubsystem.h"
+
+#include "TimerManager.h"
+#include "RenderingThread.h"
+#include "Algo/BinarySearch.h"
+
+#include "HeatmapReadyActor.h"
+#include "HeatmapActorRegistry.h"
+#include "HeatmapBakeCache.h"
+#include "HeatmapGrid.h"
+#include "AttentionVolume.h"
+#include "GazePointCloud.h"
+#include "HeatmapVisibility.h"
+#include "JsonParser.h"
+#include "DebugHeader.h"
+
+void UHeatmapSessionSubsystem::Deinitialize()
+{
+	TArray<int32> SessionHandles;
+	Sessions.GetKeys(SessionHandles);
+
+	for (const int32 SessionHandle : SessionHandles)
+		StopSession(SessionHandle);
+
+	Sessions.Empty();
+	ActiveSessionHandle = INDEX_NONE;
+
+	if (const UWorld* World = GetWorld())
+	{
+		for (TPair<FName, FTimerHandle>& Timer : BlendParameterTimerHandles)
+			World->GetTimerManager().ClearTimer(Timer.Value);
+	}
+
+	BlendParameterTimerHandles.Empty();
+
+	Super::Deinitialize();
+}
+
+UHeatmapSessionSubsystem* UHeatmapSessionSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (!WorldContextObject) return nullptr;
+
+	const UWorld* World = WorldContextObject->GetWorld();
+
+	return World ? World->GetSubsystem<UHeatmapSessionSubsystem>() : nullptr;
+}
+
+int32 UHeatmapSessionSubsystem::LoadSession(const FString& FileName, const float MetricsThreshold)
+{
+	bool bOutSuccess;
+	FString FilePath = UJsonParser::AttentionTrackingDataFolderPath();
+	FilePath.Append(FileName);
+
+	FHeatmapSession Session;
+	Session.FileName = FileName;
+	
+	TMap<int32, FVector2D> LegacyScaleDivisors;
+	
+	UJsonParser::ReadAttentionTrackingDataFromJsonFile(FilePath,
+		Session.AttentionTrackingData, LegacyScaleDivisors, bOutSuccess);
+
+	if (!bOutSuccess)
+	{
+		DebugHeader::ShowNotifyInfo("Failed to load heatmap from " + FilePath);
+		return INDEX_NONE;
+	}
+
+	UHeatmapRT::ResolveLegacyActorGuids(Session.AttentionTrackingData, this);
+
+	if (!LegacyScaleDivisors.IsEmpty())
+		UHeatmapRT::ResolveLegacyScaleDivisors(Session.AttentionTrackingData, LegacyScaleDivisors, this);
+
+	// Files recorded before run-length compression contain one entry per frame
+	UHeatmapRT::CompressAttentionTrackingData(Session.AttentionTrackingData);
+
+	Session.ContentHash = FHeatmapBakeCache::ComputeSessionHash(Session.AttentionTrackingData);
+
+	const TSharedPtr<FAttentionVolume> AttentionVolume = MakeShared<FAttentionVolume>();
+
+	if (AttentionVolume->LoadFromFile(FAttentionVolume::GetSidecarFilePath(FilePath)))
+		Session.AttentionVolume = AttentionVolume;
+
+	const TSharedPtr<FGazePointCloud> GazePoints = MakeShared<FGazePointCloud>();
+
+	if (GazePoints->LoadFromFile(FGazePointCloud::GetSidecarFilePath(FilePath)))
+		Session.GazePoints = GazePoints;
+
+	bool bVisibleTimesRead;
+	Session.VisibleTimes = UJsonParser::ReadFloatMapFromJsonFile(FHeatmapVisibilityTracker::GetSidecarFilePath(FilePath),
+		bVisibleTimesRead);
+
+	bool bSegmentMarkersRead;
+	Session.SegmentMarkers = UJsonParser::ReadSegmentMarkersFromJsonFile(UJsonParser::SegmentMarkersFilePath(FilePath),
+		bSegmentMarkersRead);
+
+	TMap<FString, FString> MetricsNames;
+	UHeatmapRT::GetMetricsNames(this, MetricsNames);
+	UHeatmapRT::ComputeAttentionMetrics(Session.AttentionTrackingData, MetricsNames, MetricsThreshold,
+		Session.SegmentMarkers, Session.AttentionMetrics, Session.SegmentMetrics);
+	UHeatmapRT::ComputeDensityMetrics(Session.AttentionTrackingData, MetricsNames, this, Session.AttentionMetrics);
+	UHeatmapRT::ApplyVisibleTimes(Session.VisibleTimes, Session.AttentionMetrics);
+	UHeatmapRT::ComputeAoiMetrics(Session.AttentionTrackingData, MetricsNames, this, MetricsThreshold, Session.AoiMetrics);
+
+	const int32 SessionHandle = AddSession(MoveTemp(Session));
+	ActiveSessionHandle = SessionHandle;
+
+	return SessionHandle;
+}
+
+int32 UHeatmapSessionSubsystem::AddSession(FHeatmapSession&& Session)
+{
+	const int32 SessionHandle = NextSessionHandle++;
+	Sessions.Add(SessionHandle, MoveTemp(Session));
+
+	return SessionHandle;
+}
+
+void UHeatmapSessionSubsystem::UnloadSession(const int32 SessionHandle)
+{
+	if (!Sessions.Contains(SessionHandle)) return;
+
+	StopSession(SessionHandle);
+	Sessions.Remove(SessionHandle);
+
+	if (ActiveSessionHandle == SessionHandle)
+		ActiveSessionHandle = INDEX_NONE;
+}
+
+void UHeatmapSessionSubsystem::SetActiveSession(const int32 SessionHandle)
+{
+	if (!Sessions.Contains(SessionHandle))
+	{
+		DebugHeader::PrintWarning("UHeatmapSessionSubsystem::SetActiveSession: Unknown session handle");
+		return;
+	}
+
+	ActiveSessionHandle = SessionHandle;
+}
+
+void UHeatmapSessionSubsystem::GetLoadedSessions(TArray<int32>& OutSessionHandles) const
+{
+	Sessions.GetKeys(OutSessionHandles);
+}
+
+void UHeatmapSessionSubsystem::PaintSession(const int32 SessionHandle, const bool bLoadImmediately)
+{
+	FHeatmapSession* Session = FindSession(SessionHandle);
+	
+	if (!Session || Session->AttentionTrackingData.IsEmpty())
+	{
+		DebugHeader::ShowNotifyInfo("No heatmap loaded");
+		return;
+	}
+
+	const UWorld* World = GetWorld();
+
+	if (!World)
+	{
+		DebugHeader::PrintError("UHeatmapSessionSubsystem::PaintSession: World Ref invalid");
+		return;
+	}
+
+	StopSession(SessionHandle);
+	Session->LastActorPaintedOn = nullptr;
+	Session->PlaybackIndex = 0;
+
+	if (bLoadImmediately)
+	{
+		Session->TemporalAccumulator.Reset();
+		PaintSessionImmediately(*Session, SessionHandle);
+
+		Session->LastActorPaintedOn = nullptr;
+		Session->PlaybackIndex = Session->AttentionTrackingData.Num();
+		return;
+	}
+
+	ResetTemporalAccumulator(*Session);
+
+	// The temporal modes overwrite what they show, so nothing cumulative may linger on the other actors
+	if (Session->TemporalAccumulator)
+	{
+		TSet<AHeatmapReadyActor*> SessionActors;
+		GetSessionActors(*Session, SessionActors);
+
+		for (AHeatmapReadyActor* Actor : SessionActors)
+			Actor->ClearHeatmap();
+	}
+
+	SchedulePlayback(*Session, SessionHandle, 0, 0.f);
+}
+
+void UHeatmapSessionSubsystem::PaintSessionImmediately(FHeatmapSession& Session, const int32 SessionHandle)
+{
+	if (Session.ContentHash.IsEmpty())
+		Session.ContentHash = FHeatmapBakeCache::ComputeSessionHash(Session.AttentionTrackingData);
+
+	// Group by actor first, a bake only makes sense for an actor's complete set of points
+	TMap<AHeatmapReadyActor*, TArray<int32>> DataPointIndicesByActor;
+
+	for (int32 i = 0; i < Session.AttentionTrackingData.Num(); ++i)
+	{
+		if (AHeatmapReadyActor* Actor = ResolveActor(Session.AttentionTrackingData[i]))
+			DataPointIndicesByActor.FindOrAdd(Actor).Add(i);
+	}
+
+	int32 CacheHits = 0;
+	TArray<AHeatmapReadyActor*> BakedActors;
+
+	for (TPair<AHeatmapReadyActor*, TArray<int32>>& ActorDataPoints : DataPointIndicesByActor)
+	{
+		AHeatmapReadyActor* Actor = ActorDataPoints.Key;
+		const FString Key = FHeatmapBakeCache::MakeKey(Session.ContentHash, Actor);
+
+		TArray<FFloat16Color> Pixels;
+
+		if (FHeatmapBakeCache::Load(Key, Actor->GetHeatmapResolution(), Pixels) &&
+			Actor->WriteHeatmapPixels(MoveTemp(Pixels)))
+		{
+			++CacheHits;
+			continue;
+		}
+
+		// Start from a blank target so the bake holds exactly this session
+		Actor->ClearHeatmap();
+
+		for (const int32 DataPointIndex : ActorDataPoints.Value)
+			PaintDataPoint(SessionHandle, Session.AttentionTrackingData[DataPointIndex]);
+
+		BakedActors.Add(Actor);
+	}
+
+	// All reads queue behind the paints, one flush waits for them together
+	TArray<TArray<FFloat16Color>> BakedPixels;
+	BakedPixels.SetNum(BakedActors.Num());
+
+	for (int32 i = 0; i < BakedActors.Num(); ++i)
+		BakedActors[i]->EnqueueHeatmapPixelsRead(BakedPixels[i]);
+
+	if (!BakedActors.IsEmpty())
+		FlushRenderingCommands();
+
+	for (int32 i = 0; i < BakedActors.Num(); ++i)
+	{
+		const int32 Resolution = BakedActors[i]->GetHeatmapResolution();
+
+		if (BakedPixels[i].Num() == Resolution * Resolution)
+			FHeatmapBakeCache::Save(FHeatmapBakeCache::MakeKey(Session.ContentHash, BakedActors[i]), Resolution,
+				BakedPixels[i]);
+	}
+
+	if (!BakedActors.IsEmpty())
+		FHeatmapBakeCache::Trim();
+
+	DebugHeader::PrintLog(FString::Printf(TEXT("Baked heatmaps: %d of %d actors loaded from cache"),
+		CacheHits, DataPointIndicesByActor.Num()));
+}
+
+void UHeatmapSessionSubsystem::SchedulePlayback(FHeatmapSession& Session, const int32 SessionHandle,
+	const int32 FirstIndex, const float StartTime)
+{
+	const UWorld* World = GetWorld();
+
+	if (!World) return;
+
+	const int32 Num = Session.AttentionTrackingData.Num();
+
+	Session.HeatmapTimerHandles.SetNum(Num);
+
+	for (int32 i = FirstIndex; i < Num; ++i)
+	{
+		// A non-positive rate would clear the timer instead of firing it
+		const float DelayTime =
+			FMath::Max(Session.AttentionTrackingData[i].TimePassedSinceRecordingStarted - StartTime, KINDA_SMALL_NUMBER);
+		
+		FTimerDelegate TimerDelegate;
+
+		TimerDelegate.BindWeakLambda(this, [this, SessionHandle, i]()
+		{
+			OnPlaybackDataPoint(SessionHandle, i);
+		});
+		
+		World->GetTimerManager().SetTimer(Session.HeatmapTimerHandles[i], TimerDelegate, DelayTime, false);
+	}
+
+	Session.PlaybackStartWorldTime = World->GetTimeSeconds() - StartTime;
+
+	StartTemporalDisplay(Session, SessionHandle);
+}
+
+void UHeatmapSessionSubsystem::StartTemporalDisplay(FHeatmapSession& Session, const int32 SessionHandle)
+{
+	const UWorld* World = GetWorld();
+
+	if (!World || !Session.TemporalAccumulator ||
+		World->GetTimerManager().IsTimerActive(Session.TemporalDisplayTimerHandle))
+		return;
+
+	FTimerDelegate DisplayDelegate;
+
+	DisplayDelegate.BindWeakLambda(this, [this, SessionHandle]()
+	{
+		UpdateTemporalHeatmap(SessionHandle);
+	});
+
+	World->GetTimerManager().SetTimer(Session.TemporalDisplayTimerHandle, DisplayDelegate, TemporalDisplayInterval, true);
+}
+
+void UHeatmapSessionSubsystem::OnPlaybackDataPoint(const int32 SessionHandle, const int32 DataPointIndex)
+{
+	FHeatmapSession* Session = FindSession(SessionHandle);
+
+	if (!Session || !Session->AttentionTrackingData.IsValidIndex(DataPointIndex)) return;
+
+	Session->PlaybackIndex = DataPointIndex + 1;
+
+	if (Session->TemporalAccumulator)
+	{
+		AddTemporalSample(*Session, Session->AttentionTrackingData[DataPointIndex]);
+
+		// The display stops while nothing is live, e.g. during a long gap in the recording
+		StartTemporalDisplay(*Session, SessionHandle);
+		return;
+	}
+
+	PaintDataPoint(SessionHandle, Session->AttentionTrackingData[DataPointIndex]);
+
+	if (SnapshotInterval <= 0.f) return;
+
+	// Only the first pass over a stretch of the recording captures, later passes reuse its snapshots
+	if (Session->PlaybackIndex > Session->LastSnapshotAttemptIndex &&
+		Session->AttentionTrackingData[DataPointIndex].TimePassedSinceRecordingStarted -
+		Session->LastSnapshotAttemptTime >= SnapshotInterval)
+		CaptureSnapshot(SessionHandle);
+}
+
+void UHeatmapSessionSubsystem::CaptureSnapshot(const int32 SessionHandle)
+{
+	FHeatmapSession* Session = FindSession(SessionHandle);
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(this);
+
+	if (!Session || !Registry || Session->PlaybackIndex <= 0) return;
+
+	const int32 NextDataPointIndex = Session->PlaybackIndex;
+	const float Time = Session->AttentionTrackingData[NextDataPointIndex - 1].TimePassedSinceRecordingStarted;
+
+	if (NextDataPointIndex > Session->LastSnapshotAttemptIndex)
+	{
+		Session->LastSnapshotAttemptIndex = NextDataPointIndex;
+		Session->LastSnapshotAttemptTime = Time;
+	}
+
+	const int32 InsertIndex = Algo::LowerBoundBy(Session->Snapshots, NextDataPointIndex,
+		[](const FHeatmapSnapshot& Snapshot) { return Snapshot.NextDataPointIndex; });
+
+	if (Session->Snapshots.IsValidIndex(InsertIndex) &&
+		Session->Snapshots[InsertIndex].NextDataPointIndex == NextDataPointIndex)
+		return;
+
+	if (Session->ContentHash.IsEmpty())
+		Session->ContentHash = FHeatmapBakeCache::ComputeSessionHash(Session->AttentionTrackingData);
+
+	FHeatmapSnapshot Snapshot;
+	Snapshot.Time = Time;
+	Snapshot.NextDataPointIndex = NextDataPointIndex;
+
+	// Walk back to the last full snapshot, a full one is due once the deltas since then reach the interval
+	int32 FullIndex = InsertIndex - 1;
+
+	while (FullIndex >= 0 && !Session->Snapshots[FullIndex].bFull)
+		--FullIndex;
+
+	Snapshot.bFull = FullIndex < 0 || InsertIndex - FullIndex >= FullSnapshotInterval;
+
+	const int32 FirstDataPointIndex = InsertIndex > 0 ? Session->Snapshots[InsertIndex - 1].NextDataPointIndex : 0;
+
+	TSet<AHeatmapReadyActor*> CapturedActors;
+
+	for (int32 i = FirstDataPointIndex; i < NextDataPointIndex; ++i)
+	{
+		if (AHeatmapReadyActor* Actor = ResolveActor(Session->AttentionTrackingData[i]))
+			CapturedActors.Add(Actor);
+	}
+
+	// Everything painted before the previous snapshot has a layer somewhere back to the last full one
+	for (int32 i = InsertIndex - 1; Snapshot.bFull && i >= FMath::Max(FullIndex, 0); --i)
+	{
+		for (const TPair<FGuid, FHeatmapSnapshotLayer>& Layer : Session->Snapshots[i].Layers)
+		{
+			if (AHeatmapReadyActor* Actor = Registry->FindActor(Layer.Key))
+				CapturedActors.Add(Actor);
+		}
+	}
+
+	// All reads queue up first, one flush waits for them together
+	const TArray<AHeatmapReadyActor*> Actors = CapturedActors.Array();
+
+	TArray<TArray<FFloat16Color>> Pixels;
+	Pixels.SetNum(Actors.Num());
+
+	for (int32 i = 0; i < Actors.Num(); ++i)
+		Actors[i]->EnqueueHeatmapPixelsRead(Pixels[i]);
+
+	if (!Actors.IsEmpty())
+		FlushRenderingCommands();
+
+	for (int32 i = 0; i < Actors.Num(); ++i)
+	{
+		FHeatmapSnapshotLayer Layer;
+		Layer.Key = FHeatmapBakeCache::MakeKey(Session->ContentHash, Actors[i]);
+		Layer.Resolution = Actors[i]->GetHeatmapResolution();
+
+		if (Pixels[i].Num() != Layer.Resolution * Layer.Resolution ||
+			!FHeatmapBakeCache::CompressPixels(Pixels[i], Layer.CompressedPixels))
+			return;
+
+		Snapshot.Layers.Add(Actors[i]->HeatmapActorGuid, MoveTemp(Layer));
+	}
+
+	Session->Snapshots.Insert(MoveTemp(Snapshot), InsertIndex);
+}
+
+void UHeatmapSessionSubsystem::ClearSnapshots(const int32 SessionHandle)
+{
+	if (FHeatmapSession* Session = FindSession(SessionHandle))
+	{
+		Session->Snapshots.Empty();
+		Session->LastSnapshotAttemptIndex = 0;
+		Session->LastSnapshotAttemptTime = 0.f;
+	}
+}
+
+void UHeatmapSessionSubsystem::SeekSession(const int32 SessionHandle, const float Time, const bool bResumePlayback)
+{
+	FHeatmapSession* Session = FindSession(SessionHandle);
+
+	if (!Session || Session->AttentionTrackingData.IsEmpty())
+	{
+		DebugHeader::ShowNotifyInfo("No heatmap loaded");
+		return;
+	}
+
+	StopSession(SessionHandle);
+	Session->LastActorPaintedOn = nullptr;
+
+	const int32 TargetIndex = Algo::UpperBoundBy(Session->AttentionTrackingData, Time,
+		[](const FAttentionTrackingDataPoint& DataPoint) { return DataPoint.TimePassedSinceRecordingStarted; });
+
+	TSet<AHeatmapReadyActor*> SessionActors;
+	GetSessionActors(*Session, SessionActors);
+
+	for (AHeatmapReadyActor* Actor : SessionActors)
+		Actor->ClearHeatmap();
+
+	ResetTemporalAccumulator(*Session);
+
+	// Only the stretch of history still visible at Time needs to be accumulated
+	if (FHeatmapTemporalAccumulator* TemporalAccumulator = Session->TemporalAccumulator.Get())
+	{
+		const float HistoryStart = Time - TemporalAccumulator->GetHistorySpan();
+
+		TemporalAccumulator->AdvanceTo(HistoryStart);
+
+		const int32 FirstIndex = Algo::LowerBoundBy(Session->AttentionTrackingData, HistoryStart,
+			[](const FAttentionTrackingDataPoint& DataPoint) { return DataPoint.TimePassedSinceRecordingStarted; });
+
+		for (int32 i = FirstIndex; i < TargetIndex; ++i)
+			AddTemporalSample(*Session, Session->AttentionTrackingData[i]);
+
+		UploadTemporalHeatmap(*Session, Time);
+
+		Session->PlaybackIndex = TargetIndex;
+
+		if (bResumePlayback)
+			SchedulePlayback(*Session, SessionHandle, TargetIndex, Time);
+
+		return;
+	}
+
+	int32 FirstIndexToPaint = 0;
+
+	// Snapshots whose layers no longer match the actors (reset brush, new render target size) are skipped
+	for (int32 i = Session->Snapshots.Num() - 1; i >= 0; --i)
+	{
+		const FHeatmapSnapshot& Snapshot = Session->Snapshots[i];
+
+		if (Snapshot.NextDataPointIndex <= TargetIndex && RestoreSnapshot(*Session, i))
+		{
+			FirstIndexToPaint = Snapshot.NextDataPointIndex;
+			break;
+		}
+	}
+
+	for (int32 i = FirstIndexToPaint; i < TargetIndex; ++i)
+		PaintDataPoint(SessionHandle, Session->AttentionTrackingData[i]);
+
+	Session->PlaybackIndex = TargetIndex;
+
+	if (bResumePlayback)
+		SchedulePlayback(*Session, SessionHandle, TargetIndex, Time);
+}
+
+bool UHeatmapSessionSubsystem::RestoreSnapshot(const FHeatmapSession& Session, const int32 SnapshotIndex)
+{
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(this);
+
+	if (!Registry) return false;
+
+	// The most recent layer of every actor, back to the last full snapshot
+	TMap<FGuid, const FHeatmapSnapshotLayer*> LatestLayers;
+
+	for (int32 i = SnapshotIndex; i >= 0; --i)
+	{
+		for (const TPair<FGuid, FHeatmapSnapshotLayer>& Layer : Session.Snapshots[i].Layers)
+		{
+			if (!LatestLayers.Contains(Layer.Key))
+				LatestLayers.Add(Layer.Key, &Layer.Value);
+		}
+
+		if (Session.Snapshots[i].bFull) break;
+	}
+
+	TArray<TPair<AHeatmapReadyActor*, const FHeatmapSnapshotLayer*>> Layers;
+
+	for (const TPair<FGuid, const FHeatmapSnapshotLayer*>& Layer : LatestLayers)
+	{
+		AHeatmapReadyActor* Actor = Registry->FindActor(Layer.Key);
+
+		if (!Actor || Actor->GetHeatmapResolution() != Layer.Value->Resolution ||
+			FHeatmapBakeCache::MakeKey(Session.ContentHash, Actor) != Layer.Value->Key)
+			return false;
+
+		Layers.Add({ Actor, Layer.Value });
+	}
+
+	TArray<FFloat16Color> Pixels;
+
+	for (const TPair<AHeatmapReadyActor*, const FHeatmapSnapshotLayer*>& Layer : Layers)
+	{
+		const int32 Resolution = Layer.Value->Resolution;
+
+		if (!FHeatmapBakeCache::UncompressPixels(Layer.Value->CompressedPixels, Resolution * Resolution, Pixels) ||
+			!Layer.Key->WriteHeatmapPixels(MoveTemp(Pixels)))
+			return false;
+	}
+
+	return true;
+}
+
+void UHeatmapSessionSubsystem::SetAccumulationMode(const EHeatmapAccumulationMode Mode, const float Seconds)
+{
+	AccumulationMode = Mode == EHeatmapAccumulationMode::EHAM_MAX ? EHeatmapAccumulationMode::EHAM_Cumulative : Mode;
+	AccumulationSeconds = FMath::Max(Seconds, KINDA_SMALL_NUMBER);
+}
+
+void UHeatmapSessionSubsystem::ResetTemporalAccumulator(FHeatmapSession& Session)
+{
+	Session.TemporalUploadScale = 0.f;
+
+	if (AccumulationMode == EHeatmapAccumulationMode::EHAM_Cumulative)
+	{
+		Session.TemporalAccumulator.Reset();
+		return;
+	}
+
+	Session.TemporalAccumulator = MakeShared<FHeatmapTemporalAccumulator>(AccumulationMode, AccumulationSeconds);
+}
+
+void UHeatmapSessionSubsystem::AddTemporalSample(FHeatmapSession& Session, const FAttentionTrackingDataPoint& DataPoint)
+{
+	const AHeatmapReadyActor* Actor = ResolveActor(DataPoint);
+
+	if (!Actor || !Session.TemporalAccumulator) return;
+
+	Session.TemporalAccumulator->AddSample(Actor->HeatmapActorGuid, DataPoint.TimePassedSinceRecordingStarted,
+		DataPoint.Coordinates,
+		FHeatmapGrid::WeightScaleDivisor(Actor->GetPaintBrushScaleDivisor(DataPoint.FaceAxis), DataPoint.Weight),
+		DataPoint.SampleCount);
+}
+
+void UHeatmapSessionSubsystem::UpdateTemporalHeatmap(const int32 SessionHandle)
+{
+	FHeatmapSession* Session = FindSession(SessionHandle);
+	const UWorld* World = GetWorld();
+
+	if (!Session || !Session->TemporalAccumulator || !World) return;
+
+	const float Time = World->GetTimeSeconds() - Session->PlaybackStartWorldTime;
+
+	UploadTemporalHeatmap(*Session, Time);
+
+	// Keep updating until the last sample has left the window (or faded), new samples restart it
+	if (Session->TemporalAccumulator->GetLiveGrids().IsEmpty())
+		World->GetTimerManager().ClearTimer(Session->TemporalDisplayTimerHandle);
+}
+
+void UHeatmapSessionSubsystem::UploadTemporalHeatmap(FHeatmapSession& Session, const float Time)
+{
+	FHeatmapTemporalAccumulator& TemporalAccumulator = *Session.TemporalAccumulator;
+
+	TemporalAccumulator.AdvanceTo(Time);
+
+	// One normalization for all actors, so they stay comparable; a single sample never saturates
+	const float ReadOutScale = TemporalAccumulator.GetReadOutScale();
+	float Max = 0.f;
+
+	for (const FGuid& ActorGuid : TemporalAccumulator.GetLiveGrids())
+		Max = FMath::Max(Max, TemporalAccumulator.GetGrids().FindChecked(ActorGuid).GetMax() * ReadOutScale);
+
+	const float Scale = ReadOutScale / FMath::Max(Max, 1.f);
+
+	// Only changed grids are uploaded, unless the normalization moved and every live grid looks different
+	TSet<FGuid> GridsToUpload;
+	TemporalAccumulator.ConsumeDirtyGrids(GridsToUpload);
+
+	if (!FMath::IsNearlyEqual(Scale, Session.TemporalUploadScale, Scale * ScaleChangeTolerance))
+	{
+		GridsToUpload.Append(TemporalAccumulator.GetLiveGrids());
+		Session.TemporalUploadScale = Scale;
+	}
+
+	UploadGrids(TemporalAccumulator.GetGrids(), Scale, false, &GridsToUpload);
+}
+
+void UHeatmapSessionSubsystem::UploadGrids(const TMap<FGuid, FHeatmapGrid>& Grids, const float Scale,
+	const bool bDiverging, const TSet<FGuid>* OnlyGrids)
+{
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(this);
+
+	if (!Registry) return;
+
+	for (const TPair<FGuid, FHeatmapGrid>& Grid : Grids)
+	{
+		if (OnlyGrids && !OnlyGrids->Contains(Grid.Key)) continue;
+
+		AHeatmapReadyActor* Actor = Registry->FindActor(Grid.Key);
+
+		if (!Actor) continue;
+
+		TArray<FFloat16Color> Pixels;
+
+		if (bDiverging)
+			Grid.Value.ToDivergingRenderTargetPixels(Pixels, Actor->GetHeatmapResolution(), Scale);
+
+		else
+			Grid.Value.ToRenderTargetPixels(Pixels, Actor->GetHeatmapResolution(), Scale);
+
+		Actor->WriteHeatmapPixels(MoveTemp(Pixels));
+	}
+}
+
+void UHeatmapSessionSubsystem::PaintCompositeSessions(const TArray<int32>& SessionHandles,
+	const bool bNormalizePerParticipant)
+{
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(this);
+
+	if (!Registry) return;
+
+	TArray<const TArray<FAttentionTrackingDataPoint>*> SessionData;
+	TArray<const TMap<FString, FAttentionMetricsEntry>*> SessionMetrics;
+	TSet<AHeatmapReadyActor*> SessionActors;
+
+	GatherSessions(SessionHandles, SessionData, SessionMetrics, SessionActors);
+
+	if (SessionData.IsEmpty())
+	{
+		DebugHeader::ShowNotifyInfo("No heatmap loaded");
+		return;
+	}
+
+	FHeatmapAccumulator Accumulator;
+
+	TArray<AHeatmapReadyActor*> Actors;
+	Registry->GetAllActors(Actors);
+
+	for (const AHeatmapReadyActor* Actor : Actors)
+		Accumulator.SetScaleDivisors(Actor);
+
+	Accumulator.AccumulateComposite(SessionData, bNormalizePerParticipant);
+
+	for (AHeatmapReadyActor* Actor : SessionActors)
+		Actor->ClearHeatmap();
+
+	float Max = 0.f;
+
+	for (const TPair<FGuid, FHeatmapGrid>& Grid : Accumulator.GetGrids())
+		Max = FMath::Max(Max, Grid.Value.GetMax());
+
+	UploadGrids(Accumulator.GetGrids(), Max > 0.f ? 1.f / Max : 0.f);
+}
+
+void UHeatmapSessionSubsystem::PaintDifferenceSessions(const TArray<int32>& SessionHandlesA,
+	const TArray<int32>& SessionHandlesB, TMap<FString, FAttentionMetricsDelta>& OutMetricsDeltas)
+{
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(this);
+
+	if (!Registry) return;
+
+	TArray<const TArray<FAttentionTrackingDataPoint>*> SessionDataA, SessionDataB;
+	TArray<const TMap<FString, FAttentionMetricsEntry>*> SessionMetricsA, SessionMetricsB;
+	TSet<AHeatmapReadyActor*> SessionActors;
+
+	GatherSessions(SessionHandlesA, SessionDataA, SessionMetricsA, SessionActors);
+	GatherSessions(SessionHandlesB, SessionDataB, SessionMetricsB, SessionActors);
+
+	if (SessionDataA.IsEmpty() || SessionDataB.IsEmpty())
+	{
+		DebugHeader::ShowNotifyInfo("Both cohorts need at least one loaded session");
+		return;
+	}
+
+	UHeatmapRT::ComputeAttentionMetricsDeltas(SessionMetricsA, SessionMetricsB, OutMetricsDeltas);
+
+	FHeatmapAccumulator AccumulatorA, AccumulatorB;
+
+	TArray<AHeatmapReadyActor*> Actors;
+	Registry->GetAllActors(Actors);
+
+	for (const AHeatmapReadyActor* Actor : Actors)
+	{
+		AccumulatorA.SetScaleDivisors(Actor);
+		AccumulatorB.SetScaleDivisors(Actor);
+	}
+
+	AccumulatorA.AccumulateComposite(SessionDataA, true);
+	AccumulatorB.AccumulateComposite(SessionDataB, true);
+
+	// Each participant sums to one, so dividing by the cohort size compares mean densities
+	const float ScaleA = 1.f / SessionDataA.Num();
+	const float ScaleB = 1.f / SessionDataB.Num();
+
+	TSet<FGuid> ActorGuids;
+
+	for (const TPair<FGuid, FHeatmapGrid>& Grid : AccumulatorA.GetGrids())
+		ActorGuids.Add(Grid.Key);
+
+	for (const TPair<FGuid, FHeatmapGrid>& Grid : AccumulatorB.GetGrids())
+		ActorGuids.Add(Grid.Key);
+
+	TMap<FGuid, FHeatmapGrid> Differences;
+	float MaxAbs = 0.f;
+
+	for (const FGuid& ActorGuid : ActorGuids)
+	{
+		FHeatmapGrid& Difference = Differences.Add(ActorGuid);
+
+		FHeatmapGrid::SignedDifference(AccumulatorA.FindGrid(ActorGuid), ScaleA, AccumulatorB.FindGrid(ActorGuid), ScaleB,
+			Difference);
+
+		MaxAbs = FMath::Max(MaxAbs, Difference.GetMaxAbs());
+	}
+
+	for (AHeatmapReadyActor* Actor : SessionActors)
+		Actor->ClearHeatmap();
+
+	UploadGrids(Differences, MaxAbs > 0.f ? 1.f / MaxAbs : 0.f, true);
+}
+
+void UHeatmapSessionSubsystem::GatherSessions(const TArray<int32>& SessionHandles,
+	TArray<const TArray<FAttentionTrackingDataPoint>*>& OutData,
+	TArray<const TMap<FString, FAttentionMetricsEntry>*>& OutMetrics, TSet<AHeatmapReadyActor*>& OutActors)
+{
+	for (const int32 SessionHandle : SessionHandles)
+	{
+		const FHeatmapSession* Session = FindSession(SessionHandle);
+
+		if (!Session || Session->AttentionTrackingData.IsEmpty()) continue;
+
+		StopSession(SessionHandle);
+		GetSessionActors(*Session, OutActors);
+
+		OutData.Add(&Session->AttentionTrackingData);
+		OutMetrics.Add(&Session->AttentionMetrics);
+	}
+}
+
+int32 UHeatmapSessionSubsystem::FindSessionByFileName(const FString& FileName) const
+{
+	for (const TPair<int32, FHeatmapSession>& Session : Sessions)
+	{
+		if (Session.Value.FileName == FileName)
+			return Session.Key;
+	}
+
+	return INDEX_NONE;
+}
+
+TArray<int32> UHeatmapSessionSubsystem::FindOrLoadSessions(const TArray<FString>& FileNames,
+	const float MetricsThreshold)
+{
+	const int32 PreviousActiveSessionHandle = ActiveSessionHandle;
+	TArray<int32> SessionHandles;
+
+	for (const FString& FileName : FileNames)
+	{
+		int32 SessionHandle = FindSessionByFileName(FileName);
+
+		if (SessionHandle == INDEX_NONE)
+			SessionHandle = LoadSession(FileName, MetricsThreshold);
+
+		if (SessionHandle != INDEX_NONE)
+			SessionHandles.Add(SessionHandle);
+	}
+
+	if (PreviousActiveSessionHandle != INDEX_NONE)
+		SetActiveSession(PreviousActiveSessionHandle);
+
+	return SessionHandles;
+}
+
+AHeatmapReadyActor* UHeatmapSessionSubsystem::ResolveActor(const FAttentionTrackingDataPoint& DataPoint)
+{
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(this);
+
+	if (!Registry) return nullptr;
+
+	const FGuid ActorGuid = DataPoint.ActorGuid.IsValid() ?
+		DataPoint.ActorGuid : Registry->FindGuidByObjectName(DataPoint.ObjectName);
+
+	return Registry->FindActor(ActorGuid);
+}
+
+void UHeatmapSessionSubsystem::GetSessionActors(const FHeatmapSession& Session, TSet<AHeatmapReadyActor*>& OutActors)
+{
+	for (const FAttentionTrackingDataPoint& DataPoint : Session.AttentionTrackingData)
+	{
+		if (AHeatmapReadyActor* Actor = ResolveActor(DataPoint))
+			OutActors.Add(Actor);
+	}
+}
+
+void UHeatmapSessionSubsystem::StopSession(const int32 SessionHandle)
+{
+	FHeatmapSession* Session = FindSession(SessionHandle);
+	const UWorld* World = GetWorld();
+
+	if (!Session || !World) return;
+
+	for (FTimerHandle& TimerHandle : Session->HeatmapTimerHandles)
+	{
+		if (TimerHandle.IsValid())
+			World->GetTimerManager().ClearTimer(TimerHandle);
+	}
+
+	Session->HeatmapTimerHandles.Empty();
+
+	World->GetTimerManager().ClearTimer(Session->TemporalDisplayTimerHandle);
+}
+
+void UHeatmapSessionSubsystem::CalculateSessionMetrics(const int32 SessionHandle,
+	const TMap<FString, FString>& MetricsNames, const float Threshold)
+{
+	FHeatmapSession* Session = FindSession(SessionHandle);
+
+	if (!Session)
+	{
+		DebugHeader::ShowNotifyInfo("No heatmap loaded");
+		return;
+	}
+
+	// Maps built before actors carried a GUID are keyed by object name, those keys are resolved to the GUID
+	// and kept as well for data points that never resolved
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(this);
+	TMap<FString, FString> GuidMetricsNames = MetricsNames;
+
+	for (const TPair<FString, FString>& MetricsName : MetricsNames)
+	{
+		FGuid ActorGuid;
+
+		if (FGuid::Parse(MetricsName.Key, ActorGuid) || !Registry) continue;
+
+		ActorGuid = Registry->FindGuidByObjectName(MetricsName.Key);
+
+		if (ActorGuid.IsValid())
+			GuidMetricsNames.FindOrAdd(ActorGuid.ToString(), MetricsName.Value);
+	}
+
+	UHeatmapRT::ComputeAttentionMetrics(Session->AttentionTrackingData, GuidMetricsNames, Threshold,
+		Session->SegmentMarkers, Session->AttentionMetrics, Session->SegmentMetrics);
+	UHeatmapRT::ComputeDensityMetrics(Session->AttentionTrackingData, GuidMetricsNames, this, Session->AttentionMetrics);
+	UHeatmapRT::ApplyVisibleTimes(Session->VisibleTimes, Session->AttentionMetrics);
+	UHeatmapRT::ComputeAoiMetrics(Session->AttentionTrackingData, GuidMetricsNames, this, Threshold, Session->AoiMetrics);
+}
+
+void UHeatmapSessionSubsystem::SortSessionMetrics(const int32 SessionHandle, ESortMode SortMode, bool bAscending)
+{
+	if (FHeatmapSession* Session = FindSession(SessionHandle))
+		UHeatmapRT::SortAttentionMetricsMap(Session->AttentionMetrics, SortMode, bAscending);
+}
+
+void UHeatmapSessionSubsystem::GetSessionData(const int32 SessionHandle,
+	TArray<FAttentionTrackingDataPoint>& OutData) const
+{
+	const FHeatmapSession* Session = FindSession(SessionHandle);
+	
+	OutData = Session ? Session->AttentionTrackingData : TArray<FAttentionTrackingDataPoint>();
+}
+
+void UHeatmapSessionSubsystem::GetSessionMetrics(const int32 SessionHandle,
+	TMap<FString, FAttentionMetricsEntry>& OutMetrics) const
+{
+	const FHeatmapSession* Session = FindSession(SessionHandle);
+
+	OutMetrics = Session ? Session->AttentionMetrics : TMap<FString, FAttentionMetricsEntry>();
+}
+
+void UHeatmapSessionSubsystem::PaintDataPoint(const int32 SessionHandle, const FAttentionTrackingDataPoint& DataPoint)
+{
+	FHeatmapSession* Session = FindSession(SessionHandle);
+	
+	TWeakObjectPtr<AHeatmapReadyActor>& LastActorPaintedOn =
+		Session ? Session->LastActorPaintedOn : LastActorPaintedOutsideSession;
+
+	AHeatmapReadyActor* Actor = LastActorPaintedOn.Get();
+	
+	if (!Actor || Actor->HeatmapActorGuid != DataPoint.ActorGuid)
+	{
+		Actor = ResolveActor(DataPoint);
+		LastActorPaintedOn = Actor;
+	}
+
+	if (!Actor) return;
+
+	Actor->ScalePaintBrushForFaceAxis(DataPoint.FaceAxis);
+	Actor->PaintHeatmapRun(DataPoint.Coordinates, DataPoint.SampleCount, DataPoint.Weight);
+}
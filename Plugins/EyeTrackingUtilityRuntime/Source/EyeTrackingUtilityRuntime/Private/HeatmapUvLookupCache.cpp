@@ -0,0 +1,75 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "HeatmapUvLookupCache.h"
+
+#include "PhysicsEngine/BodySetup.h"
+
+#include "HeatmapActorRegistry.h"
+
+bool FHeatmapUvTriangleTable::FindUv(const int32 FaceIndex, const FVector& LocalPosition, FVector2D& OutUv) const
+{
+	if (FaceIndex < 0 || FaceIndex * 3 + 2 >= Indices.Num()) return false;
+
+	const uint32 IndexA = Indices[FaceIndex * 3];
+	const uint32 IndexB = Indices[FaceIndex * 3 + 1];
+	const uint32 IndexC = Indices[FaceIndex * 3 + 2];
+
+	if (!Positions.IsValidIndex(FMath::Max3(IndexA, IndexB, IndexC))) return false;
+
+	const FVector Barycentric = FMath::ComputeBaryCentric2D(LocalPosition,
+		FVector(Positions[IndexA]), FVector(Positions[IndexB]), FVector(Positions[IndexC]));
+
+	OutUv = FVector2D(Uvs[IndexA]) * Barycentric.X +
+		FVector2D(Uvs[IndexB]) * Barycentric.Y +
+		FVector2D(Uvs[IndexC]) * Barycentric.Z;
+
+	return true;
+}
+
+const FHeatmapUvTriangleTable* AHeatmapUvLookupCache::FindTable(const UStaticMesh* StaticMesh) const
+{
+	return Tables.Find(StaticMesh);
+}
+
+void AHeatmapUvLookupCache::SetTable(UStaticMesh* StaticMesh, FHeatmapUvTriangleTable&& Table)
+{
+	if (!StaticMesh) return;
+
+	Modify();
+	Tables.Add(StaticMesh, MoveTemp(Table));
+}
+
+bool AHeatmapUvLookupCache::FindCollisionUv(const FHitResult& HitResult, const int32 UvChannel, FVector2D& OutUv)
+{
+	const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(HitResult.GetComponent());
+
+	if (!StaticMeshComponent || HitResult.FaceIndex == INDEX_NONE) return false;
+
+	UHeatmapActorRegistry* Registry = UHeatmapActorRegistry::Get(StaticMeshComponent);
+
+	return FindCollisionUv(Registry ? Registry->GetUvLookupCache() : nullptr, HitResult, UvChannel, OutUv);
+}
+
+bool AHeatmapUvLookupCache::FindCollisionUv(const AHeatmapUvLookupCache* UvLookupCache, const FHitResult& HitResult,
+	const int32 UvChannel, FVector2D& OutUv)
+{
+	const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(HitResult.GetComponent());
+
+	if (!UvLookupCache || !StaticMeshComponent || HitResult.FaceIndex == INDEX_NONE) return false;
+
+	const FHeatmapUvTriangleTable* Table = UvLookupCache->FindTable(StaticMeshComponent->GetStaticMesh());
+
+	if (!Table || Table->UvChannel != UvChannel) return false;
+
+	// Cooking may drop degenerate triangles, the remap table leads back to the source face
+	int32 FaceIndex = HitResult.FaceIndex;
+	const UBodySetup* BodySetup = StaticMeshComponent->GetBodySetup();
+
+	if (BodySetup && BodySetup->FaceRemap.IsValidIndex(FaceIndex))
+		FaceIndex = BodySetup->FaceRemap[FaceIndex];
+
+	const FVector LocalPosition =
+		StaticMeshComponent->GetComponentTransform().InverseTransformPosition(HitResult.Location);
+
+	return Table->FindUv(FaceIndex, LocalPosition, OutUv);
+}
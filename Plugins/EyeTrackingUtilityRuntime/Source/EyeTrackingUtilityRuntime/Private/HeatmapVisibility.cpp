@@ -0,0 +1,173 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "HeatmapVisibility.h"
+
+#include "Kismet/GameplayStatics.h"
+#include "Components/PrimitiveComponent.h"
+#include "Math/VectorRegister.h"
+
+#include "HeatmapReadyActor.h"
+
+void FHeatmapVisibilityTracker::Init(const UObject* WorldContextObject)
+{
+	Primitives.Reset();
+	MetricsNameIndices.Reset();
+	MetricsNames.Reset();
+
+	TArray<float>* const Columns[] = { &CenterX, &CenterY, &CenterZ, &ExtentX, &ExtentY, &ExtentZ };
+
+	for (TArray<float>* Column : Columns)
+		Column->Reset();
+
+	TArray<AActor*> HeatmapReadyActors;
+	UGameplayStatics::GetAllActorsOfClass(WorldContextObject, AHeatmapReadyActor::StaticClass(), HeatmapReadyActors);
+
+	TMap<FString, int32> MetricsNameLookup;
+
+	for (const AActor* Actor : HeatmapReadyActors)
+	{
+		const AHeatmapReadyActor* HeatmapReadyActor = Cast<AHeatmapReadyActor>(Actor);
+
+		if (!HeatmapReadyActor || !HeatmapReadyActor->bNeedsMetrics) continue;
+
+		const FString& MetricsName = HeatmapReadyActor->MetricsName;
+
+		if (MetricsName.IsEmpty() || MetricsName == "unset") continue;
+
+		int32* MetricsNameIndex = MetricsNameLookup.Find(MetricsName);
+
+		if (!MetricsNameIndex)
+			MetricsNameIndex = &MetricsNameLookup.Add(MetricsName, MetricsNames.Add(MetricsName));
+
+		const FBox Bounds = HeatmapReadyActor->GetComponentsBoundingBox();
+
+		if (!Bounds.IsValid) continue;
+
+		const FVector Center = Bounds.GetCenter();
+		const FVector Extent = Bounds.GetExtent();
+
+		CenterX.Add(Center.X);
+		CenterY.Add(Center.Y);
+		CenterZ.Add(Center.Z);
+		ExtentX.Add(Extent.X);
+		ExtentY.Add(Extent.Y);
+		ExtentZ.Add(Extent.Z);
+
+		Primitives.Add(HeatmapReadyActor->FindComponentByClass<UPrimitiveComponent>());
+		MetricsNameIndices.Add(*MetricsNameIndex);
+	}
+
+	const int32 PaddedNum = Align(Primitives.Num(), 4);
+
+	for (TArray<float>* Column : Columns)
+		Column->SetNumZeroed(PaddedNum);
+
+	Reset();
+}
+
+void FHeatmapVisibilityTracker::Reset()
+{
+	VisibleTimes.Reset();
+	VisibleTimes.SetNumZeroed(MetricsNames.Num());
+
+	LastVisibleFrames.Reset();
+	LastVisibleFrames.SetNumZeroed(MetricsNames.Num());
+
+	Frame = 0;
+}
+
+void FHeatmapVisibilityTracker::Update(const FConvexVolume& Frustum, const float DeltaSeconds,
+	const bool bTestOcclusion)
+{
+	if (Primitives.IsEmpty()) return;
+
+	++Frame;
+
+	struct FPlaneRegisters
+	{
+		VectorRegister4Float X, Y, Z, W;
+		VectorRegister4Float AbsX, AbsY, AbsZ;
+	};
+
+	TArray<FPlaneRegisters, TInlineAllocator<8>> Planes;
+
+	for (const FPlane& Plane : Frustum.Planes)
+	{
+		const FPlane4f FloatPlane(Plane);
+
+		Planes.Add({ VectorSetFloat1(FloatPlane.X), VectorSetFloat1(FloatPlane.Y), VectorSetFloat1(FloatPlane.Z),
+			VectorSetFloat1(FloatPlane.W), VectorSetFloat1(FMath::Abs(FloatPlane.X)),
+			VectorSetFloat1(FMath::Abs(FloatPlane.Y)), VectorSetFloat1(FMath::Abs(FloatPlane.Z)) });
+	}
+
+	const UWorld* World = nullptr;
+
+	for (int32 Block = 0; Block < CenterX.Num(); Block += 4)
+	{
+		const VectorRegister4Float Cx = VectorLoad(&CenterX[Block]);
+		const VectorRegister4Float Cy = VectorLoad(&CenterY[Block]);
+		const VectorRegister4Float Cz = VectorLoad(&CenterZ[Block]);
+		const VectorRegister4Float Ex = VectorLoad(&ExtentX[Block]);
+		const VectorRegister4Float Ey = VectorLoad(&ExtentY[Block]);
+		const VectorRegister4Float Ez = VectorLoad(&ExtentZ[Block]);
+
+		VectorRegister4Float Outside = VectorZeroFloat();
+
+		// Outside a plane if the center is farther in front of it than the box reaches back
+		for (const FPlaneRegisters& Plane : Planes)
+		{
+			const VectorRegister4Float Distance = VectorSubtract(
+				VectorMultiplyAdd(Cz, Plane.Z, VectorMultiplyAdd(Cy, Plane.Y, VectorMultiply(Cx, Plane.X))), Plane.W);
+
+			const VectorRegister4Float PushOut =
+				VectorMultiplyAdd(Ez, Plane.AbsZ, VectorMultiplyAdd(Ey, Plane.AbsY, VectorMultiply(Ex, Plane.AbsX)));
+
+			Outside = VectorBitwiseOr(Outside, VectorCompareGT(Distance, PushOut));
+		}
+
+		uint32 InsideLanes = ~static_cast<uint32>(VectorMaskBits(Outside)) & 0xF;
+
+		while (InsideLanes)
+		{
+			const int32 ActorIndex = Block + FMath::CountTrailingZeros(InsideLanes);
+			InsideLanes &= InsideLanes - 1;
+
+			if (ActorIndex >= Primitives.Num()) break;
+
+			const int32 MetricsNameIndex = MetricsNameIndices[ActorIndex];
+
+			if (LastVisibleFrames[MetricsNameIndex] == Frame) continue;
+
+			if (bTestOcclusion)
+			{
+				const UPrimitiveComponent* Primitive = Primitives[ActorIndex].Get();
+
+				if (!Primitive) continue;
+
+				if (!World)
+					World = Primitive->GetWorld();
+
+				if (World->GetTimeSeconds() - Primitive->GetLastRenderTimeOnScreen() > OcclusionTolerance) continue;
+			}
+
+			LastVisibleFrames[MetricsNameIndex] = Frame;
+			VisibleTimes[MetricsNameIndex] += DeltaSeconds;
+		}
+	}
+}
+
+void FHeatmapVisibilityTracker::GetVisibleTimes(TMap<FString, float>& OutVisibleTimes) const
+{
+	OutVisibleTimes.Empty(MetricsNames.Num());
+
+	for (int32 i = 0; i < MetricsNames.Num(); ++i)
+	{
+		if (VisibleTimes[i] > 0.f)
+			OutVisibleTimes.Add(MetricsNames[i], VisibleTimes[i]);
+	}
+}
+
+FString FHeatmapVisibilityTracker::GetSidecarFilePath(const FString& SessionFilePath)
+{
+	return FPaths::ChangeExtension(SessionFilePath, "visibility");
+}
@@ -5,10 +5,26 @@
 #include "HeatmapRT.h"
 #include "DebugHeader.h"
 
-void UJsonParser::ReadAttentionTrackingDataFromJsonFile(const FString& FilePath, TArray<FAttentionTrackingDataPoint>& AttentionTrackingData, 
-	bool& bOutSuccess)
+void UJsonParser::ReadAttentionTrackingDataFromJsonFile(const UObject* WorldContextObject, const FString& FilePath,
+	TArray<FAttentionTrackingDataPoint>& AttentionTrackingData, bool& bOutSuccess)
+{
+	TMap<int32, FVector2D> LegacyScaleDivisors;
+	ReadAttentionTrackingDataFromJsonFile(FilePath, AttentionTrackingData, LegacyScaleDivisors, bOutSuccess);
+
+	if (!bOutSuccess || !WorldContextObject) return;
+
+	// Without the actors' scale tables, entries that stored a divisor would all paint with the forward axis
+	UHeatmapRT::ResolveLegacyActorGuids(AttentionTrackingData, WorldContextObject);
+
+	if (!LegacyScaleDivisors.IsEmpty())
+		UHeatmapRT::ResolveLegacyScaleDivisors(AttentionTrackingData, LegacyScaleDivisors, WorldContextObject);
+}
+
+void UJsonParser::ReadAttentionTrackingDataFromJsonFile(const FString& FilePath, TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+	TMap<int32, FVector2D>& OutLegacyScaleDivisors, bool& bOutSuccess)
 {
 	AttentionTrackingData.Empty();
+	OutLegacyScaleDivisors.Empty();
 	
 	const FString JsonString = ReadStringFromFile(FilePath, bOutSuccess);
 	TArray<TSharedPtr<FJsonValue>> JsonRootArray;
@@ -48,6 +64,12 @@ void UJsonParser::ReadAttentionTrackingDataFromJsonFile(const FString& FilePath,
 			continue;
 		}
 
+		// Optional: older files only reference actors by object name
+		FString OutGuidString;
+		
+		if (JsonObject->TryGetStringField("ActorGuid", OutGuidString))
+			FGuid::Parse(OutGuidString, RenderTargetCoordinatesData.ActorGuid);
+
 		if (!JsonObject->TryGetNumberField("U", OutNumber))
 		{
 			DebugHeader::ShowNotifyInfo(TEXT("Retrieval of UVX field failed at index "
@@ -66,23 +88,36 @@ void UJsonParser::ReadAttentionTrackingDataFromJsonFile(const FString& FilePath,
 
 		RenderTargetCoordinatesData.Coordinates.Y = static_cast<float>(OutNumber);
 
-		if (!JsonObject->TryGetNumberField("PaintBrushScaleDivisorX", OutNumber))
+		if (JsonObject->TryGetNumberField("FaceAxis", OutNumber))
 		{
-			DebugHeader::ShowNotifyInfo(TEXT("Retrieval of PaintBrushScaleDivisorX field failed at index "
-				+ FString::FromInt(Index)));
-			continue;
+			RenderTargetCoordinatesData.FaceAxis = static_cast<EHeatmapFaceAxis>(
+				FMath::Clamp(static_cast<int32>(OutNumber), 0, static_cast<int32>(EHeatmapFaceAxis::EHFA_MAX) - 1));
 		}
 
-		RenderTargetCoordinatesData.PaintBrushScaleDivisor.X = static_cast<float>(OutNumber);
-
-		if (!JsonObject->TryGetNumberField("PaintBrushScaleDivisorY", OutNumber))
+		else
 		{
-			DebugHeader::ShowNotifyInfo(TEXT("Retrieval of PaintBrushScaleDivisorY field failed at index "
-				+ FString::FromInt(Index)));
-			continue;
+			FVector2D LegacyScaleDivisor;
+			
+			if (!JsonObject->TryGetNumberField("PaintBrushScaleDivisorX", LegacyScaleDivisor.X) ||
+				!JsonObject->TryGetNumberField("PaintBrushScaleDivisorY", LegacyScaleDivisor.Y))
+			{
+				DebugHeader::ShowNotifyInfo(TEXT("Retrieval of FaceAxis field failed at index "
+					+ FString::FromInt(Index)));
+				continue;
+			}
+
+			OutLegacyScaleDivisors.Add(AttentionTrackingData.Num(), LegacyScaleDivisor);
 		}
 
-		RenderTargetCoordinatesData.PaintBrushScaleDivisor.Y = static_cast<float>(OutNumber);
+		// Optional: files written before run-length compression store one sample per entry
+		if (JsonObject->TryGetNumberField("Duration", OutNumber))
+			RenderTargetCoordinatesData.Duration = static_cast<float>(OutNumber);
+
+		if (JsonObject->TryGetNumberField("SampleCount", OutNumber))
+			RenderTargetCoordinatesData.SampleCount = FMath::Max(1, static_cast<int32>(OutNumber));
+
+		if (JsonObject->TryGetNumberField("Weight", OutNumber))
+			RenderTargetCoordinatesData.Weight = static_cast<float>(OutNumber);
 
 		AttentionTrackingData.Add(RenderTargetCoordinatesData);
 
@@ -100,10 +135,13 @@ void UJsonParser::WriteAttentionTrackingDataToJsonFile(const TArray<FAttentionTr
 		const TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
 		JsonObject->SetNumberField("TimePassedSinceRecordingStarted", AttentionTrackingDataPoint.TimePassedSinceRecordingStarted);
 		JsonObject->SetStringField("ObjectName", AttentionTrackingDataPoint.ObjectName);
+		JsonObject->SetStringField("ActorGuid", AttentionTrackingDataPoint.ActorGuid.ToString());
 		JsonObject->SetNumberField("U", AttentionTrackingDataPoint.Coordinates.X);
 		JsonObject->SetNumberField("V", AttentionTrackingDataPoint.Coordinates.Y);
-		JsonObject->SetNumberField("PaintBrushScaleDivisorX", AttentionTrackingDataPoint.PaintBrushScaleDivisor.X);
-		JsonObject->SetNumberField("PaintBrushScaleDivisorY", AttentionTrackingDataPoint.PaintBrushScaleDivisor.Y);
+		JsonObject->SetNumberField("FaceAxis", static_cast<double>(AttentionTrackingDataPoint.FaceAxis));
+		JsonObject->SetNumberField("Duration", AttentionTrackingDataPoint.Duration);
+		JsonObject->SetNumberField("SampleCount", AttentionTrackingDataPoint.SampleCount);
+		JsonObject->SetNumberField("Weight", AttentionTrackingDataPoint.Weight);
 
 		TSharedPtr<FJsonValueObject> RtcValueObject = MakeShareable(new FJsonValueObject(JsonObject));
 		RootArray.Add(RtcValueObject);
@@ -130,6 +168,16 @@ void UJsonParser::WriteAttentionMetricsToJsonFile(const TMap<FString, FAttention
 		JsonObject->SetStringField("ObjectName", Entry.Key);
 		JsonObject->SetNumberField("TotalAttentionTime", Entry.Value.TotalAttentionTime);
 		JsonObject->SetNumberField("AverageAttentionTime", Entry.Value.AverageAttentionTime);
+		JsonObject->SetNumberField("VisibleTime", Entry.Value.VisibleTime);
+		JsonObject->SetNumberField("AttendedToVisibleRatio", Entry.Value.AttendedToVisibleRatio);
+		JsonObject->SetNumberField("Coverage", Entry.Value.Coverage);
+		JsonObject->SetNumberField("Entropy", Entry.Value.Entropy);
+		JsonObject->SetNumberField("PeakDensity", Entry.Value.PeakDensity);
+		JsonObject->SetNumberField("DensityCentroidU", Entry.Value.DensityCentroid.X);
+		JsonObject->SetNumberField("DensityCentroidV", Entry.Value.DensityCentroid.Y);
+		JsonObject->SetNumberField("DensityVarianceU", Entry.Value.DensityVariance.X);
+		JsonObject->SetNumberField("DensityVarianceV", Entry.Value.DensityVariance.Y);
+		JsonObject->SetNumberField("DensityCovariance", Entry.Value.DensityCovariance);
 
 		TArray<TSharedPtr<FJsonValue>> AttentionSequenceIndices;
 		
@@ -150,6 +198,41 @@ void UJsonParser::WriteAttentionMetricsToJsonFile(const TMap<FString, FAttention
 	WriteJson(RootArray, FilePath, bOutSuccess);
 }
  
+void UJsonParser::WriteHotspotsToJsonFile(const TArray<FHeatmapHotspot>& Hotspots, const FString& FilePath,
+	bool& bOutSuccess)
+{
+	TArray<TSharedPtr<FJsonValue>> RootArray;
+
+	for (const FHeatmapHotspot& Hotspot : Hotspots)
+	{
+		const TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
+
+		JsonObject->SetNumberField("Rank", Hotspot.Rank);
+		JsonObject->SetStringField("Space", Hotspot.Space == EHeatmapHotspotSpace::EHHS_World ? "World" : "UV");
+		JsonObject->SetStringField("ObjectName", Hotspot.Name);
+		JsonObject->SetStringField("ActorGuid", Hotspot.ActorGuid.ToString());
+		JsonObject->SetNumberField("CentroidX", Hotspot.Centroid.X);
+		JsonObject->SetNumberField("CentroidY", Hotspot.Centroid.Y);
+		JsonObject->SetNumberField("CentroidZ", Hotspot.Centroid.Z);
+		JsonObject->SetNumberField("ExtentX", Hotspot.Extent.X);
+		JsonObject->SetNumberField("ExtentY", Hotspot.Extent.Y);
+		JsonObject->SetNumberField("ExtentZ", Hotspot.Extent.Z);
+		JsonObject->SetNumberField("DwellTime", Hotspot.DwellTime);
+		JsonObject->SetNumberField("SampleCount", Hotspot.SampleCount);
+
+		TArray<TSharedPtr<FJsonValue>> Timestamps;
+
+		for (const float Timestamp : Hotspot.Timestamps)
+			Timestamps.Add(MakeShareable(new FJsonValueNumber(Timestamp)));
+
+		JsonObject->SetArrayField("Timestamps", Timestamps);
+
+		RootArray.Add(MakeShareable(new FJsonValueObject(JsonObject)));
+	}
+
+	WriteJson(RootArray, FilePath, bOutSuccess);
+}
+
 FString UJsonParser::AttentionMetricsFolderPath()
 {
 	return FPaths::ProjectDir() + "Metrics/";
@@ -203,6 +286,136 @@ FString UJsonParser::ConfigDataFilePath()
 	return FPaths::ProjectDir() + "Config_AT/AttentionTrackingConfig.json";
 }
 
+TMap<FString, FString> UJsonParser::ReadStringMapFromJsonFile(const FString& FilePath, bool& bOutSuccess)
+{
+	TMap<FString, FString> StringMap;
+	bOutSuccess = true;
+
+	if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath))
+		return StringMap;
+
+	const TSharedPtr<FJsonObject> JsonObject = ReadJson(FilePath, bOutSuccess);
+
+	bOutSuccess = JsonObject.IsValid();
+
+	if (!bOutSuccess) return StringMap;
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : JsonObject->Values)
+	{
+		FString Value;
+
+		if (Field.Value.IsValid() && Field.Value->TryGetString(Value))
+			StringMap.Add(Field.Key, Value);
+	}
+
+	return StringMap;
+}
+
+void UJsonParser::WriteStringMapToJsonFile(const TMap<FString, FString>& StringMap, const FString& FilePath,
+	bool& bOutSuccess)
+{
+	const TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
+
+	for (const TPair<FString, FString>& Entry : StringMap)
+		JsonObject->SetStringField(Entry.Key, Entry.Value);
+
+	WriteJson(JsonObject, FilePath, bOutSuccess);
+}
+
+TMap<FString, float> UJsonParser::ReadFloatMapFromJsonFile(const FString& FilePath, bool& bOutSuccess)
+{
+	TMap<FString, float> FloatMap;
+	bOutSuccess = true;
+
+	if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath))
+		return FloatMap;
+
+	const TSharedPtr<FJsonObject> JsonObject = ReadJson(FilePath, bOutSuccess);
+
+	bOutSuccess = JsonObject.IsValid();
+
+	if (!bOutSuccess) return FloatMap;
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : JsonObject->Values)
+	{
+		double Value;
+
+		if (Field.Value.IsValid() && Field.Value->TryGetNumber(Value))
+			FloatMap.Add(Field.Key, Value);
+	}
+
+	return FloatMap;
+}
+
+void UJsonParser::WriteFloatMapToJsonFile(const TMap<FString, float>& FloatMap, const FString& FilePath,
+	bool& bOutSuccess)
+{
+	const TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
+
+	for (const TPair<FString, float>& Entry : FloatMap)
+		JsonObject->SetNumberField(Entry.Key, Entry.Value);
+
+	WriteJson(JsonObject, FilePath, bOutSuccess);
+}
+
+TArray<FHeatmapSegmentMarker> UJsonParser::ReadSegmentMarkersFromJsonFile(const FString& FilePath, bool& bOutSuccess)
+{
+	TArray<FHeatmapSegmentMarker> SegmentMarkers;
+	bOutSuccess = true;
+
+	if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath))
+		return SegmentMarkers;
+
+	const FString JsonString = ReadStringFromFile(FilePath, bOutSuccess);
+	TArray<TSharedPtr<FJsonValue>> JsonRootArray;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+
+	bOutSuccess = bOutSuccess && FJsonSerializer::Deserialize(Reader, JsonRootArray);
+
+	if (!bOutSuccess) return SegmentMarkers;
+
+	for (const TSharedPtr<FJsonValue>& Entry : JsonRootArray)
+	{
+		const TSharedPtr<FJsonObject>* JsonObject;
+		double Time, WaypointIndex;
+
+		if (!Entry.IsValid() || !Entry->TryGetObject(JsonObject) ||
+			!(*JsonObject)->TryGetNumberField("Time", Time) ||
+			!(*JsonObject)->TryGetNumberField("WaypointIndex", WaypointIndex)) continue;
+
+		SegmentMarkers.Add({ static_cast<float>(Time), static_cast<int32>(WaypointIndex) });
+	}
+
+	return SegmentMarkers;
+}
+
+void UJsonParser::WriteSegmentMarkersToJsonFile(const TArray<FHeatmapSegmentMarker>& SegmentMarkers,
+	const FString& FilePath, bool& bOutSuccess)
+{
+	TArray<TSharedPtr<FJsonValue>> RootArray;
+
+	for (const FHeatmapSegmentMarker& SegmentMarker : SegmentMarkers)
+	{
+		const TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
+		JsonObject->SetNumberField("Time", SegmentMarker.Time);
+		JsonObject->SetNumberField("WaypointIndex", SegmentMarker.WaypointIndex);
+
+		RootArray.Add(MakeShareable(new FJsonValueObject(JsonObject)));
+	}
+
+	WriteJson(RootArray, FilePath, bOutSuccess);
+}
+
+FString UJsonParser::SegmentMarkersFilePath(const FString& SessionFilePath)
+{
+	return FPaths::ChangeExtension(SessionFilePath, "segments");
+}
+
+FString UJsonParser::CacheFolderPath()
+{
+	return FPaths::ProjectSavedDir() + "AttentionTracking/";
+}
+
 FString UJsonParser::ReadStringFromFile(const FString& FilePath, bool& bOutSuccess)
 {
 	if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath))
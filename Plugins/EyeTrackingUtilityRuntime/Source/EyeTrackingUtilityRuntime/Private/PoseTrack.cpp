@@ -0,0 +1,261 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#include "PoseTrack.h"
+
+#include "Algo/BinarySearch.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void FPoseTrack::AddSample(const FVector& Position, const FQuat& Rotation, const float Time)
+{
+	uint32 EncodedRotation = EncodeRotation(Rotation);
+
+	if (!Blocks.IsEmpty() && Blocks.Last().SamplesNum < MaxBlockSamples)
+	{
+		const int32 TimeDelta = FMath::RoundToInt((Time - LastSample.Time) / TimeStep);
+		bool bFitsDelta = TimeDelta >= 0 && TimeDelta <= MAX_uint8;
+
+		int16 PositionDelta[3];
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			const int64 Steps = FMath::RoundToInt64((Position[Axis] - LastSample.Position[Axis]) / PositionStep);
+
+			bFitsDelta &= Steps >= MIN_int16 && Steps <= MAX_int16;
+			PositionDelta[Axis] = static_cast<int16>(Steps);
+		}
+
+		if (bFitsDelta)
+		{
+			uint8 EncodedTimeDelta = static_cast<uint8>(TimeDelta);
+
+			FMemoryWriter Writer(Data, false, true);
+			Writer << EncodedTimeDelta << PositionDelta[0] << PositionDelta[1] << PositionDelta[2] << EncodedRotation;
+
+			ApplyDelta(LastSample, EncodedTimeDelta, PositionDelta);
+			LastSample.Rotation = EncodedRotation;
+
+			++Blocks.Last().SamplesNum;
+			++SamplesNum;
+			return;
+		}
+	}
+
+	// Full blocks, pauses and teleports start a new keyframe
+	Blocks.Add({ Time, Data.Num(), 1 });
+	LastSample = { Time, FVector3f(Position), EncodedRotation };
+
+	FMemoryWriter Writer(Data, false, true);
+	Writer << LastSample.Time << LastSample.Position << LastSample.Rotation;
+
+	++SamplesNum;
+}
+
+void FPoseTrack::Reset()
+{
+	Data.Empty();
+	Blocks.Empty();
+	SamplesNum = 0;
+	LastSample = FSample();
+}
+
+bool FPoseTrack::Evaluate(const float Time, FVector& OutPosition, FQuat& OutRotation) const
+{
+	if (Blocks.IsEmpty()) return false;
+
+	const int32 BlockIndex = FMath::Max(Algo::UpperBoundBy(Blocks, Time, &FBlock::StartTime) - 1, 0);
+
+	FSample Before, After;
+	FindSamples(Blocks[BlockIndex], Time, Before, After);
+
+	if (After.Time <= Time && Blocks.IsValidIndex(BlockIndex + 1))
+		ReadKeyframe(Blocks[BlockIndex + 1], After);
+
+	const float Alpha = After.Time > Before.Time ?
+		FMath::Clamp((Time - Before.Time) / (After.Time - Before.Time), 0.f, 1.f) : 0.f;
+
+	OutPosition = FVector(FMath::Lerp(Before.Position, After.Position, Alpha));
+	OutRotation = FQuat::Slerp(DecodeRotation(Before.Rotation), DecodeRotation(After.Rotation), Alpha);
+
+	return true;
+}
+
+void FPoseTrack::ReadKeyframe(const FBlock& Block, FSample& OutSample) const
+{
+	FMemoryReader Reader(Data);
+	Reader.Seek(Block.ByteOffset);
+
+	Reader << OutSample.Time << OutSample.Position << OutSample.Rotation;
+}
+
+void FPoseTrack::FindSamples(const FBlock& Block, const float Time, FSample& OutBefore, FSample& OutAfter) const
+{
+	FMemoryReader Reader(Data);
+	Reader.Seek(Block.ByteOffset);
+
+	FSample Sample;
+	Reader << Sample.Time << Sample.Position << Sample.Rotation;
+
+	OutBefore = Sample;
+	OutAfter = Sample;
+
+	if (Sample.Time >= Time) return;
+
+	for (int32 i = 1; i < Block.SamplesNum; ++i)
+	{
+		uint8 TimeDelta;
+		int16 PositionDelta[3];
+
+		Reader << TimeDelta << PositionDelta[0] << PositionDelta[1] << PositionDelta[2] << Sample.Rotation;
+
+		ApplyDelta(Sample, TimeDelta, PositionDelta);
+		OutAfter = Sample;
+
+		if (Sample.Time > Time) return;
+
+		OutBefore = Sample;
+	}
+}
+
+void FPoseTrack::ApplyDelta(FSample& Sample, const uint8 TimeDelta, const int16 PositionDelta[3])
+{
+	Sample.Time += TimeDelta * TimeStep;
+	Sample.Position += FVector3f(PositionDelta[0], PositionDelta[1], PositionDelta[2]) * PositionStep;
+}
+
+uint32 FPoseTrack::EncodeRotation(const FQuat& Rotation)
+{
+	const FQuat Normalized = Rotation.GetNormalized();
+	const double Components[4] = { Normalized.X, Normalized.Y, Normalized.Z, Normalized.W };
+
+	int32 Largest = 0;
+
+	for (int32 i = 1; i < 4; ++i)
+	{
+		if (FMath::Abs(Components[i]) > FMath::Abs(Components[Largest]))
+			Largest = i;
+	}
+
+	// q and -q are the same rotation, so the dropped component can always be positive
+	const double Sign = Components[Largest] < 0.0 ? -1.0 : 1.0;
+
+	uint32 Encoded = static_cast<uint32>(Largest) << 30;
+	int32 Shift = 20;
+
+	for (int32 i = 0; i < 4; ++i)
+	{
+		if (i == Largest) continue;
+
+		const double Alpha = (Components[i] * Sign / MaxRotationComponent + 1.0) * 0.5;
+
+		Encoded |= static_cast<uint32>(FMath::Clamp(FMath::RoundToInt(Alpha * 1023.0), 0, 1023)) << Shift;
+		Shift -= 10;
+	}
+
+	return Encoded;
+}
+
+FQuat FPoseTrack::DecodeRotation(const uint32 Encoded)
+{
+	const int32 Largest = Encoded >> 30;
+
+	double Components[4];
+	double SquaredSum = 0.0;
+	int32 Shift = 20;
+
+	for (int32 i = 0; i < 4; ++i)
+	{
+		if (i == Largest) continue;
+
+		const double Alpha = ((Encoded >> Shift) & 1023) / 1023.0;
+
+		Components[i] = (Alpha * 2.0 - 1.0) * MaxRotationComponent;
+		SquaredSum += Components[i] * Components[i];
+		Shift -= 10;
+	}
+
+	Components[Largest] = FMath::Sqrt(FMath::Max(1.0 - SquaredSum, 0.0));
+
+	return FQuat(Components[0], Components[1], Components[2], Components[3]).GetNormalized();
+}
+
+bool FPoseTrack::SaveToFile(const FString& FilePath) const
+{
+	TArray<uint8> FileData;
+	FMemoryWriter Writer(FileData);
+
+	uint32 Magic = FileMagic, Version = FileVersion;
+	int32 SavedSamplesNum = SamplesNum;
+	int32 BlocksNum = Blocks.Num();
+
+	Writer << Magic << Version << SavedSamplesNum << BlocksNum;
+
+	for (FBlock Block : Blocks)
+		Writer << Block.StartTime << Block.ByteOffset << Block.SamplesNum;
+
+	Writer << const_cast<TArray<uint8>&>(Data);
+
+	return FFileHelper::SaveArrayToFile(FileData, *FilePath);
+}
+
+bool FPoseTrack::LoadFromFile(const FString& FilePath)
+{
+	TArray<uint8> FileData;
+
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath, FILEREAD_Silent)) return false;
+
+	FMemoryReader Reader(FileData);
+
+	uint32 Magic = 0, Version = 0;
+
+	Reader << Magic << Version;
+
+	if (Magic != FileMagic || Version != FileVersion) return false;
+
+	int32 LoadedSamplesNum = 0;
+	int32 BlocksNum = 0;
+
+	Reader << LoadedSamplesNum << BlocksNum;
+
+	if (Reader.IsError() || BlocksNum < 0) return false;
+
+	Reset();
+	Blocks.SetNum(BlocksNum);
+
+	for (FBlock& Block : Blocks)
+		Reader << Block.StartTime << Block.ByteOffset << Block.SamplesNum;
+
+	Reader << Data;
+
+	bool bValid = !Reader.IsError();
+
+	// Every block has to fit in the data, decoding doesn't check again
+	for (int32 i = 0; i < Blocks.Num() && bValid; ++i)
+	{
+		bValid = Blocks[i].SamplesNum > 0 && Blocks[i].ByteOffset >= 0 &&
+			Blocks[i].ByteOffset + KeyframeSize + (Blocks[i].SamplesNum - 1) * DeltaSize <= Data.Num();
+	}
+
+	if (!bValid)
+	{
+		Reset();
+		return false;
+	}
+
+	SamplesNum = LoadedSamplesNum;
+
+	if (!Blocks.IsEmpty())
+	{
+		FSample After;
+		FindSamples(Blocks.Last(), MAX_flt, LastSample, After);
+	}
+
+	return true;
+}
+
+FString FPoseTrack::GetSidecarFilePath(const FString& SessionFilePath)
+{
+	return FPaths::ChangeExtension(SessionFilePath, "pose");
+}
@@ -3,7 +3,8 @@
 #include "Waypoint.h"
 
 AWaypoint::AWaypoint()
-	: Index(0)
+	: Index(0),
+	  ReachRadius(150.f)
 {
 	PrimaryActorTick.bCanEverTick = true;
 }
@@ -0,0 +1,81 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "AttentionVolume.generated.h"
+
+USTRUCT(BlueprintType, Category = "Attention Volume")
+struct FAttentionVolumeQueryResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Attention Volume")
+	float TotalDwellTime = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Attention Volume")
+	int32 SampleCount = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Attention Volume")
+	int32 VoxelCount = 0;
+
+	// Dwell-weighted mean of the voxel centers
+	UPROPERTY(BlueprintReadOnly, Category = "Attention Volume")
+	FVector Centroid = FVector::ZeroVector;
+};
+
+struct FAttentionVoxel
+{
+	float DwellTime = 0.f;
+	int32 SampleCount = 0;
+};
+
+/*
+* World-space gaze hits in a sparse hashed voxel grid, independent of UVs and render targets, so it covers
+* overlapping UVs, unconverted actors and whole buildings alike. Inserts are a single hash lookup.
+* Stored as a binary sidecar next to the session's JSON file.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FAttentionVolume
+{
+public:
+	explicit FAttentionVolume(const float InVoxelSize = DefaultVoxelSize);
+
+	static constexpr float DefaultVoxelSize = 25.f;
+
+	// ActorGuid may be invalid for actors that were never converted to heatmap ready actors
+	void AddHit(const FVector& Location, const float DwellTime, const FGuid& ActorGuid);
+
+	void Reset(const float InVoxelSize);
+
+	FAttentionVolumeQueryResult QueryBox(const FBox& Box, TArray<FIntVector>* OutVoxels = nullptr) const;
+
+	// Voxels hit on this actor while recording; empty for actors without a GUID
+	FAttentionVolumeQueryResult QueryActor(const FGuid& ActorGuid, TArray<FIntVector>* OutVoxels = nullptr) const;
+
+	FIntVector GetVoxelCoordinates(const FVector& Location) const;
+	FVector GetVoxelCenter(const FIntVector& Voxel) const;
+	const FAttentionVoxel* FindVoxel(const FIntVector& Voxel) const { return Voxels.Find(Voxel); }
+
+	float GetVoxelSize() const { return VoxelSize; }
+	int32 Num() const { return Voxels.Num(); }
+	bool IsEmpty() const { return Voxels.IsEmpty(); }
+
+	bool SaveToFile(const FString& FilePath) const;
+	bool LoadFromFile(const FString& FilePath);
+
+	// <Session>.voxels next to <Session>.json
+	static FString GetSidecarFilePath(const FString& SessionFilePath);
+
+private:
+	void AddToResult(const FIntVector& Voxel, const FAttentionVoxel& VoxelData, FAttentionVolumeQueryResult& Result,
+		FVector& WeightedCenterSum) const;
+
+	float VoxelSize;
+
+	TMap<FIntVector, FAttentionVoxel> Voxels;
+	TMap<FGuid, TSet<FIntVector>> VoxelsByActor;
+
+	static constexpr uint32 FileMagic = 0x58565441;
+	static constexpr uint32 FileVersion = 1;
+};
@@ -4,8 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "WorldCollision.h"
 
 #include "JsonParser.h"
+#include "AttentionVolume.h"
+#include "GazePointCloud.h"
+#include "GazeRayStream.h"
+#include "PoseTrack.h"
+#include "HeatmapVisibility.h"
 
 #include "EyeTrackingCharacter.generated.h"
 
@@ -21,8 +27,31 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Get Heatmap Data")
 	void GetHeatmapData(TArray<FAttentionTrackingDataPoint>& Data) { Data = HeatmapData; }
 
+	// Writes the recorded heatmap and everything recorded alongside it. Saving this character's data through
+	// UHeatmapRT::SaveHeatmap writes the sidecars as well.
+	UFUNCTION(BlueprintCallable, Category = "Get Heatmap Data")
+	void SaveSession(const FString& FileName) const;
+
+	// Moves the pawn along a recorded pose track so its camera follows the participant's. In VR the headset
+	// still drives the camera's rotation.
+	UFUNCTION(BlueprintCallable, Category = "Pose Replay")
+	bool StartPoseReplay(const FString& FileName);
+
+	UFUNCTION(BlueprintCallable, Category = "Pose Replay")
+	void StopPoseReplay();
+
+	UFUNCTION(BlueprintCallable, Category = "Pose Replay")
+	void SeekPoseReplay(const float Time);
+
+	const FAttentionVolume& GetAttentionVolume() const { return AttentionVolume; }
+	const FGazePointCloud& GetGazePoints() const { return GazePoints; }
+	const FGazeRayStream& GetGazeRays() const { return GazeRays; }
+	const FPoseTrack& GetPoseTrack() const { return PoseTrack; }
+	const TArray<FHeatmapSegmentMarker>& GetSegmentMarkers() const { return SegmentMarkers; }
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	UFUNCTION(BlueprintPure, Category = "EyeTracking Math")
 	void GazeScreenToWorld(FVector& LineTraceStart, FVector& LineTraceEnd) const;
@@ -57,6 +86,43 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category = "Time" )
 	float CurrentTimeStep;
 
+	// Consecutive samples on the same actor closer than this (in UV space) are stored as one run
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Heatmap")
+	float RunLengthUvEpsilon;
+
+	// Edge length in cm of the world-space attention voxels, applied when tracking starts
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Heatmap", meta = (ClampMin = "1.0"))
+	float AttentionVoxelSize;
+
+	// Track how long each metrics actor is in view, to compare with how long it is looked at
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visibility")
+	bool bTrackVisibility;
+
+	// Don't count actors the renderer culled as occluded
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visibility", meta = (EditCondition = "bTrackVisibility"))
+	bool bVisibilityOcclusion;
+
+	// Trace a cone of rays around the gaze instead of a single one, to account for tracker accuracy and the
+	// size of the fovea. The actor most of the cone falls on gets the sample, weighted by its share.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Foveal Sampling")
+	bool bFovealSampling;
+
+	// In degrees
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Foveal Sampling", meta = (EditCondition = "bFovealSampling", ClampMin = "0.0"))
+	float FovealConeHalfAngle;
+
+	// Rays are weighted by a Gaussian of their angle to the gaze, with this standard deviation in degrees
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Foveal Sampling", meta = (EditCondition = "bFovealSampling", ClampMin = "0.01"))
+	float FovealSigma;
+
+	// Rays in the full pattern
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Foveal Sampling", meta = (EditCondition = "bFovealSampling", ClampMin = "1"))
+	int32 FovealRayCount;
+
+	// Rays traced per frame; with fewer than FovealRayCount, consecutive frames take turns over the pattern
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Foveal Sampling", meta = (EditCondition = "bFovealSampling", ClampMin = "1"))
+	int32 FovealRayBudget;
+
 public:
 	UPROPERTY(BlueprintReadWrite, Category = "Heatmap")
 	FString NewHeatmapName;
@@ -70,11 +136,68 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "VR")
 	bool bVR;
 
+	UPROPERTY(BlueprintReadOnly, Category = "Pose Replay")
+	bool bIsReplayingPose;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pose Replay")
+	float PoseReplayTime;
+
 private:
 	float TrackingStartTime;
 
 	TArray<FAttentionTrackingDataPoint> HeatmapData;
 
+	FAttentionVolume AttentionVolume;
+	FGazePointCloud GazePoints;
+	FGazeRayStream GazeRays;
+	FPoseTrack PoseTrack;
+	FPoseTrack ReplayedPoseTrack;
+
+	FDelegateHandle HeatmapSavedHandle;
+
+	// The world-space attention and other recordings, next to the session file of that name
+	void SaveSessionSidecars(const FString& FileName) const;
+
+	// Restored when the replay stops
+	TEnumAsByte<EMovementMode> PreReplayMovementMode;
+	uint8 PreReplayCustomMovementMode;
+
+	FHeatmapVisibilityTracker VisibilityTracker;
+
+	void UpdateVisibility(const float DeltaTime);
+
+	// Sorted by Index when tracking starts; reaching one skips any before it that weren't reached
+	TArray<TWeakObjectPtr<class AWaypoint>> RouteWaypoints;
+	int32 NextRouteWaypoint;
+	TArray<FHeatmapSegmentMarker> SegmentMarkers;
+
+	void UpdateRoute();
+	void UpdatePoseReplay(const float DeltaTime);
+
+	void RecordHeatmapHit(const FHitResult& HitResult, AHeatmapReadyActor* ActorToPaint, const uint8 UvChannel,
+		const float Time, const float Weight);
+
+	struct FFovealRay
+	{
+		FTraceHandle TraceHandle;
+		float Weight;
+	};
+
+	// One frame's cone, resolved once the async traces have completed
+	struct FFovealBatch
+	{
+		TArray<FFovealRay> Rays;
+		float Time;
+		float DeltaSeconds;
+	};
+
+	TArray<FFovealBatch> PendingFovealBatches;
+	int32 FovealPatternOffset;
+
+	void QueueFovealTraces(const FVector& LineTraceStart, const FVector& LineTraceEnd);
+	void ResolveFovealTraces(const uint8 UvChannel);
+	void ResolveFovealBatch(const FFovealBatch& Batch, const TArray<FTraceDatum>& Results, const uint8 UvChannel);
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
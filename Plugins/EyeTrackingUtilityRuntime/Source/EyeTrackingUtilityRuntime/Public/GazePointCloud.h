@@ -0,0 +1,136 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/GenericOctree.h"
+#include "ConvexVolume.h"
+
+#include "GazePointCloud.generated.h"
+
+/*
+* Consecutive recorded samples that matched a query. The sample indices count gaze points, one per traced
+* frame that hit anything, not entries of the session's AttentionTrackingData: that is run-length merged and
+* skips hits on actors that aren't heatmap-ready. Join the two by time.
+*/
+USTRUCT(BlueprintType, Category = "Gaze Points")
+struct FGazeSampleRange
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gaze Points")
+	int32 FirstSample = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gaze Points")
+	int32 LastSample = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gaze Points")
+	float StartTime = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gaze Points")
+	float EndTime = 0.f;
+};
+
+struct FGazePoint
+{
+	FVector Location = FVector::ZeroVector;
+	float Time = 0.f;
+};
+
+struct FGazePointQuery
+{
+	enum class EType : uint8 { Radius, Box, Frustum };
+
+	EType Type = EType::Radius;
+
+	FVector Center = FVector::ZeroVector;
+	float Radius = 0.f;
+	FBox Box = FBox(ForceInit);
+	FConvexVolume Frustum;
+
+	static FGazePointQuery MakeRadius(const FVector& Center, const float Radius);
+	static FGazePointQuery MakeBox(const FBox& Box);
+	static FGazePointQuery MakeFrustum(const FConvexVolume& Frustum);
+};
+
+/*
+* Every recorded gaze hit in world space, in recording order, indexed by a loose octree that grows with
+* each sample. Queries return the matching samples as time-ordered ranges.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FGazePointCloud
+{
+public:
+	FGazePointCloud();
+
+	void AddPoint(const FVector& Location, const float Time);
+
+	void Reset();
+
+	void QueryRadius(const FVector& Center, const float Radius, TArray<FGazeSampleRange>& OutRanges) const;
+	void QueryBox(const FBox& Box, TArray<FGazeSampleRange>& OutRanges) const;
+	void QueryFrustum(const FConvexVolume& Frustum, TArray<FGazeSampleRange>& OutRanges) const;
+
+	void Query(const FGazePointQuery& Query, TArray<FGazeSampleRange>& OutRanges) const;
+
+	// One worker per query; the octree is only read
+	void QueryBatch(const TArray<FGazePointQuery>& Queries, TArray<TArray<FGazeSampleRange>>& OutRanges) const;
+
+	const TArray<FGazePoint>& GetPoints() const { return Points; }
+	int32 Num() const { return Points.Num(); }
+
+	bool SaveToFile(const FString& FilePath) const;
+	bool LoadFromFile(const FString& FilePath);
+
+	// <Session>.gaze next to <Session>.json
+	static FString GetSidecarFilePath(const FString& SessionFilePath);
+
+private:
+	struct FElement
+	{
+		FVector Location;
+		int32 PointIndex;
+	};
+
+	struct FOctreeSemantics
+	{
+		enum { MaxElementsPerLeaf = 32 };
+		enum { MinInclusiveElementsPerNode = 8 };
+		enum { MaxNodeDepth = 16 };
+
+		typedef TInlineAllocator<MaxElementsPerLeaf> ElementAllocator;
+
+		FORCEINLINE static FBoxCenterAndExtent GetBoundingBox(const FElement& Element)
+		{
+			return FBoxCenterAndExtent(Element.Location, FVector::ZeroVector);
+		}
+
+		FORCEINLINE static bool AreElementsEqual(const FElement& A, const FElement& B)
+		{
+			return A.PointIndex == B.PointIndex;
+		}
+
+		// Points are never removed, so their ids aren't needed
+		FORCEINLINE static void SetElementId(const FElement& Element, FOctreeElementId2 Id)
+		{
+		}
+
+		FORCEINLINE static void ApplyOffset(FElement& Element, const FVector& Offset)
+		{
+			Element.Location += Offset;
+		}
+	};
+
+	typedef TOctree2<FElement, FOctreeSemantics> FOctree;
+
+	static void MakeRanges(TArray<int32>& PointIndices, const TArray<FGazePoint>& Points,
+		TArray<FGazeSampleRange>& OutRanges);
+
+	TArray<FGazePoint> Points;
+	TUniquePtr<FOctree> Octree;
+
+	// Half the edge of the root node; points outside still land in the root
+	static constexpr double RootExtent = 1000000.0;
+
+	static constexpr uint32 FileMagic = 0x5A414754;
+	static constexpr uint32 FileVersion = 1;
+};
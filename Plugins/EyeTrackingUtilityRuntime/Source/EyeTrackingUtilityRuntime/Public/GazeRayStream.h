@@ -0,0 +1,53 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGazeRay
+{
+	FVector Origin = FVector::ZeroVector;
+	FVector3f Direction = FVector3f::ForwardVector;
+	float Time = 0.f;
+};
+
+/*
+* Every gaze ray in recording order, hit or not, so a session can be traced again after the level changed.
+* On disk origins are quantized to 16 bits per axis within the stream's bounds and directions are octahedral
+* encoded in 2x16 bits, 14 bytes per ray with its time.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FGazeRayStream
+{
+public:
+	void AddRay(const FVector& Start, const FVector& End, const float Time);
+
+	void Reset();
+
+	const TArray<FGazeRay>& GetRays() const { return Rays; }
+	int32 Num() const { return Rays.Num(); }
+
+	// Longest ray recorded, re-traces use it for all of them
+	float GetTraceLength() const { return TraceLength; }
+
+	// The UV channel the rays were painted with
+	uint8 GetUvChannel() const { return UvChannel; }
+	void SetUvChannel(const uint8 InUvChannel) { UvChannel = InUvChannel; }
+
+	bool SaveToFile(const FString& FilePath) const;
+	bool LoadFromFile(const FString& FilePath);
+
+	// <Session>.rays next to <Session>.json
+	static FString GetSidecarFilePath(const FString& SessionFilePath);
+
+private:
+	static void EncodeDirection(const FVector3f& Direction, int16& OutU, int16& OutV);
+	static FVector3f DecodeDirection(const int16 U, const int16 V);
+
+	TArray<FGazeRay> Rays;
+	FBox Bounds = FBox(ForceInit);
+	float TraceLength = 0.f;
+	uint8 UvChannel = 0;
+
+	static constexpr uint32 FileMagic = 0x59415254;
+	static constexpr uint32 FileVersion = 1;
+};
@@ -0,0 +1,30 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FAttentionTrackingDataPoint;
+class FGazeRayStream;
+class FGazePointCloud;
+class FAttentionVolume;
+
+/*
+* Traces a recorded gaze ray stream against the world as it is now and regenerates the session from it: UVs,
+* actors, face axes, gaze points and voxels, without the participant. Rays are traced in fixed-size batches,
+* one worker each; results are assembled in recording order afterwards, so runs merge like they do live.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FGazeReprojector
+{
+public:
+	static constexpr int32 DefaultBatchSize = 256;
+
+	// Returns false for worlds without trace collision
+	static bool Reproject(const UWorld* World, const FGazeRayStream& GazeRays,
+		TArray<FAttentionTrackingDataPoint>& OutAttentionTrackingData, FGazePointCloud* OutGazePoints = nullptr,
+		FAttentionVolume* OutAttentionVolume = nullptr, const int32 BatchSize = DefaultBatchSize);
+
+private:
+	// Dwell time of a ray is the time since the previous one, capped so gaps in recording don't count
+	static constexpr float MaxRayDwellTime = 0.1f;
+};
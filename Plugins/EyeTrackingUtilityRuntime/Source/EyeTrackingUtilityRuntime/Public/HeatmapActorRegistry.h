@@ -0,0 +1,58 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HeatmapActorRegistry.generated.h"
+
+class AHeatmapReadyActor;
+class AHeatmapUvLookupCache;
+
+UCLASS()
+class EYETRACKINGUTILITYRUNTIME_API UHeatmapActorRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UHeatmapActorRegistry* Get(const UObject* WorldContextObject);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Actor Registry")
+	AHeatmapReadyActor* FindActor(const FGuid& ActorGuid);
+
+	// Fallback for files recorded before actors carried a GUID
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Actor Registry")
+	FGuid FindGuidByObjectName(const FString& ObjectName);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Actor Registry")
+	void GetAllActors(TArray<AHeatmapReadyActor*>& OutActors);
+
+	AHeatmapUvLookupCache* GetUvLookupCache();
+
+	void RegisterActor(AHeatmapReadyActor* Actor);
+	void UnregisterActor(const AHeatmapReadyActor* Actor);
+
+private:
+	void OnActorSpawned(AActor* Actor);
+	void OnActorDestroyed(AActor* Actor);
+	void OnLevelsChanged(ULevel* Level, UWorld* World);
+
+	void Rebuild();
+	void RebuildIfDirty();
+
+	TMap<FGuid, TWeakObjectPtr<AHeatmapReadyActor>> ActorsByGuid;
+	TMap<FString, FGuid> GuidsByObjectName;
+	TSet<FGuid> MissingGuids;
+
+	TWeakObjectPtr<AHeatmapUvLookupCache> UvLookupCache;
+
+	bool bDirty = true;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
@@ -0,0 +1,79 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "HeatmapAoi.generated.h"
+
+struct FHeatmapUvTriangleTable;
+
+UENUM(BlueprintType)
+enum class EHeatmapAoiShape : uint8
+{
+	EHAS_UvPolygon UMETA(DisplayName = "UV Polygon"),
+	EHAS_LocalBox UMETA(DisplayName = "Local Box"),
+	EHAS_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+// Part of an actor's surface, e.g. the door of a facade mesh; metrics are reported per AOI
+USTRUCT(BlueprintType, Category = "Areas of Interest")
+struct FHeatmapAoi
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Areas of Interest")
+	FString Name = "";
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Areas of Interest")
+	EHeatmapAoiShape Shape = EHeatmapAoiShape::EHAS_UvPolygon;
+
+	// In the actor's heatmap UV channel
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Areas of Interest",
+		meta = (EditCondition = "Shape == EHeatmapAoiShape::EHAS_UvPolygon", EditConditionHides))
+	TArray<FVector2D> UvPolygon;
+
+	// In the static mesh component's space, so the volume moves with the actor
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Areas of Interest",
+		meta = (EditCondition = "Shape == EHeatmapAoiShape::EHAS_LocalBox", EditConditionHides))
+	FBox LocalBox = FBox(FVector(-50.0), FVector(50.0));
+};
+
+/*
+* Uniform grid over UV space listing the AOIs each cell touches, so a sample only tests the few polygons of its
+* own cell. Box AOIs are resolved into UV cells up front through the mesh's UV lookup table and need no test
+* at all. Cells are stored flat, each as a range into one entry array.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FHeatmapAoiIndex
+{
+public:
+	static constexpr int32 DefaultResolution = 128;
+
+	// Table may be null; box AOIs then can't be classified
+	void Build(const TArray<FHeatmapAoi>& Aois, const FHeatmapUvTriangleTable* Table,
+		const int32 InResolution = DefaultResolution);
+
+	void Classify(const FVector2D& Uv, TArray<int32, TInlineAllocator<4>>& OutAoiIndices) const;
+
+	bool IsEmpty() const { return Entries.IsEmpty(); }
+
+private:
+	static bool IsInsidePolygon(const FVector2D& Point, const TArray<FVector2D>& Polygon);
+
+	int32 GetCellIndex(const FVector2D& Uv) const;
+
+	// Cells per axis of the grid box AOIs are bucketed in while they are resolved into UV cells
+	static constexpr int32 BoxGridResolution = 16;
+
+	int32 Resolution = 0;
+
+	// Entries of cell i are Entries[CellStarts[i]] up to Entries[CellStarts[i + 1]]
+	TArray<int32> CellStarts;
+
+	// AOI index; the high bit marks entries that still need the polygon test
+	TArray<uint32> Entries;
+
+	TArray<TArray<FVector2D>> Polygons;
+
+	static constexpr uint32 NeedsTestFlag = 1u << 31;
+};
@@ -0,0 +1,43 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "HeatmapRT.h"
+
+class AHeatmapReadyActor;
+
+/*
+* Baked render target contents per session and actor on disk, so re-opening an unchanged session uploads
+* the finished heatmaps instead of replaying every sample. Loading a bake marks it as recently used; Trim deletes
+* the least recently used bakes once the folder outgrows MaxCacheSize. Deleting the folder is always safe.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FHeatmapBakeCache
+{
+public:
+	static FString ComputeSessionHash(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData);
+
+	// Session contents, actor GUID and scale divisors, brush material and resolution
+	static FString MakeKey(const FString& SessionHash, const AHeatmapReadyActor* HeatmapReadyActor);
+
+	static bool Load(const FString& Key, const int32 Resolution, TArray<FFloat16Color>& OutPixels);
+	static bool Save(const FString& Key, const int32 Resolution, const TArray<FFloat16Color>& Pixels);
+
+	static FString CacheFolderPath();
+
+	// Least recently used bakes first, until the folder fits into MaxSize bytes
+	static void Trim(const int64 MaxSize = MaxCacheSize);
+
+	static constexpr int64 MaxCacheSize = 2048ll * 1024 * 1024;
+
+	// Also used for in-memory playback snapshots
+	static bool CompressPixels(const TArray<FFloat16Color>& Pixels, TArray<uint8>& OutCompressed);
+	static bool UncompressPixels(const TArray<uint8>& Compressed, const int32 NumPixels, TArray<FFloat16Color>& OutPixels);
+
+private:
+	static FString GetFilePath(const FString& Key);
+
+	static constexpr uint32 FileMagic = 0x4B424D48;
+	static constexpr uint32 FileVersion = 1;
+};
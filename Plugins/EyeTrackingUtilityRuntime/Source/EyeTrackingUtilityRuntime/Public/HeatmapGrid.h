@@ -0,0 +1,188 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "HeatmapRT.h"
+
+class AHeatmapReadyActor;
+struct FHeatmapUvTriangleTable;
+
+// Distribution of attention over an actor's surface; moments are in UV units
+struct FHeatmapGridStats
+{
+	// Fraction of the surface area with any attention
+	float Coverage = 0.f;
+
+	// Shannon entropy relative to attention spread evenly over the surface: 0 is a single texel, 1 is uniform
+	float Entropy = 0.f;
+
+	float Peak = 0.f;
+
+	FVector2D Centroid = FVector2D::ZeroVector;
+	FVector2D Variance = FVector2D::ZeroVector;
+	float Covariance = 0.f;
+};
+
+// CPU-side heatmap of one actor in UV space, for baking without a renderer
+struct EYETRACKINGUTILITYRUNTIME_API FHeatmapGrid
+{
+	int32 Resolution = 0;
+	TArray<float> Values;
+
+	void Init(const int32 InResolution);
+	void Reset();
+
+	// Gaussian splat; the brush covers BrushRadius / ScaleDivisor in UV space, like the paint brush material
+	void Splat(const FVector2D& Uv, const FVector2D& ScaleDivisor, const float BrushRadius, const float Weight);
+
+	void Add(const FHeatmapGrid& Other, const float Weight = 1.f);
+
+	float GetMax() const;
+
+	// Transparent blue (cold) to opaque red (hot), relative to NormalizeMax
+	void ToColors(TArray<FColor>& OutColors, const float NormalizeMax) const;
+
+	// Bilinearly resampled intensity in every channel, like the paint brush leaves in an actor's render target
+	void ToRenderTargetPixels(TArray<FFloat16Color>& OutPixels, const int32 TargetResolution, const float Scale) const;
+
+	// Signed grids: blue (negative) through transparent (zero) to red (positive), relative to NormalizeMax
+	void ToDivergingColors(TArray<FColor>& OutColors, const float NormalizeMax) const;
+
+	// The canvas material maps a single intensity through its own ramp, so the sign is encoded around the middle
+	// of it: 0.5 where the value is zero, 1 at +1 / Scale, 0 at -1 / Scale. Every channel holds the same value.
+	void ToDivergingRenderTargetPixels(TArray<FFloat16Color>& OutPixels, const int32 TargetResolution,
+		const float Scale) const;
+
+	float GetMaxAbs() const;
+
+	// Texels are weighted by the surface area they cover, every texel equally without TexelAreas.
+	// Rows are reduced in parallel.
+	FHeatmapGridStats ComputeStats(const TArray<float>* TexelAreas = nullptr) const;
+
+	// Several grids as one surface, e.g. every actor reported under the same metrics name
+	static FHeatmapGridStats ComputeStats(const TArray<const FHeatmapGrid*>& Grids,
+		TArray<const TArray<float>*> TexelAreas);
+
+	// Rasterizes the table's triangles; texels no triangle covers get no area
+	static void ComputeTexelAreas(const FHeatmapUvTriangleTable& Table, const FVector& Scale, const int32 Resolution,
+		TArray<float>& OutTexelAreas);
+
+	static FLinearColor GetDivergingColor(const float SignedValue);
+
+	// The paint brush material has no weight input, so a weighted sample is a brush covering Weight times the
+	// area at the same peak; the grids splat it the same way so they match what was painted
+	static FVector2D WeightScaleDivisor(const FVector2D& ScaleDivisor, const float Weight);
+
+	// A * ScaleA - B * ScaleB, four cells at a time; a missing grid counts as zero
+	static void SignedDifference(const FHeatmapGrid* A, const float ScaleA, const FHeatmapGrid* B, const float ScaleB,
+		FHeatmapGrid& OutDifference);
+};
+
+// Accumulates the grids of every actor a session touched; actors are painted in parallel
+class EYETRACKINGUTILITYRUNTIME_API FHeatmapAccumulator
+{
+public:
+	explicit FHeatmapAccumulator(const int32 InResolution = DefaultResolution, const float InBrushRadius = DefaultBrushRadius);
+
+	static constexpr int32 DefaultResolution = 512;
+	static constexpr float DefaultBrushRadius = 0.025f;
+
+	// Paint brush scale divisors per actor, indexed by EHeatmapFaceAxis; actors without an entry use (1, 1)
+	void SetScaleDivisors(const FGuid& ActorGuid, const TArray<FVector2D>& ScaleDivisors);
+	void SetScaleDivisors(const AHeatmapReadyActor* HeatmapReadyActor);
+
+	void Accumulate(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData, const float Weight = 1.f);
+
+	// Several participants into the same grids: each worker splats into its own partial grids, which are summed
+	// per actor at the end. Per participant normalization weighs every session by 1 / its sample count.
+	void AccumulateComposite(const TArray<const TArray<FAttentionTrackingDataPoint>*>& Sessions,
+		const bool bNormalizePerParticipant);
+
+	void Reset();
+
+	const TMap<FGuid, FHeatmapGrid>& GetGrids() const { return Grids; }
+	const FHeatmapGrid* FindGrid(const FGuid& ActorGuid) const { return Grids.Find(ActorGuid); }
+
+	int32 GetResolution() const { return Resolution; }
+	float GetBrushRadius() const { return BrushRadius; }
+
+private:
+	FVector2D GetScaleDivisor(const FGuid& ActorGuid, const EHeatmapFaceAxis FaceAxis) const;
+
+	int32 Resolution;
+	float BrushRadius;
+
+	TMap<FGuid, FHeatmapGrid> Grids;
+	TMap<FGuid, TArray<FVector2D>> ScaleDivisorsByActor;
+};
+
+/*
+* Recent attention per actor, kept up to date as samples come in and time advances, without repainting history.
+* The sliding window is a ring of sub-grids, one per bucket of the window, plus their running sum; the oldest
+* bucket is subtracted and recycled once it falls out of the window. Decay stores samples pre-scaled by
+* exp(t / TimeConstant) relative to a reference time, so advancing time only changes the read-out factor.
+* Grids that got samples, lost a bucket or faded out are marked dirty, so the display only uploads those.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FHeatmapTemporalAccumulator
+{
+public:
+	FHeatmapTemporalAccumulator(const EHeatmapAccumulationMode InMode, const float InSeconds,
+		const int32 InResolution = DefaultResolution, const float InBrushRadius = FHeatmapAccumulator::DefaultBrushRadius);
+
+	static constexpr int32 DefaultResolution = 256;
+	static constexpr int32 NumBuckets = 8;
+
+	void AddSample(const FGuid& ActorGuid, const float Time, const FVector2D& Uv, const FVector2D& ScaleDivisor,
+		const float Weight);
+
+	void AdvanceTo(const float Time);
+
+	void Reset();
+
+	// Current intensity is the stored grid times this factor
+	float GetReadOutScale() const;
+
+	// How far back samples still matter at the current time
+	float GetHistorySpan() const;
+
+	const TMap<FGuid, FHeatmapGrid>& GetGrids() const;
+
+	// Grids that changed since the last call
+	void ConsumeDirtyGrids(TSet<FGuid>& OutDirtyGrids);
+
+	// Grids that still hold samples; empty once everything has left the window or faded out
+	const TSet<FGuid>& GetLiveGrids() const { return LiveGrids; }
+
+	EHeatmapAccumulationMode GetMode() const { return Mode; }
+
+private:
+	void RebaseDecay(const float NewReferenceTime);
+
+	TSet<FGuid> DirtyGrids;
+	TSet<FGuid> LiveGrids;
+
+	EHeatmapAccumulationMode Mode;
+	float Seconds;
+	int32 Resolution;
+	float BrushRadius;
+
+	float CurrentTime = 0.f;
+
+	// Sliding window
+	TMap<FGuid, TArray<FHeatmapGrid>> WindowBuckets;
+	TMap<FGuid, FHeatmapGrid> WindowSums;
+	int64 HeadBucket = 0;
+
+	// One bit per bucket that holds samples
+	TMap<FGuid, uint8> FilledBuckets;
+	static_assert(NumBuckets <= 8, "FilledBuckets has one bit per bucket");
+
+	// Exponential decay
+	TMap<FGuid, FHeatmapGrid> DecayGrids;
+	float DecayReferenceTime = 0.f;
+
+	// A grid is cleared once its last sample is older than the history span
+	TMap<FGuid, float> LastSampleTimes;
+};
@@ -0,0 +1,117 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "HeatmapHotspots.generated.h"
+
+struct FAttentionTrackingDataPoint;
+class FGazePointCloud;
+
+UENUM(BlueprintType)
+enum class EHeatmapHotspotSpace : uint8
+{
+	EHHS_Uv UMETA(DisplayName = "UV"),
+	EHHS_World UMETA(DisplayName = "World"),
+	EHHS_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+USTRUCT(BlueprintType, Category = "Hotspots")
+struct FHeatmapHotspotSettings
+{
+	GENERATED_BODY()
+
+	// Neighbourhood radius in UV units
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hotspots")
+	float UvRadius = 0.03f;
+
+	// Neighbourhood radius in cm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hotspots")
+	float WorldRadius = 30.f;
+
+	// Dwell time a sample's neighbourhood needs to seed or extend a hotspot
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hotspots")
+	float MinDwellTime = 0.5f;
+
+	// Upper bound for the time a single sample stands for, so pauses in tracking don't count as dwell
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hotspots")
+	float MaxSampleDwellTime = 0.25f;
+
+	// Per space; 0 keeps all of them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hotspots")
+	int32 MaxHotspots = 5;
+};
+
+USTRUCT(BlueprintType, Category = "Hotspots")
+struct FHeatmapHotspot
+{
+	GENERATED_BODY()
+
+	// 1 is the hotspot with the most dwell time in its space
+	UPROPERTY(BlueprintReadOnly, Category = "Hotspots")
+	int32 Rank = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hotspots")
+	EHeatmapHotspotSpace Space = EHeatmapHotspotSpace::EHHS_Uv;
+
+	// Metrics name of the actor, empty for world hotspots
+	UPROPERTY(BlueprintReadOnly, Category = "Hotspots")
+	FString Name = "";
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hotspots")
+	FGuid ActorGuid;
+
+	// Dwell-weighted; UV hotspots only use X and Y
+	UPROPERTY(BlueprintReadOnly, Category = "Hotspots")
+	FVector Centroid = FVector::ZeroVector;
+
+	// Half the size of the bounding box of the hotspot's samples
+	UPROPERTY(BlueprintReadOnly, Category = "Hotspots")
+	FVector Extent = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hotspots")
+	float DwellTime = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hotspots")
+	int32 SampleCount = 0;
+
+	// Recording time of every sample in the hotspot, ascending
+	UPROPERTY(BlueprintReadOnly, Category = "Hotspots")
+	TArray<float> Timestamps;
+};
+
+/*
+* Dwell-weighted DBSCAN over gaze samples: a sample is a core sample if the dwell time within the radius around
+* it reaches MinDwellTime, hotspots are the connected core samples plus the samples they reach.
+* Neighbours are found through a spatial hash with the radius as cell size, so each lookup checks at most
+* 9 (UV) or 27 (world) cells. UV samples are clustered per actor, one worker each.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FHeatmapHotspotFinder
+{
+public:
+	static void FindUvHotspots(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+		const TMap<FString, FString>& MetricsNames, const FHeatmapHotspotSettings& Settings,
+		TArray<FHeatmapHotspot>& OutHotspots);
+
+	static void FindWorldHotspots(const FGazePointCloud& GazePoints, const FHeatmapHotspotSettings& Settings,
+		TArray<FHeatmapHotspot>& OutHotspots);
+
+	// Sorts by dwell time and keeps the first MaxHotspots, 0 keeps all
+	static void RankHotspots(TArray<FHeatmapHotspot>& Hotspots, const int32 MaxHotspots);
+
+private:
+	struct FSample
+	{
+		FVector Location;
+		float Time;
+		float DwellTime;
+	};
+
+	// Labels are cluster indices, INDEX_NONE for noise
+	static int32 Cluster(const TArray<FSample>& Samples, const float Radius, const float MinDwellTime,
+		const bool bPlanar, TArray<int32>& OutLabels);
+
+	static void MakeHotspots(const TArray<FSample>& Samples, const TArray<int32>& Labels, const int32 ClustersNum,
+		const EHeatmapHotspotSpace Space, TArray<FHeatmapHotspot>& OutHotspots);
+};
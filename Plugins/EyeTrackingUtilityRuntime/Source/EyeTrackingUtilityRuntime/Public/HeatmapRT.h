@@ -4,6 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "AttentionVolume.h"
+#include "GazePointCloud.h"
+#include "HeatmapHotspots.h"
+
 #include "HeatmapRT.generated.h"
 
 UENUM(BlueprintType)
@@ -17,6 +22,26 @@ enum class ESortMode : uint8
 	ESM_MAX UMETA(DisplayName = "DefaultMAX")
 };
 
+// How playback weighs past samples: all of them, only the last N seconds, or fading with time constant N
+UENUM(BlueprintType)
+enum class EHeatmapAccumulationMode : uint8
+{
+	EHAM_Cumulative UMETA(DisplayName = "Cumulative"),
+	EHAM_SlidingWindow UMETA(DisplayName = "Sliding Window"),
+	EHAM_ExponentialDecay UMETA(DisplayName = "Exponential Decay"),
+	EHAM_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+// Dominant axis of the hit face, relative to the actor; indexes the actor's brush scale table
+UENUM(BlueprintType)
+enum class EHeatmapFaceAxis : uint8
+{
+	EHFA_Forward UMETA(DisplayName = "Forward"),
+	EHFA_Right UMETA(DisplayName = "Right"),
+	EHFA_Up UMETA(DisplayName = "Up"),
+	EHFA_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
 USTRUCT(BlueprintType, Category = "RenderTargetCoordinatesData")
 struct FAttentionTrackingDataPoint
 {
@@ -28,11 +53,26 @@ struct FAttentionTrackingDataPoint
 	UPROPERTY(BlueprintReadWrite, Category = "RenderTargetCoordinatesData")
 	FString ObjectName = "";
 
+	UPROPERTY(BlueprintReadWrite, Category = "RenderTargetCoordinatesData")
+	FGuid ActorGuid;
+
 	UPROPERTY(BlueprintReadWrite, Category = "RenderTargetCoordinatesData")
 	FVector2D Coordinates = FVector2D(0.0, 0.0);
 
 	UPROPERTY(BlueprintReadWrite, Category = "RenderTargetCoordinatesData")
-	FVector2D PaintBrushScaleDivisor = FVector2D(1.0, 1.0);
+	EHeatmapFaceAxis FaceAxis = EHeatmapFaceAxis::EHFA_Forward;
+
+	// A data point may stand for a run of consecutive, (nearly) identical samples:
+	// Duration is the time between the first and the last sample of the run
+	UPROPERTY(BlueprintReadWrite, Category = "RenderTargetCoordinatesData")
+	float Duration = 0.f;
+
+	UPROPERTY(BlueprintReadWrite, Category = "RenderTargetCoordinatesData")
+	int32 SampleCount = 1;
+
+	// Share of the foveal cone that fell on the actor, 1 for single-ray samples
+	UPROPERTY(BlueprintReadWrite, Category = "RenderTargetCoordinatesData")
+	float Weight = 1.f;
 };
 
 USTRUCT(BlueprintType, Category = "AttentionMetrics")
@@ -52,11 +92,121 @@ struct FAttentionMetricsEntry
 	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
 	int32 TimesFocussed = 0;
 
+	// Time the actor was in view (and, if tested, not occluded), whether looked at or not
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float VisibleTime = 0.f;
+
+	// TotalAttentionTime / VisibleTime; near 0 for objects that were seen but ignored
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float AttendedToVisibleRatio = 0.f;
+
+	// Fraction of the surface that received any attention
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float Coverage = 0.f;
+
+	// 0 is all attention on one spot, 1 is attention spread evenly over the surface
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float Entropy = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float PeakDensity = 0.f;
+
+	// In UV units, like the variances
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	FVector2D DensityCentroid = FVector2D::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	FVector2D DensityVariance = FVector2D::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float DensityCovariance = 0.f;
+
 	// Obsolete?
 	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
 	TArray<int> AttentionSequenceIndices = {};
 };
 
+// A waypoint reached while recording; the legs of the route run from one marker to the next
+USTRUCT(BlueprintType, Category = "Waypoints")
+struct FHeatmapSegmentMarker
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Waypoints")
+	float Time = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Waypoints")
+	int32 WaypointIndex = INDEX_NONE;
+};
+
+/*
+* Metrics of one leg of the route. A dwell is never split: one that crosses a waypoint marker counts entirely
+* towards the leg it started in, attention time and all, so a leg's TotalAttentionTime can run past its EndTime.
+* Summed over all legs, the metrics equal the session's. FirstAttentionAfter is relative to the leg's StartTime.
+*/
+USTRUCT(BlueprintType, Category = "AttentionMetrics")
+struct FHeatmapSegmentMetrics
+{
+	GENERATED_BODY()
+
+	// INDEX_NONE for the leg from the start of the recording to the first waypoint
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	int32 FromWaypointIndex = INDEX_NONE;
+
+	// INDEX_NONE for the leg after the last waypoint
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	int32 ToWaypointIndex = INDEX_NONE;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float StartTime = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float EndTime = 0.f;
+
+	// FirstAttentionAfter is relative to StartTime
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	TMap<FString, FAttentionMetricsEntry> Metrics;
+};
+
+// Cohort A against cohort B for one MetricsName, averaged over each cohort's sessions
+USTRUCT(BlueprintType, Category = "AttentionMetrics")
+struct FAttentionMetricsDelta
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float TotalAttentionTimeA = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float TotalAttentionTimeB = 0.f;
+
+	// A - B
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float TotalAttentionTimeDelta = 0.f;
+
+	// Averaged over the sessions that attended the object at all
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float FirstAttentionAfterA = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float FirstAttentionAfterB = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	float FirstAttentionAfterDelta = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	int32 SessionsAttendedA = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AttentionMetrics")
+	int32 SessionsAttendedB = 0;
+};
+
+struct FHeatmapGrid;
+
+// File name of the session SaveHeatmap just wrote, so recorders can save their sidecars next to it
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnHeatmapSaved, const FString&);
+
+// Thin Blueprint facade; loaded sessions and playback state live in UHeatmapSessionSubsystem (per world)
 UCLASS()
 class EYETRACKINGUTILITYRUNTIME_API UHeatmapRT : public UBlueprintFunctionLibrary
 {
@@ -67,15 +217,43 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Saving and Loading")
 	static void SaveHeatmap(const FString& FileName, const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData);
 
+	static FOnHeatmapSaved OnHeatmapSaved;
+
+	// Replaces the world's active session
 	UFUNCTION(BlueprintCallable, Category = "Saving and Loading")
 	static void LoadHeatmap(const FString& FileName, const UObject* WorldContextObject, const float MetricsThreshold = 0.f);
 
+	// Traces the session's recorded gaze rays against the current level and saves the result as a new session
+	UFUNCTION(BlueprintCallable, Category = "Saving and Loading", meta = (WorldContext = "WorldContextObject"))
+	static bool ReprojectHeatmap(const UObject* WorldContextObject, const FString& FileName,
+		const FString& ReprojectedFileName);
+
 	UFUNCTION(BlueprintCallable, Category = "Painting")
 	static void PaintLoadedHeatmap(UObject* WorldContextObject, const bool bLoadImmediately);
 
 	UFUNCTION(BlueprintCallable, Category = "Painting")
 	static void StopTimer(UObject* WorldContextObject);
 
+	// Loads the files not loaded yet and paints all of them as one heatmap; the active session stays as it was
+	UFUNCTION(BlueprintCallable, Category = "Painting")
+	static void PaintCompositeHeatmap(UObject* WorldContextObject, const TArray<FString>& FileNames,
+		const bool bNormalizePerParticipant = true, const float MetricsThreshold = 0.f);
+
+	// Paints where cohort A looked more (hot end of the heatmap ramp) or less (cold end) than cohort B, with the
+	// middle of the ramp where they agree, and returns the metrics deltas
+	UFUNCTION(BlueprintCallable, Category = "Painting")
+	static void PaintDifferenceHeatmap(UObject* WorldContextObject, const TArray<FString>& FileNamesA,
+		const TArray<FString>& FileNamesB, TMap<FString, FAttentionMetricsDelta>& OutMetricsDeltas,
+		const float MetricsThreshold = 0.f);
+
+	// Applies from the next PaintLoadedHeatmap or seek; immediate painting is always cumulative
+	UFUNCTION(BlueprintCallable, Category = "Painting")
+	static void SetHeatmapAccumulationMode(UObject* WorldContextObject, const EHeatmapAccumulationMode Mode,
+		const float Seconds = 10.f);
+
+	UFUNCTION(BlueprintCallable, Category = "Painting")
+	static void SeekLoadedHeatmap(UObject* WorldContextObject, const float Time, const bool bResumePlayback);
+
 	UFUNCTION(BlueprintPure, Category = "Saving and Loading")
 	static FString GetLastSavedOrLoadedHeatmapFileName();
 
@@ -85,22 +263,124 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Reset")
 	static void ResetHeatmap(UObject* WorldContextObject, UMaterialInterface* PaintBrushMaterialAsset);
 
-	UFUNCTION(BlueprintCallable, Category = "Attention Metrics")
-	static void CalculateAttentionMetrics(const TMap<FString, FString>& MetricsNames, const float Threshold = 0.f);
+	// Keyed by actor GUID like GetMetricsNames' output, object-name keys are still accepted
+	UFUNCTION(BlueprintCallable, Category = "Attention Metrics", meta = (WorldContext = "WorldContextObject"))
+	static void CalculateAttentionMetrics(const UObject* WorldContextObject, const TMap<FString, FString>& MetricsNames,
+		const float Threshold = 0.f);
+
+	UFUNCTION(BlueprintCallable, Category = "Attention Tracking Data", meta = (WorldContext = "WorldContextObject"))
+	static void GetAttentionTrackingDataCurrentlyLoaded(const UObject* WorldContextObject,
+		TArray<FAttentionTrackingDataPoint>& OutData);
+
+	UFUNCTION(BlueprintPure, Category = "Attention Metrics", meta = (WorldContext = "WorldContextObject"))
+	static void GetAttentionMetrics(const UObject* WorldContextObject, TMap<FString, FAttentionMetricsEntry>& OutMetrics);
+
+	// World-space attention of the active session; false if it was recorded without an attention volume
+	UFUNCTION(BlueprintCallable, Category = "Attention Volume", meta = (WorldContext = "WorldContextObject"))
+	static bool QueryAttentionVolumeBox(const UObject* WorldContextObject, const FBox& Box,
+		FAttentionVolumeQueryResult& OutResult);
 
-	UFUNCTION(BlueprintCallable, Category = "Attention Tracking Data")
-	static void GetAttentionTrackingDataCurrentlyLoaded(TArray<FAttentionTrackingDataPoint>& OutData);
+	// Heatmap ready actors use the voxels recorded on them, other actors their bounds
+	UFUNCTION(BlueprintCallable, Category = "Attention Volume", meta = (WorldContext = "WorldContextObject"))
+	static bool QueryAttentionVolumeActor(const UObject* WorldContextObject, const AActor* Actor,
+		FAttentionVolumeQueryResult& OutResult);
 
-	UFUNCTION(BlueprintPure, Category = "Attention Metrics")
-	static void GetAttentionMetrics(TMap<FString, FAttentionMetricsEntry>& OutMetrics);
+	// Recorded gaze hits of the active session, as ranges of consecutive samples; false without recorded gaze points
+	UFUNCTION(BlueprintCallable, Category = "Gaze Points", meta = (WorldContext = "WorldContextObject"))
+	static bool QueryGazePointsInRadius(const UObject* WorldContextObject, const FVector& Center, const float Radius,
+		TArray<FGazeSampleRange>& OutRanges);
+
+	UFUNCTION(BlueprintCallable, Category = "Gaze Points", meta = (WorldContext = "WorldContextObject"))
+	static bool QueryGazePointsInBox(const UObject* WorldContextObject, const FBox& Box,
+		TArray<FGazeSampleRange>& OutRanges);
+
+	UFUNCTION(BlueprintCallable, Category = "Gaze Points", meta = (WorldContext = "WorldContextObject"))
+	static bool QueryGazePointsInCameraView(const UObject* WorldContextObject, class UCameraComponent* Camera,
+		TArray<FGazeSampleRange>& OutRanges);
+
+	static const FGazePointCloud* GetActiveSessionGazePoints(const UObject* WorldContextObject);
+
+	// Spots of the active session's heatmaps that drew the most attention, ranked by dwell time
+	UFUNCTION(BlueprintCallable, Category = "Hotspots", meta = (WorldContext = "WorldContextObject"))
+	static void FindHotspots(const UObject* WorldContextObject, const FHeatmapHotspotSettings& Settings,
+		TArray<FHeatmapHotspot>& OutHotspots);
+
+	// Same for the recorded world-space gaze hits; false without recorded gaze points
+	UFUNCTION(BlueprintCallable, Category = "Hotspots", meta = (WorldContext = "WorldContextObject"))
+	static bool FindWorldHotspots(const UObject* WorldContextObject, const FHeatmapHotspotSettings& Settings,
+		TArray<FHeatmapHotspot>& OutHotspots);
 
 	UFUNCTION(BlueprintCallable, Category = "Attention Metrics")
 	static void GetMetricsNames(const UObject* WorldContextObject, TMap<FString, FString>& OutMetricsNames);
 
-	UFUNCTION(BlueprintCallable, Category = "Attention Metrics")
-	static void SortAttentionMetrics(ESortMode SortMode, bool bAscending);
+	// Keyed "<actor metrics name>/<AOI name>"
+	UFUNCTION(BlueprintPure, Category = "Attention Metrics", meta = (WorldContext = "WorldContextObject"))
+	static void GetAoiMetrics(const UObject* WorldContextObject, TMap<FString, FAttentionMetricsEntry>& OutMetrics);
+
+	// One entry per leg of the route, empty if the session was recorded without waypoints
+	UFUNCTION(BlueprintPure, Category = "Attention Metrics", meta = (WorldContext = "WorldContextObject"))
+	static void GetSegmentMetrics(const UObject* WorldContextObject, TArray<FHeatmapSegmentMetrics>& OutSegmentMetrics);
+
+	UFUNCTION(BlueprintCallable, Category = "Attention Metrics", meta = (WorldContext = "WorldContextObject"))
+	static void SortAttentionMetrics(const UObject* WorldContextObject, ESortMode SortMode, bool bAscending);
 	
 	static void PaintHeatmapDataPoint(const FAttentionTrackingDataPoint& DataPoint, const UObject* WorldContextObject);
+
+	static void ComputeAttentionMetrics(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+		const TMap<FString, FString>& MetricsNames, const float Threshold, TMap<FString, FAttentionMetricsEntry>& OutMetrics);
+
+	// Also splits the metrics by the legs between SegmentMarkers, in the same pass over the data
+	static void ComputeAttentionMetrics(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+		const TMap<FString, FString>& MetricsNames, const float Threshold,
+		const TArray<FHeatmapSegmentMarker>& SegmentMarkers, TMap<FString, FAttentionMetricsEntry>& OutMetrics,
+		TArray<FHeatmapSegmentMetrics>& OutSegmentMetrics);
+
+	// A visit lasts as long as consecutive data points stay inside the AOI; visits shorter than Threshold are dropped.
+	// Keyed <metrics name>/<AOI name> from the same MetricsNames as ComputeAttentionMetrics.
+	static void ComputeAoiMetrics(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+		const TMap<FString, FString>& MetricsNames, const UObject* WorldContextObject, const float Threshold,
+		TMap<FString, FAttentionMetricsEntry>& OutMetrics);
+
+	// Coverage, entropy and moments of the accumulated heatmap, added to each metrics name's existing entry.
+	// Actors sharing a metrics name count as one surface. Texels are weighted by the surface area they cover
+	// where every such actor's mesh has a UV lookup table. Accumulated at DensityMetricsResolution, so the
+	// numbers match wherever they are computed.
+	static void ComputeDensityMetrics(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+		const TMap<FString, FString>& MetricsNames, const UObject* WorldContextObject,
+		TMap<FString, FAttentionMetricsEntry>& InOutMetrics);
+
+	static void ComputeDensityMetrics(const TMap<FGuid, FHeatmapGrid>& Grids, const TMap<FString, FString>& MetricsNames,
+		const UObject* WorldContextObject, TMap<FString, FAttentionMetricsEntry>& InOutMetrics);
+
+	static constexpr int32 DensityMetricsResolution = 256;
+
+	// Adds entries for objects that were visible but never looked at
+	static void ApplyVisibleTimes(const TMap<FString, float>& VisibleTimes,
+		TMap<FString, FAttentionMetricsEntry>& InOutMetrics);
+
+	static void ComputeAttentionMetricsDeltas(const TArray<const TMap<FString, FAttentionMetricsEntry>*>& MetricsA,
+		const TArray<const TMap<FString, FAttentionMetricsEntry>*>& MetricsB, TMap<FString, FAttentionMetricsDelta>& OutDeltas);
+
+	static void SortAttentionMetricsMap(TMap<FString, FAttentionMetricsEntry>& AttentionMetrics, ESortMode SortMode, bool bAscending);
+
+	static bool IsSameActor(const FAttentionTrackingDataPoint& A, const FAttentionTrackingDataPoint& B);
+
+	// Key used by the metrics names map: the actor GUID, or the object name for unresolved legacy data
+	static FString GetMetricsKey(const FAttentionTrackingDataPoint& DataPoint);
+
+	static void ResolveLegacyActorGuids(TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+		const UObject* WorldContextObject);
+
+	static bool TryMergeIntoRun(FAttentionTrackingDataPoint& Run, const FAttentionTrackingDataPoint& DataPoint,
+		const float UvEpsilon = DefaultRunLengthUvEpsilon);
+
+	static void CompressAttentionTrackingData(TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+		const float UvEpsilon = DefaultRunLengthUvEpsilon);
+
+	static constexpr float DefaultRunLengthUvEpsilon = 0.0001f;
+
+	static void ResolveLegacyScaleDivisors(TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+		const TMap<int32, FVector2D>& LegacyScaleDivisors, const UObject* WorldContextObject);
 	
 	UFUNCTION(BlueprintCallable, Category = "Visualization")
 	static void BlendMaterialParameter(const UObject* WorldContextObject,
@@ -111,18 +391,17 @@ public:
 	
 	
 private:
-	static class AHeatmapReadyActor* LastActorPaintedOn;
-	static TArray<AHeatmapReadyActor*> HeatmapReadyActors;
-	
+	// Deliberately shared between worlds: the editor picks up the file last used in PIE
 	static FString LastSavedOrLoadedHeatmapFileName;
-	
-	static TArray<FAttentionTrackingDataPoint> AttentionTrackingDataCurrentlyLoaded;
-	
-	
-	static TMap<FString, FAttentionMetricsEntry> AttentionMetrics;
 
-	static void LogAttentionMetrics();
+	static void LogAttentionMetrics(const TMap<FString, FAttentionMetricsEntry>& AttentionMetrics);
+
+	// SaveHeatmap without notifying the recorders, for sessions that bring their own sidecars
+	static bool WriteHeatmap(const FString& FilePath, const TArray<FAttentionTrackingDataPoint>& AttentionTrackingData);
+
+	static void AddAttention(TMap<FString, FAttentionMetricsEntry>& Metrics, const FString& MetricsName,
+		const float AttentionTime, const float FirstAttentionAfter, const int32 AttentionSequenceIndex);
 
-	static TArray<FTimerHandle> HeatmapTimerHandles;
-	static TMap<FName, FTimerHandle> BlendParameterTimerHandles; 
+	static void MakeSegments(const TArray<FHeatmapSegmentMarker>& SegmentMarkers, const float EndTime,
+		TArray<FHeatmapSegmentMetrics>& OutSegmentMetrics);
 };
@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+
+#include "HeatmapRT.h"
+#include "HeatmapAoi.h"
+
 #include "HeatmapReadyActor.generated.h"
 
 UCLASS()
@@ -24,11 +28,44 @@ public:
 	void ScalePaintBrush(FVector2D ScaleDivisor) const;
 
 	UFUNCTION(BlueprintCallable, Category = "PaintHeatmap")
-	void PaintHeatmap(const FVector2D UV);
+	void ScalePaintBrushForFaceAxis(EHeatmapFaceAxis FaceAxis);
+
+	UFUNCTION(BlueprintCallable, Category = "PaintHeatmap")
+	void UpdateScaleDivisors();
+
+	UFUNCTION(BlueprintPure, Category = "PaintHeatmap")
+	EHeatmapFaceAxis GetFaceAxis(const FVector& ImpactNormal) const;
+
+	UFUNCTION(BlueprintPure, Category = "PaintHeatmap")
+	FVector2D GetScaleDivisor(EHeatmapFaceAxis FaceAxis) const;
+
+	// The divisor the paint brush ends up with, i.e. including the override
+	UFUNCTION(BlueprintPure, Category = "PaintHeatmap")
+	FVector2D GetPaintBrushScaleDivisor(EHeatmapFaceAxis FaceAxis) const;
+
+	EHeatmapFaceAxis FindFaceAxisForScaleDivisor(const FVector2D& ScaleDivisor) const;
+
+	// Weight scales the area the brush covers, see FHeatmapGrid::WeightScaleDivisor
+	UFUNCTION(BlueprintCallable, Category = "PaintHeatmap")
+	void PaintHeatmap(const FVector2D UV, const float Weight = 1.f);
+
+	UFUNCTION(BlueprintCallable, Category = "PaintHeatmap")
+	void PaintHeatmapRun(const FVector2D UV, const int32 SampleCount, const float Weight = 1.f);
 
 	UFUNCTION(BlueprintCallable, Category = "Materials")
 	TArray<UMaterialInterface*> GetMaterials();
 
+	// Raw render target access for the baked heatmap cache; reading flushes rendering
+	bool ReadHeatmapPixels(TArray<FFloat16Color>& OutPixels) const;
+
+	// Queues the read without flushing, OutPixels must stay alive until FlushRenderingCommands
+	bool EnqueueHeatmapPixelsRead(TArray<FFloat16Color>& OutPixels) const;
+	bool WriteHeatmapPixels(TArray<FFloat16Color>&& Pixels);
+	void ClearHeatmap();
+
+	int32 GetHeatmapResolution() const;
+	FString GetPaintBrushMaterialPath() const;
+
 	UFUNCTION(BlueprintCallable, Category = "PaintHeatmap")
 	static void SetEyesColor(const FColor Color);
 
@@ -47,6 +84,43 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scale Divisor Override", meta = (EditCondition = "bOverrideScaleDivisor"))
 	FVector2D ScaleDivisorOverride = { 1.0, 1.0 };
 
+	// Stable identity recorded sessions refer to; survives renames and PIE duplication
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Identity")
+	FGuid HeatmapActorGuid;
+
+	// Object names this actor had, for resolving sessions recorded before GUIDs were stored
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Identity")
+	TArray<FString> LegacyObjectNames;
+
+	// Non-overlapping UV channel picked (or generated) by the editor's UV analysis, INDEX_NONE if not analysed
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Heatmap UV")
+	int32 HeatmapUvChannel = INDEX_NONE;
+
+	UFUNCTION(BlueprintPure, Category = "Heatmap UV")
+	int32 GetHeatmapUvChannel(const int32 FallbackUvChannel) const
+	{
+		return HeatmapUvChannel != INDEX_NONE ? HeatmapUvChannel : FallbackUvChannel;
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Areas of Interest")
+	TArray<FHeatmapAoi> Aois;
+
+	// Built on first use from Aois and the mesh's UV lookup table
+	const FHeatmapAoiIndex& GetAoiIndex();
+
+	UFUNCTION(BlueprintCallable, Category = "Areas of Interest")
+	void InvalidateAoiIndex() { bAoiIndexDirty = true; }
+
+	// The mesh's UV lookup table, nullptr if the editor hasn't built one
+	const FHeatmapUvTriangleTable* FindUvTriangleTable() const;
+
+	// World-space surface area each heatmap texel covers at Resolution; false without a UV lookup table
+	bool ComputeTexelAreas(const int32 Resolution, TArray<float>& OutTexelAreas) const;
+
+	// Paint brush scale divisor per dominant face axis, indexed by EHeatmapFaceAxis
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Scale Divisor")
+	TArray<FVector2D> ScaleDivisors;
+
 protected:
 	virtual void BeginPlay() override;
 
@@ -71,7 +145,27 @@ private:
 
 	static FColor EyesColor;
 
+	// Reset whenever the brush is scaled any other way
+	mutable EHeatmapFaceAxis LastScaledFaceAxis = EHeatmapFaceAxis::EHFA_MAX;
+
+	// The divisor last set through ScalePaintBrush, before the sample weight is applied
+	mutable FVector2D PaintBrushScaleDivisor = FVector2D(1.0, 1.0);
+	float PaintBrushWeight = 1.f;
+
+	void ApplyPaintBrushScale() const;
+	void SetPaintBrushWeight(const float Weight);
+
+	FHeatmapAoiIndex AoiIndex;
+	bool bAoiIndexDirty = true;
+
+	// Another heatmap-ready actor in this actor's level already carries its GUID
+	bool HasGuidTwinInLevel() const;
+
 public:
 	virtual void Tick(float DeltaTime) override;
+	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void PostLoad() override;
+	virtual void PostDuplicate(EDuplicateMode::Type DuplicateMode) override;
+	virtual void PostEditImport() override;
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 };
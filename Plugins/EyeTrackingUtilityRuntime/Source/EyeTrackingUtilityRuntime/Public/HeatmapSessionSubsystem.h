@@ -0,0 +1,249 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "HeatmapRT.h"
+
+#include "HeatmapSessionSubsystem.generated.h"
+
+class AHeatmapReadyActor;
+class FHeatmapTemporalAccumulator;
+class FAttentionVolume;
+class FGazePointCloud;
+struct FHeatmapGrid;
+
+// One actor's render target, compressed, as it was at the time of a snapshot
+struct FHeatmapSnapshotLayer
+{
+	// Bake cache key at capture time, so a reset brush or resized target invalidates the layer
+	FString Key;
+	int32 Resolution = 0;
+	TArray<uint8> CompressedPixels;
+};
+
+// A delta holds only the actors painted since the previous snapshot; restoring one walks back to the last full
+// snapshot and takes each actor's most recent layer
+struct FHeatmapSnapshot
+{
+	float Time = 0.f;
+
+	// All data points before this index are painted into the layers
+	int32 NextDataPointIndex = 0;
+
+	bool bFull = false;
+
+	TMap<FGuid, FHeatmapSnapshotLayer> Layers;
+};
+
+USTRUCT(BlueprintType, Category = "Heatmap Session")
+struct FHeatmapSession
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Heatmap Session")
+	FString FileName = "";
+
+	UPROPERTY(BlueprintReadOnly, Category = "Heatmap Session")
+	TArray<FAttentionTrackingDataPoint> AttentionTrackingData;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Heatmap Session")
+	TMap<FString, FAttentionMetricsEntry> AttentionMetrics;
+
+	// Per area of interest, keyed "<actor metrics name>/<AOI name>"
+	UPROPERTY(BlueprintReadOnly, Category = "Heatmap Session")
+	TMap<FString, FAttentionMetricsEntry> AoiMetrics;
+
+	// Waypoints reached while recording, and the metrics of the legs between them
+	UPROPERTY(BlueprintReadOnly, Category = "Heatmap Session")
+	TArray<FHeatmapSegmentMarker> SegmentMarkers;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Heatmap Session")
+	TArray<FHeatmapSegmentMetrics> SegmentMetrics;
+
+	// Hash of the compressed data, keys the baked heatmap cache
+	FString ContentHash = "";
+
+	// World-space sidecar, if one was recorded with the session
+	TSharedPtr<FAttentionVolume> AttentionVolume;
+	TSharedPtr<FGazePointCloud> GazePoints;
+
+	// Seconds in view per MetricsName, empty if the session was recorded without visibility tracking
+	TMap<FString, float> VisibleTimes;
+
+	// Playback state
+	TArray<FTimerHandle> HeatmapTimerHandles;
+	TWeakObjectPtr<AHeatmapReadyActor> LastActorPaintedOn;
+	int32 PlaybackIndex = 0;
+
+	// Sorted by NextDataPointIndex; captured during the first timed pass or on demand
+	TArray<FHeatmapSnapshot> Snapshots;
+
+	// Furthest capture attempted, failed or not, so automatic snapshots don't retry on every data point
+	int32 LastSnapshotAttemptIndex = 0;
+	float LastSnapshotAttemptTime = 0.f;
+
+	// Set while playing back in a sliding window or decay mode, which replaces painting with the brush
+	TSharedPtr<FHeatmapTemporalAccumulator> TemporalAccumulator;
+	FTimerHandle TemporalDisplayTimerHandle;
+	float PlaybackStartWorldTime = 0.f;
+
+	// Normalization of the last upload, live grids are re-uploaded when it changes
+	float TemporalUploadScale = 0.f;
+};
+
+/*
+* Owns every session loaded into a world, by handle, so several sessions can be analysed side by side.
+* Being a world subsystem, the editor world and PIE worlds each get their own set of sessions.
+*/
+UCLASS()
+class EYETRACKINGUTILITYRUNTIME_API UHeatmapSessionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static UHeatmapSessionSubsystem* Get(const UObject* WorldContextObject);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	int32 LoadSession(const FString& FileName, const float MetricsThreshold = 0.f);
+
+	int32 AddSession(FHeatmapSession&& Session);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void UnloadSession(const int32 SessionHandle);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void SetActiveSession(const int32 SessionHandle);
+
+	UFUNCTION(BlueprintPure, Category = "Heatmap Sessions")
+	int32 GetActiveSession() const { return ActiveSessionHandle; }
+
+	UFUNCTION(BlueprintPure, Category = "Heatmap Sessions")
+	void GetLoadedSessions(TArray<int32>& OutSessionHandles) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void PaintSession(const int32 SessionHandle, const bool bLoadImmediately);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void StopSession(const int32 SessionHandle);
+
+	// Accumulates all given sessions on the CPU and uploads the combined heatmap once
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void PaintCompositeSessions(const TArray<int32>& SessionHandles, const bool bNormalizePerParticipant = true);
+
+	// Per participant normalized density of A minus that of B, uploaded with a diverging ramp
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void PaintDifferenceSessions(const TArray<int32>& SessionHandlesA, const TArray<int32>& SessionHandlesB,
+		TMap<FString, FAttentionMetricsDelta>& OutMetricsDeltas);
+
+	UFUNCTION(BlueprintPure, Category = "Heatmap Sessions")
+	int32 FindSessionByFileName(const FString& FileName) const;
+
+	// Handles of the files, loading the ones not loaded yet; the active session stays as it was
+	TArray<int32> FindOrLoadSessions(const TArray<FString>& FileNames, const float MetricsThreshold);
+
+	// Restores the nearest snapshot before Time and paints only the data points in between
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void SeekSession(const int32 SessionHandle, const float Time, const bool bResumePlayback);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void CaptureSnapshot(const int32 SessionHandle);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void ClearSnapshots(const int32 SessionHandle);
+
+	// Seconds is the window length or the decay time constant
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void SetAccumulationMode(const EHeatmapAccumulationMode Mode, const float Seconds);
+
+	UFUNCTION(BlueprintPure, Category = "Heatmap Sessions")
+	EHeatmapAccumulationMode GetAccumulationMode() const { return AccumulationMode; }
+
+	// Seconds of recording between automatic snapshots during timed playback, 0 disables them
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void SetSnapshotInterval(const float Interval) { SnapshotInterval = FMath::Max(Interval, 0.f); }
+
+	// MetricsNames is keyed by actor GUID as GetMetricsNames returns it; object-name keys from before actors
+	// carried a GUID still work and are resolved through the actor registry
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void CalculateSessionMetrics(const int32 SessionHandle, const TMap<FString, FString>& MetricsNames,
+		const float Threshold = 0.f);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void SortSessionMetrics(const int32 SessionHandle, ESortMode SortMode, bool bAscending);
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void GetSessionData(const int32 SessionHandle, TArray<FAttentionTrackingDataPoint>& OutData) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Heatmap Sessions")
+	void GetSessionMetrics(const int32 SessionHandle, TMap<FString, FAttentionMetricsEntry>& OutMetrics) const;
+
+	FHeatmapSession* FindSession(const int32 SessionHandle) { return Sessions.Find(SessionHandle); }
+	const FHeatmapSession* FindSession(const int32 SessionHandle) const { return Sessions.Find(SessionHandle); }
+
+	void PaintDataPoint(const int32 SessionHandle, const FAttentionTrackingDataPoint& DataPoint);
+
+	TMap<FName, FTimerHandle>& GetBlendParameterTimerHandles() { return BlendParameterTimerHandles; }
+
+private:
+	// Uploads cached bakes where possible, paints and caches the rest
+	void PaintSessionImmediately(FHeatmapSession& Session, const int32 SessionHandle);
+
+	// Sets a timer for every data point from FirstIndex on, relative to StartTime
+	void SchedulePlayback(FHeatmapSession& Session, const int32 SessionHandle, const int32 FirstIndex,
+		const float StartTime);
+
+	void OnPlaybackDataPoint(const int32 SessionHandle, const int32 DataPointIndex);
+
+	// Starts the display timer unless it is already running
+	void StartTemporalDisplay(FHeatmapSession& Session, const int32 SessionHandle);
+
+	bool RestoreSnapshot(const FHeatmapSession& Session, const int32 SnapshotIndex);
+
+	// Creates a fresh accumulator for the current mode, or drops it in cumulative mode
+	void ResetTemporalAccumulator(FHeatmapSession& Session);
+
+	void AddTemporalSample(FHeatmapSession& Session, const FAttentionTrackingDataPoint& DataPoint);
+	void UpdateTemporalHeatmap(const int32 SessionHandle);
+	void UploadTemporalHeatmap(FHeatmapSession& Session, const float Time);
+
+	// OnlyGrids limits the upload to those actors
+	void UploadGrids(const TMap<FGuid, FHeatmapGrid>& Grids, const float Scale, const bool bDiverging = false,
+		const TSet<FGuid>* OnlyGrids = nullptr);
+
+	// Stops the sessions and collects their data, metrics and actors
+	void GatherSessions(const TArray<int32>& SessionHandles, TArray<const TArray<FAttentionTrackingDataPoint>*>& OutData,
+		TArray<const TMap<FString, FAttentionMetricsEntry>*>& OutMetrics, TSet<AHeatmapReadyActor*>& OutActors);
+
+	AHeatmapReadyActor* ResolveActor(const FAttentionTrackingDataPoint& DataPoint);
+
+	void GetSessionActors(const FHeatmapSession& Session, TSet<AHeatmapReadyActor*>& OutActors);
+
+	float SnapshotInterval = 10.f;
+
+	// Bounds how far restoring a snapshot has to walk back
+	static constexpr int32 FullSnapshotInterval = 8;
+
+	EHeatmapAccumulationMode AccumulationMode = EHeatmapAccumulationMode::EHAM_Cumulative;
+	float AccumulationSeconds = 10.f;
+
+	static constexpr float TemporalDisplayInterval = 0.1f;
+
+	// Relative normalization change below which unchanged grids aren't re-uploaded
+	static constexpr float ScaleChangeTolerance = 0.01f;
+
+	UPROPERTY()
+	TMap<int32, FHeatmapSession> Sessions;
+
+	int32 ActiveSessionHandle = INDEX_NONE;
+	int32 NextSessionHandle = 0;
+
+	// Used when painting outside of any loaded session (e.g. single data points from Blueprint)
+	TWeakObjectPtr<AHeatmapReadyActor> LastActorPaintedOutsideSession;
+
+	TMap<FName, FTimerHandle> BlendParameterTimerHandles;
+};
@@ -0,0 +1,57 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "HeatmapUvLookupCache.generated.h"
+
+// Collision face index -> triangle UVs of one mesh, in the order the mesh's collision was cooked from
+USTRUCT()
+struct FHeatmapUvTriangleTable
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 UvChannel = 0;
+
+	// Mesh hash the table was built from, so the editor can tell when it's stale
+	UPROPERTY()
+	FString SourceHash;
+
+	UPROPERTY()
+	TArray<FVector3f> Positions;
+
+	UPROPERTY()
+	TArray<FVector2f> Uvs;
+
+	UPROPERTY()
+	TArray<uint32> Indices;
+
+	bool FindUv(const int32 FaceIndex, const FVector& LocalPosition, FVector2D& OutUv) const;
+};
+
+/*
+* Per-mesh UV lookup tables, built in the editor and saved with the level, so gaze hits resolve their UV
+* without the meshes' render data having to stay CPU accessible.
+*/
+UCLASS(NotPlaceable)
+class EYETRACKINGUTILITYRUNTIME_API AHeatmapUvLookupCache : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	const FHeatmapUvTriangleTable* FindTable(const UStaticMesh* StaticMesh) const;
+
+	void SetTable(UStaticMesh* StaticMesh, FHeatmapUvTriangleTable&& Table);
+
+	// Falls through (returns false) for meshes without a table built for UvChannel
+	static bool FindCollisionUv(const FHitResult& HitResult, const int32 UvChannel, FVector2D& OutUv);
+
+	// Doesn't touch the actor registry, for lookups off the game thread
+	static bool FindCollisionUv(const AHeatmapUvLookupCache* UvLookupCache, const FHitResult& HitResult,
+		const int32 UvChannel, FVector2D& OutUv);
+
+	UPROPERTY(VisibleAnywhere, Category = "Heatmap UV")
+	TMap<TObjectPtr<UStaticMesh>, FHeatmapUvTriangleTable> Tables;
+};
@@ -0,0 +1,55 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ConvexVolume.h"
+
+class UPrimitiveComponent;
+
+/*
+* Time each bNeedsMetrics actor spent in view, per MetricsName. Bounds are cached as structure of arrays when
+* tracking starts and tested four at a time against the frustum planes. Actors inside the frustum can also be
+* dropped when the renderer culled them as occluded in the last frames, which makes a coarse occlusion test
+* without any traces. Cached bounds assume the tracked actors don't move while tracking.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FHeatmapVisibilityTracker
+{
+public:
+	// Gathers the actors to track and clears the accumulated times
+	void Init(const UObject* WorldContextObject);
+
+	void Reset();
+
+	void Update(const FConvexVolume& Frustum, const float DeltaSeconds, const bool bTestOcclusion);
+
+	void GetVisibleTimes(TMap<FString, float>& OutVisibleTimes) const;
+
+	int32 Num() const { return Primitives.Num(); }
+
+	// <Session>.visibility next to <Session>.json
+	static FString GetSidecarFilePath(const FString& SessionFilePath);
+
+private:
+	// Padded to a multiple of four; the padding lanes are skipped
+	TArray<float> CenterX;
+	TArray<float> CenterY;
+	TArray<float> CenterZ;
+	TArray<float> ExtentX;
+	TArray<float> ExtentY;
+	TArray<float> ExtentZ;
+
+	// For the occlusion test: the renderer only updates the on-screen render time of unoccluded primitives
+	TArray<TWeakObjectPtr<const UPrimitiveComponent>> Primitives;
+	TArray<int32> MetricsNameIndices;
+
+	TArray<FString> MetricsNames;
+	TArray<float> VisibleTimes;
+
+	// Actors sharing a MetricsName count once per frame
+	TArray<uint32> LastVisibleFrames;
+	uint32 Frame = 0;
+
+	// Last render times within this count as visible, a frame or two of latency
+	static constexpr float OcclusionTolerance = 0.1f;
+};
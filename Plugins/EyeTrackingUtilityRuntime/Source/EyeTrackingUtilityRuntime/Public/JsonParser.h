@@ -30,8 +30,14 @@ class EYETRACKINGUTILITYRUNTIME_API UJsonParser : public UBlueprintFunctionLibra
 	GENERATED_BODY()
 
 public:
-	UFUNCTION(BlueprintCallable, Category = "AttentionTrackingData")
-	static void ReadAttentionTrackingDataFromJsonFile(const FString& FilePath, TArray<FAttentionTrackingDataPoint>& AttentionTrackingData, bool& bOutSuccess);
+	// Resolves entries of older files against the world's actors, like loading them as a session does
+	UFUNCTION(BlueprintCallable, Category = "AttentionTrackingData", meta = (WorldContext = "WorldContextObject"))
+	static void ReadAttentionTrackingDataFromJsonFile(const UObject* WorldContextObject, const FString& FilePath,
+		TArray<FAttentionTrackingDataPoint>& AttentionTrackingData, bool& bOutSuccess);
+
+	// Also reports the brush scale divisors of entries written before the per-actor scale table (keyed by data index)
+	static void ReadAttentionTrackingDataFromJsonFile(const FString& FilePath, TArray<FAttentionTrackingDataPoint>& AttentionTrackingData,
+		TMap<int32, FVector2D>& OutLegacyScaleDivisors, bool& bOutSuccess);
 
 	UFUNCTION(BlueprintCallable, Category = "AttentionTrackingData")
 	static void WriteAttentionTrackingDataToJsonFile(const TArray<FAttentionTrackingDataPoint>& AttentionTrackingDataArray,
@@ -47,6 +53,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "AttentionMetrics")
 	static void WriteAttentionMetricsToJsonFile(const TMap<FString, FAttentionMetricsEntry>& AttentionMetrics, const FString& FilePath, bool& bOutSuccess);
 
+	UFUNCTION(BlueprintCallable, Category = "AttentionMetrics")
+	static void WriteHotspotsToJsonFile(const TArray<FHeatmapHotspot>& Hotspots, const FString& FilePath, bool& bOutSuccess);
+
 	UFUNCTION(BlueprintPure, Category = "AttentionMetrics")
 	static FString AttentionMetricsFolderPath();
 	
@@ -61,6 +70,26 @@ public:
 	UFUNCTION(BlueprintPure, Category = "ConfigData")
 	static FString ConfigDataFilePath();
 
+	/******/
+
+	// A missing cache file is not an error, it just yields an empty map
+	static TMap<FString, FString> ReadStringMapFromJsonFile(const FString& FilePath, bool& bOutSuccess);
+	static void WriteStringMapToJsonFile(const TMap<FString, FString>& StringMap, const FString& FilePath, bool& bOutSuccess);
+
+	static TMap<FString, float> ReadFloatMapFromJsonFile(const FString& FilePath, bool& bOutSuccess);
+	static void WriteFloatMapToJsonFile(const TMap<FString, float>& FloatMap, const FString& FilePath, bool& bOutSuccess);
+
+	// Like the float maps, a session recorded without waypoints just yields no markers
+	static TArray<FHeatmapSegmentMarker> ReadSegmentMarkersFromJsonFile(const FString& FilePath, bool& bOutSuccess);
+	static void WriteSegmentMarkersToJsonFile(const TArray<FHeatmapSegmentMarker>& SegmentMarkers, const FString& FilePath,
+		bool& bOutSuccess);
+
+	// <Session>.segments next to <Session>.json
+	static FString SegmentMarkersFilePath(const FString& SessionFilePath);
+
+	UFUNCTION(BlueprintPure, Category = "Cache")
+	static FString CacheFolderPath();
+
 private:
 
 	static FString ReadStringFromFile(const FString& FilePath, bool& bOutSuccess);
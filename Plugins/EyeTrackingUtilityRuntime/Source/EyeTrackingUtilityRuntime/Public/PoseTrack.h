@@ -0,0 +1,78 @@
+// Copyright (c) 2025 Sebastian Cyliax
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+* The participant's camera pose at the sampling rate, encoded as it is recorded. Samples are grouped in blocks
+* that start with a full keyframe; the rest of a block stores the time in ms, the position as 0.1 mm steps from
+* the previous sample and the rotation as a smallest-three quaternion with 10 bits per component, 11 bytes per
+* sample. Deltas are taken from the decoded previous sample, so quantization errors don't add up. The block
+* index makes seeking a binary search plus decoding at most one block.
+*/
+class EYETRACKINGUTILITYRUNTIME_API FPoseTrack
+{
+public:
+	void AddSample(const FVector& Position, const FQuat& Rotation, const float Time);
+
+	void Reset();
+
+	// Interpolated between the samples around Time, clamped to the recorded range
+	bool Evaluate(const float Time, FVector& OutPosition, FQuat& OutRotation) const;
+
+	int32 Num() const { return SamplesNum; }
+	float GetStartTime() const { return Blocks.IsEmpty() ? 0.f : Blocks[0].StartTime; }
+	float GetEndTime() const { return LastSample.Time; }
+	int32 GetEncodedSize() const { return Data.Num(); }
+
+	bool SaveToFile(const FString& FilePath) const;
+	bool LoadFromFile(const FString& FilePath);
+
+	// <Session>.pose next to <Session>.json
+	static FString GetSidecarFilePath(const FString& SessionFilePath);
+
+private:
+	struct FBlock
+	{
+		float StartTime = 0.f;
+		int32 ByteOffset = 0;
+		int32 SamplesNum = 0;
+	};
+
+	struct FSample
+	{
+		float Time = 0.f;
+		FVector3f Position = FVector3f::ZeroVector;
+		uint32 Rotation = 0;
+	};
+
+	void ReadKeyframe(const FBlock& Block, FSample& OutSample) const;
+
+	// Decodes a block until it passes Time, leaving the samples around it in OutBefore and OutAfter
+	void FindSamples(const FBlock& Block, const float Time, FSample& OutBefore, FSample& OutAfter) const;
+
+	static uint32 EncodeRotation(const FQuat& Rotation);
+	static FQuat DecodeRotation(const uint32 Encoded);
+
+	static void ApplyDelta(FSample& Sample, const uint8 TimeDelta, const int16 PositionDelta[3]);
+
+	TArray<uint8> Data;
+	TArray<FBlock> Blocks;
+	int32 SamplesNum = 0;
+
+	// Last sample as the decoder will see it
+	FSample LastSample;
+
+	static constexpr int32 MaxBlockSamples = 256;
+	static constexpr int32 KeyframeSize = 20;
+	static constexpr int32 DeltaSize = 11;
+	static constexpr float TimeStep = 0.001f;
+	static constexpr float PositionStep = 0.01f;
+
+	// No component but the largest of a unit quaternion can exceed 1/sqrt(2)
+	static constexpr double MaxRotationComponent = 0.70710678118654752;
+
+	static constexpr uint32 FileMagic = 0x45534F50;
+	static constexpr uint32 FileVersion = 1;
+};
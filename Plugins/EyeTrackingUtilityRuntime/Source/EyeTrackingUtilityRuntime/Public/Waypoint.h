@@ -20,6 +20,10 @@ protected:
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Index")
 	int32 Index;
+
+	// The participant reaches the waypoint within this distance, which ends one leg of the route
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Route", meta = (ClampMin = "1.0"))
+	float ReachRadius;
 	
 	virtual void Tick(float DeltaTime) override;
 };